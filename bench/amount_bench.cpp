@@ -0,0 +1,247 @@
+/**
+ * LuminaChain Wallet - Amount Benchmark
+ *
+ * This file measures balance updates and the saving and loading of
+ * amounts with the fixed-point Amount type, next to the double-based
+ * code it replaced, and times saving and loading a wallet.
+ *
+ * Copyright (c) 2023 LuminaChain Development Team
+ * Licensed under MIT License
+ */
+
+#include "core/amount.h"
+#include "core/wallet.h"
+#include "network/scanner.h"
+#include "utils/logger.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <map>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace lumina;
+
+// Number of balance updates timed
+const size_t BALANCE_UPDATES = 10000000;
+
+// Number of assets the updates are spread over
+const size_t ASSET_COUNT = 8;
+
+// Number of amounts written and read back
+const size_t CODEC_AMOUNTS = 1000000;
+
+// Number of transactions in the saved wallet, and per transfer batch
+const size_t WALLET_TRANSACTIONS = 10000;
+const size_t TRANSFER_BATCH_SIZE = 100;
+
+// Password of the benchmark wallet
+const char* const BENCH_PASSWORD = "bench password";
+
+// Seed phrase of the benchmark wallet
+const char* const BENCH_SEED_PHRASE = "legal winner thank year wave sausage worth useful legal winner thank yellow";
+
+const char* const ASSET_SYMBOLS[ASSET_COUNT] = {"LMT", "USDL", "GOLD", "SILV", "BOND", "EURL", "OIL", "CARB"};
+
+/**
+ * Gets the seconds elapsed since a start time
+ */
+static double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * Gets the atomic units of the i-th amount of the benchmark, a few coins with all decimals used
+ */
+static uint64_t sampleAmount(size_t i) {
+    return (i * 2654435761ULL) % (5 * Amount::ATOMIC_UNITS_PER_COIN) + 1;
+}
+
+/**
+ * Times balance updates with doubles and with Amount
+ *
+ * Every other update credits the amount the previous one debited from the
+ * same asset, so balances never run out and end where they started.
+ */
+static void measureBalanceUpdates() {
+    std::vector<uint64_t> amounts(1024);
+    for (size_t i = 0; i < amounts.size(); ++i) {
+        amounts[i] = sampleAmount(i);
+    }
+    const uint64_t startingBalance = 1000 * Amount::ATOMIC_UNITS_PER_COIN;
+
+    // Before: doubles in coins, keyed by symbol, checked and then updated as Wallet::transfer did
+    std::map<std::string, double> doubleBalances;
+    std::vector<std::string> symbols(ASSET_SYMBOLS, ASSET_SYMBOLS + ASSET_COUNT);
+    for (const std::string& symbol : symbols) {
+        doubleBalances[symbol] = static_cast<double>(startingBalance) / Amount::ATOMIC_UNITS_PER_COIN;
+    }
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < BALANCE_UPDATES; ++i) {
+        const std::string& symbol = symbols[(i / 2) % ASSET_COUNT];
+        double amount = static_cast<double>(amounts[(i / 2) % amounts.size()]) / Amount::ATOMIC_UNITS_PER_COIN;
+        if (i % 2 == 0) {
+            auto it = doubleBalances.find(symbol);
+            if (it == doubleBalances.end() || it->second < amount) {
+                continue;
+            }
+            doubleBalances[symbol] -= amount;
+        } else {
+            doubleBalances[symbol] += amount;
+        }
+    }
+    double doubleNs = secondsSince(start) * 1e9 / BALANCE_UPDATES;
+
+    // Now: atomic units, indexed by asset ID
+    std::vector<Amount> balances(ASSET_COUNT, Amount(startingBalance));
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < BALANCE_UPDATES; ++i) {
+        Amount& balance = balances[(i / 2) % ASSET_COUNT];
+        Amount amount(amounts[(i / 2) % amounts.size()]);
+        if (i % 2 == 0) {
+            balance.checkedSub(amount, balance);
+        } else {
+            balance.checkedAdd(amount, balance);
+        }
+    }
+    double amountNs = secondsSince(start) * 1e9 / BALANCE_UPDATES;
+
+    // Every debit was credited back, so each balance should be where it started
+    double maxDrift = 0;
+    bool exact = true;
+    for (size_t asset = 0; asset < ASSET_COUNT; ++asset) {
+        double drift = std::fabs(doubleBalances[symbols[asset]] * Amount::ATOMIC_UNITS_PER_COIN - startingBalance);
+        maxDrift = std::max(maxDrift, drift);
+        exact = exact && balances[asset] == Amount(startingBalance);
+    }
+
+    std::printf("Balance updates, ns per update (%zu updates over %zu assets):\n", BALANCE_UPDATES, ASSET_COUNT);
+    std::printf("  double by symbol          %10.2f   drift %.0f atomic units\n", doubleNs, maxDrift);
+    std::printf("  Amount by asset ID        %10.2f   drift %s\n", amountNs, exact ? "none" : "NONZERO");
+}
+
+/**
+ * Times writing amounts as text and reading them back
+ */
+static void measureTextAmounts() {
+    // Before: operator<< on a double and std::stod, as the text wallet file used
+    auto start = std::chrono::steady_clock::now();
+    std::ostringstream out;
+    for (size_t i = 0; i < CODEC_AMOUNTS; ++i) {
+        out << "BALANCE:LMT:" << static_cast<double>(sampleAmount(i)) / Amount::ATOMIC_UNITS_PER_COIN << "\n";
+    }
+    std::istringstream in(out.str());
+    std::string line;
+    size_t doubleMismatches = 0;
+    for (size_t i = 0; std::getline(in, line); ++i) {
+        double amount = std::stod(line.substr(line.find(':', 8) + 1));
+        if (std::llround(amount * Amount::ATOMIC_UNITS_PER_COIN) != static_cast<long long>(sampleAmount(i))) {
+            ++doubleMismatches;
+        }
+    }
+    double doubleNs = secondsSince(start) * 1e9 / CODEC_AMOUNTS;
+
+    // Now: Amount::format and Amount::parse, which do not allocate
+    start = std::chrono::steady_clock::now();
+    std::string text;
+    text.reserve(CODEC_AMOUNTS * (Amount::MAX_FORMATTED_LENGTH + 1));
+    char buffer[Amount::MAX_FORMATTED_LENGTH];
+    for (size_t i = 0; i < CODEC_AMOUNTS; ++i) {
+        text.append(buffer, Amount(sampleAmount(i)).format(buffer));
+        text.push_back('\n');
+    }
+    size_t amountMismatches = 0;
+    std::string_view remaining(text);
+    for (size_t i = 0; !remaining.empty(); ++i) {
+        size_t end = remaining.find('\n');
+        Amount amount;
+        if (!Amount::parse(remaining.substr(0, end), amount) || amount != Amount(sampleAmount(i))) {
+            ++amountMismatches;
+        }
+        remaining.remove_prefix(end + 1);
+    }
+    double amountNs = secondsSince(start) * 1e9 / CODEC_AMOUNTS;
+
+    std::printf("Amounts written as text and read back, ns per amount (%zu amounts):\n", CODEC_AMOUNTS);
+    std::printf("  double, << and stod       %10.2f   %zu changed\n", doubleNs, doubleMismatches);
+    std::printf("  Amount, format and parse  %10.2f   %zu changed\n", amountNs, amountMismatches);
+}
+
+/**
+ * Times saving a wallet after a run of transfers and loading it again
+ */
+static bool measureWallet() {
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / "lumina_amount_bench";
+    std::error_code error;
+    std::filesystem::remove_all(directory, error);
+    std::filesystem::create_directories(directory);
+    std::string path = (directory / "bench.wallet").string();
+
+    double saveMs = 0;
+    {
+        Wallet wallet(path, BENCH_PASSWORD);
+        ScannedOutput output{};
+        output.height = 1;
+        output.txHash = "funding";
+        output.amount = 1000000 * Amount::ATOMIC_UNITS_PER_COIN;
+        output.assetType = "LMT";
+        if (!wallet.recoverFromSeed(BENCH_SEED_PHRASE) || !wallet.addScannedOutput(output)) {
+            std::fprintf(stderr, "Failed to create the benchmark wallet\n");
+            return false;
+        }
+
+        std::vector<TransferDestination> destinations(TRANSFER_BATCH_SIZE);
+        for (size_t i = 0; i < WALLET_TRANSACTIONS; i += TRANSFER_BATCH_SIZE) {
+            for (size_t j = 0; j < destinations.size(); ++j) {
+                destinations[j].address = "LMTrecipient" + std::to_string(j);
+                destinations[j].amount = Amount(sampleAmount(i + j));
+            }
+            if (!wallet.transferBatch(destinations)) {
+                std::fprintf(stderr, "Failed to transfer from the benchmark wallet\n");
+                return false;
+            }
+        }
+
+        // Saving the checkpoint writes the wallet file with the new history
+        auto start = std::chrono::steady_clock::now();
+        if (!wallet.setSyncCheckpoint({2, {}})) {
+            std::fprintf(stderr, "Failed to save the benchmark wallet\n");
+            return false;
+        }
+        saveMs = secondsSince(start) * 1e3;
+    }
+
+    // The wallet saves itself again when it closes, so it is closed outside the timing
+    size_t transactionCount = 0;
+    double loadMs = 0;
+    {
+        auto start = std::chrono::steady_clock::now();
+        Wallet loaded(path, BENCH_PASSWORD);
+        transactionCount = loaded.getTransactionCount();
+        loadMs = secondsSince(start) * 1e3;
+    }
+    if (transactionCount != WALLET_TRANSACTIONS) {
+        std::fprintf(stderr, "Loaded %zu of %zu transactions\n", transactionCount, WALLET_TRANSACTIONS);
+        return false;
+    }
+
+    std::printf("Wallet with %zu transactions, ms (load includes the key derivation):\n", WALLET_TRANSACTIONS);
+    std::printf("  save                      %10.2f\n", saveMs);
+    std::printf("  load                      %10.2f\n", loadMs);
+
+    std::filesystem::remove_all(directory, error);
+    return true;
+}
+
+int main() {
+    // Transfers log and warn that the wallet is not synchronized, which would be timed with them
+    Logger::getInstance().setLogLevel(LogLevel::ERROR);
+
+    measureBalanceUpdates();
+    measureTextAmounts();
+    return measureWallet() ? 0 : 1;
+}
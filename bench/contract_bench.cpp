@@ -0,0 +1,144 @@
+/**
+ * LuminaChain Wallet - Contract Benchmark
+ *
+ * This file measures how fast the VM runs a set of representative
+ * contracts, in instructions and gas per second, and how long they take
+ * to compile.
+ *
+ * Copyright (c) 2023 LuminaChain Development Team
+ * Licensed under MIT License
+ */
+
+#include "contract/bytecode.h"
+#include "contract/compiler.h"
+#include "contract/vm.h"
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace lumina;
+
+// Gas limit of each run, high enough for every sample to finish
+const uint64_t BENCH_GAS_LIMIT = 1ULL << 40;
+
+// Minimum time spent running each sample
+const double MIN_SECONDS = 1.0;
+
+// Number of times each sample is compiled
+const int COMPILE_RUNS = 2000;
+
+/**
+ * A sample contract and the arguments of its main function
+ */
+struct Sample {
+    const char* name;
+    const char* source;
+    std::vector<int64_t> args;
+};
+
+const Sample SAMPLES[] = {
+    {"arithmetic loop", R"(
+        contract Arithmetic {
+            function main(n) {
+                let total = 0;
+                for i in 0..n {
+                    total = total + i * i % 7 - (i / 3);
+                }
+                return total;
+            }
+        }
+    )", {100000}},
+    {"branches", R"(
+        contract Collatz {
+            function main(n) {
+                let steps = 0;
+                for start in 1..n {
+                    let x = start;
+                    while (x != 1) {
+                        if (x % 2 == 0) {
+                            x = x / 2;
+                        } else {
+                            x = 3 * x + 1;
+                        }
+                        steps = steps + 1;
+                    }
+                }
+                return steps;
+            }
+        }
+    )", {3000}},
+    {"recursive calls", R"(
+        contract Fibonacci {
+            function main(n) {
+                return fib(n);
+            }
+
+            function fib(n) {
+                if (n < 2) {
+                    return n;
+                }
+                return fib(n - 1) + fib(n - 2);
+            }
+        }
+    )", {20}},
+    {"storage", R"(
+        contract Ledger {
+            function main(n) {
+                for i in 0..n {
+                    store("balance", i % 64, load("balance", i % 64) + i);
+                }
+                return load("balance", 0);
+            }
+        }
+    )", {20000}},
+};
+
+int main() {
+    std::printf("%-16s %12s %14s %14s %12s\n", "contract", "compile us", "instr/s", "gas/s", "ns/instr");
+
+    for (const Sample& sample : SAMPLES) {
+        ContractCompiler compiler;
+        CompiledContract contract;
+        if (!compiler.compile(sample.source, contract)) {
+            std::fprintf(stderr, "%s: %s\n", sample.name, compiler.getError().c_str());
+            return 1;
+        }
+        std::string error;
+        if (!verifyContract(contract, error)) {
+            std::fprintf(stderr, "%s: %s\n", sample.name, error.c_str());
+            return 1;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < COMPILE_RUNS; ++i) {
+            CompiledContract recompiled;
+            compiler.compile(sample.source, recompiled);
+        }
+        double compileUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() /
+                           COMPILE_RUNS;
+
+        // Run until enough time has passed, with storage that persists like a contract's would
+        ContractVM vm;
+        MemoryContractStorage storage;
+        int entry = contract.findFunction("main");
+        uint64_t instructions = 0;
+        uint64_t gas = 0;
+        double seconds = 0;
+        start = std::chrono::steady_clock::now();
+        while (seconds < MIN_SECONDS) {
+            ExecutionResult result = vm.execute(contract, entry, sample.args, BENCH_GAS_LIMIT, storage);
+            if (!result.success) {
+                std::fprintf(stderr, "%s: %s\n", sample.name, result.error.c_str());
+                return 1;
+            }
+            instructions += result.instructions;
+            gas += result.gasUsed;
+            seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+
+        std::printf("%-16s %12.1f %14.0f %14.0f %12.2f\n", sample.name, compileUs, instructions / seconds,
+                    gas / seconds, seconds * 1e9 / instructions);
+    }
+    return 0;
+}
@@ -0,0 +1,224 @@
+/**
+ * LuminaChain Wallet - Gas Estimator Benchmark
+ *
+ * This file measures the gas estimator on a corpus of sample contracts:
+ * the time of an estimate next to the time of running the contract, and
+ * how close the estimate is to the gas a run charges.
+ *
+ * Copyright (c) 2023 LuminaChain Development Team
+ * Licensed under MIT License
+ */
+
+#include "contract/bytecode.h"
+#include "contract/compiler.h"
+#include "contract/contract_state.h"
+#include "contract/gas_estimator.h"
+#include "contract/vm.h"
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace lumina;
+
+// Gas limit of estimates and runs, high enough for every sample to finish
+const uint64_t BENCH_GAS_LIMIT = 10000000;
+
+// Minimum time spent on each measurement
+const double MIN_SECONDS = 0.5;
+
+/**
+ * A sample contract and the arguments of its main function
+ */
+struct Sample {
+    const char* name;
+    const char* source;
+    std::vector<int64_t> args;
+};
+
+const Sample SAMPLES[] = {
+    {"transfer", R"(
+        contract Transfer {
+            function main(from, to, amount) {
+                let balance = load("balance", from);
+                if (balance < amount) {
+                    return 0;
+                }
+                store("balance", from, balance - amount);
+                store("balance", to, load("balance", to) + amount);
+                return 1;
+            }
+        }
+    )", {1, 2, 50}},
+    {"fee schedule", R"(
+        contract Fees {
+            function main(amount) {
+                let fee = 0;
+                if (amount > 1000000) {
+                    fee = amount / 1000;
+                } else if (amount > 1000) {
+                    fee = amount / 100 + 5;
+                } else {
+                    fee = 10;
+                }
+                return fee + tier(amount) * 2;
+            }
+
+            function tier(amount) {
+                if (amount % 7 == 0) {
+                    return 3;
+                }
+                return 1;
+            }
+        }
+    )", {250000}},
+    {"constant loop", R"(
+        contract Payroll {
+            function main(base) {
+                let total = 0;
+                for i in 0..32 {
+                    if (i % 4 == 0) {
+                        total = total + bonus(base, i);
+                    } else {
+                        total = total + base;
+                    }
+                    store("paid", i, total);
+                }
+                return total;
+            }
+
+            function bonus(base, i) {
+                return base + base * i / 10;
+            }
+        }
+    )", {1000}},
+    {"nested loops", R"(
+        contract Grid {
+            function main(seed) {
+                let sum = 0;
+                for x in 0..16 {
+                    for y in 0..16 {
+                        sum = sum + (x * y + seed) % 11;
+                    }
+                }
+                return sum;
+            }
+        }
+    )", {3}},
+    {"argument loop", R"(
+        contract Vesting {
+            function main(months, amount) {
+                let released = 0;
+                for m in 0..months {
+                    released = released + amount / months;
+                    store("released", m, released);
+                }
+                return released;
+            }
+        }
+    )", {24, 120000}},
+    {"while loop", R"(
+        contract Collatz {
+            function main(n) {
+                let steps = 0;
+                while (n != 1) {
+                    if (n % 2 == 0) {
+                        n = n / 2;
+                    } else {
+                        n = 3 * n + 1;
+                    }
+                    steps = steps + 1;
+                }
+                return steps;
+            }
+        }
+    )", {27}},
+    {"recursion", R"(
+        contract Fibonacci {
+            function main(n) {
+                return fib(n);
+            }
+
+            function fib(n) {
+                if (n < 2) {
+                    return n;
+                }
+                return fib(n - 1) + fib(n - 2);
+            }
+        }
+    )", {12}},
+};
+
+/**
+ * Calls a function until enough time has passed, returning the microseconds per call
+ */
+template <typename Function>
+static double measure(Function function) {
+    uint64_t calls = 0;
+    double seconds = 0;
+    auto start = std::chrono::steady_clock::now();
+    while (seconds < MIN_SECONDS) {
+        for (int i = 0; i < 100; ++i) {
+            function();
+        }
+        calls += 100;
+        seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    return seconds * 1e6 / calls;
+}
+
+int main() {
+    std::printf("%-14s %-10s %12s %12s %12s %12s %8s\n", "contract", "method", "estimate us", "run us",
+                "estimate", "gas used", "ratio");
+
+    // Funds the transfer sample's sender, so its runs take the longest path
+    ContractState state;
+    state.store("balance/1", 1000);
+
+    for (const Sample& sample : SAMPLES) {
+        ContractCompiler compiler;
+        CompiledContract contract;
+        if (!compiler.compile(sample.source, contract)) {
+            std::fprintf(stderr, "%s: %s\n", sample.name, compiler.getError().c_str());
+            return 1;
+        }
+        std::string error;
+        if (!verifyContract(contract, error)) {
+            std::fprintf(stderr, "%s: %s\n", sample.name, error.c_str());
+            return 1;
+        }
+        int entry = contract.findFunction("main");
+
+        // The run uses a fork, so the estimates and the runs start from the same state
+        ContractVM vm;
+        ContractState scratch = state.fork();
+        ExecutionResult result = vm.execute(contract, entry, sample.args, BENCH_GAS_LIMIT, scratch);
+        if (!result.success) {
+            std::fprintf(stderr, "%s: %s\n", sample.name, result.error.c_str());
+            return 1;
+        }
+
+        GasEstimator estimator;
+        GasEstimate estimate = estimator.estimate(contract, entry, sample.args, BENCH_GAS_LIMIT, state);
+        if (estimate.reachedLimit || estimate.gas < result.gasUsed) {
+            std::fprintf(stderr, "%s: estimated %llu gas for a run using %llu\n", sample.name,
+                         static_cast<unsigned long long>(estimate.gas),
+                         static_cast<unsigned long long>(result.gasUsed));
+            return 1;
+        }
+
+        double estimateUs = measure([&]() {
+            estimator.estimate(contract, entry, sample.args, BENCH_GAS_LIMIT, state);
+        });
+        double runUs = measure([&]() {
+            ContractState fork = state.fork();
+            vm.execute(contract, entry, sample.args, BENCH_GAS_LIMIT, fork);
+        });
+
+        std::printf("%-14s %-10s %12.2f %12.2f %12llu %12llu %8.2f\n", sample.name,
+                    estimate.isUpperBound ? "static" : "dry run", estimateUs, runUs,
+                    static_cast<unsigned long long>(estimate.gas), static_cast<unsigned long long>(result.gasUsed),
+                    static_cast<double>(estimate.gas) / result.gasUsed);
+    }
+    return 0;
+}
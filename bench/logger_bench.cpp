@@ -0,0 +1,161 @@
+/**
+ * LuminaChain Wallet - Logger Benchmark
+ *
+ * This file measures the cost of logging: producer throughput through the
+ * asynchronous queue, messages skipped by the level check and timestamp
+ * formatting, each next to the approach it replaced.
+ *
+ * Copyright (c) 2023 LuminaChain Development Team
+ * Licensed under MIT License
+ */
+
+#include "utils/logger.h"
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace lumina;
+
+// Number of threads logging at once
+const int PRODUCER_THREADS = 8;
+
+// Number of messages each producer logs
+const int MESSAGES_PER_PRODUCER = 200000;
+
+// Number of calls timed for the per-call costs
+const int TIMED_CALLS = 5000000;
+
+/**
+ * Gets the seconds elapsed since a start time
+ */
+static double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * Runs a producer on every thread, returning the messages logged per second
+ */
+static double measureProducers(const std::function<void(int, int)>& logMessage) {
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int thread = 0; thread < PRODUCER_THREADS; ++thread) {
+        threads.emplace_back([&logMessage, thread]() {
+            for (int i = 0; i < MESSAGES_PER_PRODUCER; ++i) {
+                logMessage(thread, i);
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    Logger::getInstance().flush();
+    return PRODUCER_THREADS * MESSAGES_PER_PRODUCER / secondsSince(start);
+}
+
+/**
+ * Formats a timestamp through put_time, as the logger did before its minute cache
+ */
+static std::string formatTimestamp(std::chrono::system_clock::time_point now) {
+    std::time_t time = std::chrono::system_clock::to_time_t(now);
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()) % 1000;
+    std::tm timeInfo;
+    localtime_r(&time, &timeInfo);
+
+    std::stringstream ss;
+    ss << std::put_time(&timeInfo, "%Y-%m-%d %H:%M:%S") << '.' << std::setfill('0') << std::setw(3) << ms.count();
+    return ss.str();
+}
+
+int main() {
+    std::filesystem::path directory = std::filesystem::temp_directory_path();
+    std::string logPath = (directory / "lumina_logger_bench.log").string();
+    std::string baselinePath = (directory / "lumina_logger_bench_baseline.log").string();
+
+    Logger& logger = Logger::getInstance();
+    if (!logger.initialize(logPath, false)) {
+        std::fprintf(stderr, "Failed to open %s\n", logPath.c_str());
+        return 1;
+    }
+
+    // Producer throughput, each message written and flushed under a mutex as before the queue
+    std::mutex baselineMutex;
+    std::ofstream baselineFile(baselinePath);
+    double baseline = measureProducers([&](int thread, int i) {
+        std::string message = "Processed transaction " + std::to_string(i) + " on thread " + std::to_string(thread);
+        std::lock_guard<std::mutex> lock(baselineMutex);
+        baselineFile << "[" << formatTimestamp(std::chrono::system_clock::now()) << "] [INFO] " << message << std::endl;
+    });
+    baselineFile.close();
+
+    double eager = measureProducers([&logger](int thread, int i) {
+        logger.info("Processed transaction " + std::to_string(i) + " on thread " + std::to_string(thread));
+    });
+    double deferred = measureProducers([](int thread, int i) {
+        LUMINA_LOG_INFO("Processed transaction ", i, " on thread ", thread);
+    });
+
+    std::printf("%d producers, messages per second:\n", PRODUCER_THREADS);
+    std::printf("  flush per message under a mutex  %12.0f\n", baseline);
+    std::printf("  info() through the queue         %12.0f\n", eager);
+    std::printf("  LUMINA_LOG_INFO                  %12.0f\n", deferred);
+
+    // Disabled messages: the macro skips its arguments, debug() builds them first
+    logger.setLogLevel(LogLevel::INFO);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < TIMED_CALLS; ++i) {
+        LUMINA_LOG_DEBUG("Created new transaction: ", std::to_string(i));
+    }
+    double macroNs = secondsSince(start) * 1e9 / TIMED_CALLS;
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < TIMED_CALLS; ++i) {
+        logger.debug("Created new transaction: " + std::to_string(i));
+    }
+    double eagerNs = secondsSince(start) * 1e9 / TIMED_CALLS;
+
+    std::printf("Disabled debug message, ns per call:\n");
+    std::printf("  LUMINA_LOG_DEBUG                 %12.2f\n", macroNs);
+    std::printf("  debug()                          %12.2f\n", eagerNs);
+
+    // Timestamps, checked against put_time before they are timed
+    int mismatches = 0;
+    for (int i = 0; i < 1000; ++i) {
+        auto before = std::chrono::system_clock::now();
+        std::string timestamp = logger.getTimestamp();
+        auto after = std::chrono::system_clock::now();
+        if (timestamp != formatTimestamp(before) && timestamp != formatTimestamp(after)) {
+            ++mismatches;
+        }
+    }
+
+    size_t totalSize = 0;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < TIMED_CALLS; ++i) {
+        totalSize += logger.getTimestamp().size();
+    }
+    double cachedNs = secondsSince(start) * 1e9 / TIMED_CALLS;
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < TIMED_CALLS / 10; ++i) {
+        totalSize += formatTimestamp(std::chrono::system_clock::now()).size();
+    }
+    double putTimeNs = secondsSince(start) * 1e9 / (TIMED_CALLS / 10);
+
+    std::printf("Timestamp, ns per call (%d mismatches, %zu bytes):\n", mismatches, totalSize);
+    std::printf("  getTimestamp()                   %12.1f\n", cachedNs);
+    std::printf("  put_time                         %12.1f\n", putTimeNs);
+
+    std::error_code error;
+    std::filesystem::remove(baselinePath, error);
+    std::filesystem::remove(logPath, error);
+    return mismatches == 0 ? 0 : 1;
+}
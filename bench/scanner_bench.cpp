@@ -0,0 +1,132 @@
+/**
+ * LuminaChain Wallet - Output Scanner Benchmark
+ *
+ * This file measures how many outputs per second the output scanner
+ * checks on synthetic chains, with and without view tags.
+ *
+ * Copyright (c) 2023 LuminaChain Development Team
+ * Licensed under MIT License
+ */
+
+#include "network/scanner.h"
+#include "utils/logger.h"
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace lumina;
+
+// Blocks in each scanned batch
+const size_t BLOCKS_PER_BATCH = 100;
+
+// Transactions in each block
+const size_t TRANSACTIONS_PER_BLOCK = 20;
+
+// One transaction in this many pays the wallet
+const size_t PAID_TRANSACTION_INTERVAL = 50;
+
+// Minimum time spent scanning each chain
+const double MIN_SECONDS = 2.0;
+
+/**
+ * Shape of a synthetic chain
+ */
+struct ChainShape {
+    const char* name;
+    size_t outputsPerTransaction;
+    bool withViewTags;
+};
+
+const ChainShape CHAINS[] = {
+    {"2 outputs, view tags", 2, true},
+    {"16 outputs, view tags", 16, true},
+    {"2 outputs, no view tags", 2, false},
+    {"16 outputs, no view tags", 16, false},
+};
+
+/**
+ * Builds a batch of blocks in which some transactions pay the wallet their first output
+ */
+static std::vector<ScanBlock> makeBlocks(const ChainShape& shape, const crypto::public_key& viewPublicKey,
+                                         const crypto::public_key& spendPublicKey, size_t& paidOutputs) {
+    std::vector<ScanBlock> blocks(BLOCKS_PER_BATCH);
+    paidOutputs = 0;
+    for (size_t b = 0; b < blocks.size(); ++b) {
+        blocks[b].height = b + 1;
+        for (size_t t = 0; t < TRANSACTIONS_PER_BLOCK; ++t) {
+            ScanTransaction tx;
+            tx.txHash = std::to_string(b) + ":" + std::to_string(t);
+            tx.assetType = "LMT";
+
+            crypto::secret_key txSecretKey;
+            crypto::generate_keys(tx.txPublicKey, txSecretKey);
+            crypto::key_derivation derivation;
+            crypto::generate_key_derivation(viewPublicKey, txSecretKey, derivation);
+
+            bool paid = (b * TRANSACTIONS_PER_BLOCK + t) % PAID_TRANSACTION_INTERVAL == 0;
+            for (size_t i = 0; i < shape.outputsPerTransaction; ++i) {
+                crypto::public_key outputKey;
+                crypto::view_tag viewTag;
+                if (paid && i == 0) {
+                    crypto::derive_public_key(derivation, i, spendPublicKey, outputKey);
+                    crypto::derive_view_tag(derivation, i, viewTag);
+                    ++paidOutputs;
+                } else {
+                    crypto::secret_key unused;
+                    crypto::generate_keys(outputKey, unused);
+                    crypto::derive_view_tag(derivation, i + shape.outputsPerTransaction, viewTag);
+                }
+
+                tx.outputKeys.push_back(outputKey);
+                if (shape.withViewTags) {
+                    tx.viewTags.push_back(viewTag);
+                }
+                tx.amounts.push_back(1000 * (i + 1));
+                tx.outputIndices.push_back(b * 1000 + t * 16 + i);
+                tx.assetTypeOutputIndices.push_back(b * 1000 + t * 16 + i);
+            }
+            blocks[b].transactions.push_back(std::move(tx));
+        }
+    }
+    return blocks;
+}
+
+int main() {
+    // Each batch logs its matches, which would be timed with the scan
+    Logger::getInstance().setLogLevel(LogLevel::WARNING);
+
+    crypto::public_key viewPublicKey;
+    crypto::secret_key viewSecretKey;
+    crypto::public_key spendPublicKey;
+    crypto::secret_key spendSecretKey;
+    crypto::generate_keys(viewPublicKey, viewSecretKey);
+    crypto::generate_keys(spendPublicKey, spendSecretKey);
+
+    std::printf("%-26s %10s %14s %14s\n", "chain", "outputs", "outputs/s", "tx/s");
+
+    for (const ChainShape& shape : CHAINS) {
+        size_t paidOutputs = 0;
+        std::vector<ScanBlock> blocks = makeBlocks(shape, viewPublicKey, spendPublicKey, paidOutputs);
+
+        OutputScanner scanner(viewSecretKey, spendPublicKey);
+        size_t batches = 0;
+        double seconds = 0;
+        auto start = std::chrono::steady_clock::now();
+        while (seconds < MIN_SECONDS) {
+            size_t found = scanner.scanBlocks(blocks);
+            if (found != paidOutputs) {
+                std::fprintf(stderr, "%s: found %zu of %zu outputs\n", shape.name, found, paidOutputs);
+                return 1;
+            }
+            ++batches;
+            seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+
+        size_t transactions = BLOCKS_PER_BATCH * TRANSACTIONS_PER_BLOCK;
+        size_t outputs = transactions * shape.outputsPerTransaction;
+        std::printf("%-26s %10zu %14.0f %14.0f\n", shape.name, outputs, batches * outputs / seconds,
+                    batches * transactions / seconds);
+    }
+    return 0;
+}
@@ -0,0 +1,146 @@
+/**
+ * LuminaChain Wallet - Transaction Benchmark
+ *
+ * This file measures how fast transactions are created, which is mostly
+ * the hashing of their contents into an ID, next to the random IDs they
+ * replaced, and how fast they are signed and verified, one at a time and
+ * in batches.
+ *
+ * Copyright (c) 2023 LuminaChain Development Team
+ * Licensed under MIT License
+ */
+
+#include "core/transaction.h"
+#include "utils/logger.h"
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace lumina;
+
+// Number of IDs generated for each measurement
+const int ID_COUNT = 1000000;
+
+// Number of transactions signed and verified for each measurement
+const size_t SIGNED_COUNT = 20000;
+
+// Sizes of the batches verified together
+const size_t BATCH_SIZES[] = {16, 256, 4096};
+
+/**
+ * Gets the seconds elapsed since a start time
+ */
+static double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * Generates a random UUID-style ID, as transactions did before their IDs were content hashes
+ */
+static std::string generateRandomId() {
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    std::uniform_int_distribution<> dis(0, 15);
+
+    const char* hexChars = "0123456789abcdef";
+    std::string uuid;
+
+    for (int i = 0; i < 32; ++i) {
+        uuid += hexChars[dis(gen)];
+        if (i == 7 || i == 11 || i == 15 || i == 19) {
+            uuid += '-';
+        }
+    }
+
+    return "TX-" + uuid;
+}
+
+/**
+ * Calls a function once per transaction, returning the calls per second
+ */
+template <typename Function>
+static double measureRate(std::vector<Transaction>& transactions, Function function) {
+    auto start = std::chrono::steady_clock::now();
+    for (Transaction& transaction : transactions) {
+        function(transaction);
+    }
+    return transactions.size() / secondsSince(start);
+}
+
+/**
+ * Measures signing and verifying, returning false if a valid signature was rejected
+ */
+static bool measureSignatures() {
+    crypto::public_key publicKey;
+    crypto::secret_key secretKey;
+    crypto::generate_keys(publicKey, secretKey);
+    SigningKey key;
+    if (!key.setSecretKey(secretKey)) {
+        std::fprintf(stderr, "Failed to create a signing key\n");
+        return false;
+    }
+
+    std::vector<Transaction> transactions;
+    transactions.reserve(SIGNED_COUNT);
+    for (size_t i = 0; i < SIGNED_COUNT; ++i) {
+        transactions.emplace_back("LMTsender", "LMTrecipient" + std::to_string(i % 7), Amount(i + 1),
+                                  LMT_ASSET_ID, i);
+    }
+
+    bool valid = true;
+    double signRate = measureRate(transactions, [&](Transaction& transaction) {
+        valid = transaction.sign(key) && valid;
+    });
+    double verifyRate = measureRate(transactions, [&](Transaction& transaction) {
+        valid = transaction.verifySignature() && valid;
+    });
+    double verifyKeyRate = measureRate(transactions, [&](Transaction& transaction) {
+        valid = transaction.verifySignature(key) && valid;
+    });
+
+    std::printf("Signatures per second (%zu transactions):\n", SIGNED_COUNT);
+    std::printf("  sign                            %12.0f\n", signRate);
+    std::printf("  verify                          %12.0f\n", verifyRate);
+    std::printf("  verify with the signing key     %12.0f\n", verifyKeyRate);
+
+    for (size_t batchSize : BATCH_SIZES) {
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i + batchSize <= transactions.size(); i += batchSize) {
+            valid = Transaction::verifySignatures(transactions.data() + i, batchSize) && valid;
+        }
+        size_t verified = transactions.size() / batchSize * batchSize;
+        std::printf("  verify in batches of %-10zu %12.0f\n", batchSize, verified / secondsSince(start));
+    }
+
+    if (!valid) {
+        std::fprintf(stderr, "A valid signature was rejected\n");
+    }
+    return valid;
+}
+
+int main() {
+    Logger::getInstance().setLogLevel(LogLevel::WARNING);
+
+    size_t totalSize = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < ID_COUNT; ++i) {
+        totalSize += generateRandomId().size();
+    }
+    double randomRate = ID_COUNT / secondsSince(start);
+
+    // Every transaction differs in its nonce, as a wallet's transfers do
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < ID_COUNT; ++i) {
+        Transaction transaction("LMTsender", "LMTrecipient", Amount(1000), LMT_ASSET_ID, i);
+        totalSize += transaction.getId().size();
+    }
+    double hashedRate = ID_COUNT / secondsSince(start);
+
+    std::printf("Transaction IDs per second (%zu bytes):\n", totalSize);
+    std::printf("  random UUID                     %12.0f\n", randomRate);
+    std::printf("  new transaction, content hash   %12.0f\n", hashedRate);
+
+    return measureSignatures() ? 0 : 1;
+}
@@ -125,6 +125,8 @@ private:
     CommandResult handleWalletInfo(const std::vector<std::string>& args);
     CommandResult handleBalance(const std::vector<std::string>& args);
     CommandResult handleTransfer(const std::vector<std::string>& args);
+    CommandResult handleTransferBatch(const std::vector<std::string>& args);
+    CommandResult handleHistory(const std::vector<std::string>& args);
     CommandResult handleSeed(const std::vector<std::string>& args);
     CommandResult handleExecuteContract(const std::vector<std::string>& args);
     CommandResult handleRefresh(const std::vector<std::string>& args);
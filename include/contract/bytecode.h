@@ -0,0 +1,174 @@
+/**
+ * LuminaChain Wallet - Contract Bytecode
+ *
+ * This file defines the instruction set and the compiled form of Lumina
+ * smart contracts.
+ *
+ * Copyright (c) 2023 LuminaChain Development Team
+ * Licensed under MIT License
+ */
+
+#ifndef LUMINA_CONTRACT_BYTECODE_H
+#define LUMINA_CONTRACT_BYTECODE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace lumina {
+
+/**
+ * The instruction set, as X(name, gas cost)
+ *
+ * R[x] is register x of the current call frame, K[x] constant x and S[x]
+ * string x of the contract. Jump offsets are relative to the next
+ * instruction. GAS costs nothing itself: the compiler places one at the
+ * start of each basic block, charging the summed cost of the block.
+ */
+#define LUMA_OPCODES(X)                                                              \
+    X(GAS, 0)       /* Charge Bx gas for a block of A instructions            */     \
+    X(LOADI, 1)     /* R[A] = sBx                                             */     \
+    X(LOADK, 1)     /* R[A] = K[Bx]                                           */     \
+    X(MOVE, 1)      /* R[A] = R[B]                                            */     \
+    X(ADD, 1)       /* R[A] = R[B] + R[C]                                     */     \
+    X(SUB, 1)       /* R[A] = R[B] - R[C]                                     */     \
+    X(MUL, 2)       /* R[A] = R[B] * R[C]                                     */     \
+    X(DIV, 4)       /* R[A] = R[B] / R[C], failing on division by zero        */     \
+    X(MOD, 4)       /* R[A] = R[B] % R[C], failing on division by zero        */     \
+    X(NEG, 1)       /* R[A] = -R[B]                                           */     \
+    X(NOT, 1)       /* R[A] = R[B] == 0                                       */     \
+    X(BOOL, 1)      /* R[A] = R[B] != 0                                       */     \
+    X(EQ, 1)        /* R[A] = R[B] == R[C]                                    */     \
+    X(NE, 1)        /* R[A] = R[B] != R[C]                                    */     \
+    X(LT, 1)        /* R[A] = R[B] < R[C]                                     */     \
+    X(LE, 1)        /* R[A] = R[B] <= R[C]                                    */     \
+    X(JMP, 1)       /* pc += sBx                                              */     \
+    X(JMPIF, 1)     /* if R[A] != 0, pc += sBx                                */     \
+    X(JMPIFNOT, 1)  /* if R[A] == 0, pc += sBx                                */     \
+    X(FORPREP, 1)   /* if !(R[A] < R[A+1]), pc += sBx                         */     \
+    X(FORLOOP, 1)   /* R[A] += 1 (wrapping); if R[A] < R[A+1], pc += sBx      */     \
+    X(CALL, 10)     /* R[A] = function B called with R[A+1] .. R[A+C]         */     \
+    X(RET, 2)       /* Return R[A]                                            */     \
+    X(SLOAD, 50)    /* R[A] = storage[S[Bx]]                                  */     \
+    X(SLOADX, 50)   /* R[A] = storage[S[B] + "/" + R[C]]                      */     \
+    X(SSTORE, 200)  /* storage[S[Bx]] = R[A]                                  */     \
+    X(SSTOREX, 200) /* storage[S[B] + "/" + R[C]] = R[A]                      */
+
+/**
+ * Operation codes
+ */
+enum class Opcode : uint8_t {
+#define LUMA_OPCODE_ENUM(name, cost) name,
+    LUMA_OPCODES(LUMA_OPCODE_ENUM)
+#undef LUMA_OPCODE_ENUM
+};
+
+/**
+ * Number of operation codes
+ */
+constexpr size_t OPCODE_COUNT = 0
+#define LUMA_OPCODE_COUNT(name, cost) + 1
+    LUMA_OPCODES(LUMA_OPCODE_COUNT)
+#undef LUMA_OPCODE_COUNT
+    ;
+
+/**
+ * Gas cost of each operation, indexed by opcode
+ */
+constexpr uint32_t OPCODE_GAS_COST[OPCODE_COUNT] = {
+#define LUMA_OPCODE_COST(name, cost) cost,
+    LUMA_OPCODES(LUMA_OPCODE_COST)
+#undef LUMA_OPCODE_COST
+};
+
+/**
+ * Gets the mnemonic of an opcode
+ *
+ * @param opcode The opcode
+ * @return The mnemonic, e.g. "ADD"
+ */
+const char* opcodeName(Opcode opcode);
+
+/**
+ * A 32-bit instruction: an opcode and either three 8-bit operands A, B
+ * and C, or A and a 16-bit operand Bx formed from B and C
+ */
+struct Instruction {
+    Opcode op;
+    uint8_t a;
+    uint8_t b;
+    uint8_t c;
+
+    uint16_t bx() const { return static_cast<uint16_t>((b << 8) | c); }
+    int16_t sbx() const { return static_cast<int16_t>(bx()); }
+
+    static Instruction makeABC(Opcode op, uint8_t a, uint8_t b, uint8_t c) {
+        return {op, a, b, c};
+    }
+
+    static Instruction makeABx(Opcode op, uint8_t a, uint16_t bx) {
+        return {op, a, static_cast<uint8_t>(bx >> 8), static_cast<uint8_t>(bx & 0xff)};
+    }
+
+    static Instruction makeAsBx(Opcode op, uint8_t a, int16_t sbx) {
+        return makeABx(op, a, static_cast<uint16_t>(sbx));
+    }
+};
+
+static_assert(sizeof(Instruction) == 4, "Instructions must be 32 bits");
+
+/**
+ * Maximum number of registers of a function
+ */
+const size_t MAX_FUNCTION_REGISTERS = 256;
+
+/**
+ * A compiled contract function
+ */
+struct CompiledFunction {
+    std::string name;                   // Function name
+    uint8_t paramCount = 0;             // Parameters, held in the first registers
+    uint16_t registerCount = 0;         // Registers used by the function
+    std::vector<std::string> params;    // Parameter names
+    std::vector<Instruction> code;      // Instructions
+};
+
+/**
+ * A contract compiled to bytecode
+ */
+struct CompiledContract {
+    std::string name;                           // Contract name
+    std::vector<int64_t> constants;             // K: integers too large for LOADI
+    std::vector<std::string> strings;           // S: storage keys
+    std::vector<CompiledFunction> functions;    // Functions, called by index
+
+    /**
+     * Finds a function by name
+     *
+     * @param functionName The function name
+     * @return The function index, or -1 if there is no such function
+     */
+    int findFunction(const std::string& functionName) const;
+};
+
+/**
+ * Checks that a compiled contract is safe to run
+ *
+ * Every operand must be in range, every function must end with a return
+ * or jump, and its code must split into blocks that each start with a
+ * GAS instruction charging the summed cost and count of the instructions
+ * after it. A block holds no other GAS and branches only at its end, and
+ * every jump must land on a GAS instruction, so no instruction runs
+ * uncharged. Contracts from the compiler always pass; this guards
+ * bytecode read back from disk.
+ *
+ * @param contract The compiled contract
+ * @param error Output parameter for the reason the check failed
+ * @return true if the contract is well formed
+ */
+bool verifyContract(const CompiledContract& contract, std::string& error);
+
+} // namespace lumina
+
+#endif // LUMINA_CONTRACT_BYTECODE_H
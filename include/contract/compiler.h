@@ -0,0 +1,184 @@
+/**
+ * LuminaChain Wallet - Contract Compiler
+ *
+ * This file defines the ContractCompiler class which compiles Lumina
+ * smart contract source (.luma) into bytecode.
+ *
+ * Copyright (c) 2023 LuminaChain Development Team
+ * Licensed under MIT License
+ */
+
+#ifndef LUMINA_CONTRACT_COMPILER_H
+#define LUMINA_CONTRACT_COMPILER_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "contract/bytecode.h"
+
+namespace lumina {
+
+/**
+ * Compiles Lumina smart contracts into bytecode
+ *
+ * A contract is a set of functions over 64-bit integers:
+ *
+ *     contract Counter {
+ *         function main(n) {
+ *             let total = load("total");
+ *             for i in 0..n {
+ *                 total = total + i;
+ *             }
+ *             store("total", total);
+ *             return total;
+ *         }
+ *     }
+ *
+ * Statements are let, assignment, if/else, while, for-in over a range,
+ * return, store and function calls. load(key[, index]) and
+ * store(key[, index], value) access contract storage; an index makes the
+ * key "key/index". && and || short-circuit and, like comparisons, yield
+ * 0 or 1. Line comments start with //.
+ *
+ * The compiler makes a single pass, emitting register code directly
+ * without building a syntax tree, then inserts the gas charge of each
+ * basic block at its start.
+ */
+class ContractCompiler {
+public:
+    /**
+     * Compiles contract source
+     *
+     * @param source The contract source
+     * @param contract Output parameter for the compiled contract
+     * @return true if the source compiled
+     */
+    bool compile(std::string_view source, CompiledContract& contract);
+
+    /**
+     * Gets the error of the last failed compilation
+     *
+     * @return The error message, with its line number
+     */
+    const std::string& getError() const;
+
+private:
+    enum class TokenType {
+        END, IDENTIFIER, NUMBER, STRING,
+        CONTRACT, FUNCTION, LET, IF, ELSE, WHILE, FOR, IN, RETURN, LOAD, STORE, TRUE, FALSE,
+        LPAREN, RPAREN, LBRACE, RBRACE, COMMA, SEMICOLON, RANGE,
+        ASSIGN, PLUS, MINUS, STAR, SLASH, PERCENT, NOT,
+        EQ, NE, LT, LE, GT, GE, AND, OR
+    };
+
+    struct Token {
+        TokenType type;
+        std::string_view text;
+        int64_t number;
+        int line;
+    };
+
+    // Where the value of a compiled expression is
+    struct ExprDesc {
+        enum Kind {
+            CONSTANT,   // Known at compile time, in value
+            LOCAL,      // In the register of a local variable
+            TEMP,       // In a temporary register
+            RELOC       // Produced by the instruction at pc, whose target register is still open
+        } kind;
+        int64_t value;
+        uint8_t reg;
+        size_t pc;
+    };
+
+    struct Local {
+        std::string_view name;
+        uint8_t reg;
+    };
+
+    struct PendingCall {
+        size_t function;
+        uint8_t argCount;
+        int line;
+    };
+
+    struct CompileError {
+        std::string message;
+    };
+
+    // Counts one level of nesting of expressions or blocks while it lives
+    class NestingGuard {
+    public:
+        explicit NestingGuard(ContractCompiler& compiler);
+        ~NestingGuard();
+
+    private:
+        ContractCompiler& m_compiler;
+    };
+
+    // Lexer
+    void tokenize(std::string_view source);
+    const Token& peek(size_t ahead = 0) const;
+    Token next();
+    bool accept(TokenType type);
+    void expect(TokenType type, const char* what);
+
+    // Parser and code generator
+    void parseContract(CompiledContract& contract);
+    void parseFunction();
+    void parseBlock();
+    void parseStatement();
+    void parseIf();
+    void parseWhile();
+    void parseFor();
+    void parseStore();
+    ExprDesc parseExpression();
+    ExprDesc parseBinary(int precedence);
+    ExprDesc parseUnary();
+    ExprDesc parsePrimary();
+    ExprDesc parseCall(std::string_view name);
+    ExprDesc parseLoad();
+
+    // Registers
+    uint8_t allocRegister();
+    void freeRegister(uint8_t reg);
+    void freeExpr(const ExprDesc& expr);
+    void toRegister(const ExprDesc& expr, uint8_t reg);
+    uint8_t toAnyRegister(ExprDesc& expr);
+    int findLocal(std::string_view name) const;
+    uint8_t declareLocal(std::string_view name);
+
+    // Code emission
+    CompiledFunction& currentFunction();
+    size_t emit(Instruction instruction);
+    size_t emitJump(Opcode op, uint8_t reg);
+    void patchJump(size_t jumpPc, size_t targetPc);
+    uint16_t constantIndex(int64_t value);
+    uint16_t stringIndex(std::string_view text);
+    size_t functionIndex(std::string_view name);
+    void insertGasCharges(CompiledFunction& function);
+
+    [[noreturn]] void fail(const std::string& message) const;
+
+    std::vector<Token> m_tokens;
+    size_t m_position = 0;
+
+    CompiledContract* m_contract = nullptr;
+    size_t m_currentFunction = 0;
+    std::vector<Local> m_locals;
+    size_t m_freeRegister = 0;
+    size_t m_nestingDepth = 0;
+    std::unordered_map<std::string_view, size_t> m_functionIndices;
+    std::vector<bool> m_functionDefined;
+    std::vector<PendingCall> m_calls;
+    std::unordered_map<int64_t, uint16_t> m_constantIndices;
+    std::unordered_map<std::string_view, uint16_t> m_stringIndices;
+
+    std::string m_error;
+};
+
+} // namespace lumina
+
+#endif // LUMINA_CONTRACT_COMPILER_H
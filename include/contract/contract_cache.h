@@ -0,0 +1,115 @@
+/**
+ * LuminaChain Wallet - Compiled Contract Cache
+ *
+ * This file defines the ContractCache class which keeps compiled Lumina
+ * smart contracts, keyed by a hash of their source.
+ *
+ * Copyright (c) 2023 LuminaChain Development Team
+ * Licensed under MIT License
+ */
+
+#ifndef LUMINA_CONTRACT_CACHE_H
+#define LUMINA_CONTRACT_CACHE_H
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include "contract/bytecode.h"
+#include "crypto/hash.h"
+
+namespace lumina {
+
+/**
+ * Default number of compiled contracts kept in memory
+ */
+const size_t CONTRACT_CACHE_DEFAULT_CAPACITY = 64;
+
+/**
+ * Caches compiled contracts by source hash
+ *
+ * Recently used contracts are kept in memory, evicting the least recently
+ * used one when the cache is full. With a cache directory set, compiled
+ * contracts are also written there and read back on a memory miss, so
+ * they survive restarts. Contracts read from disk are verified before
+ * use, and unreadable or stale files are ignored.
+ *
+ * The cache is safe to use from several threads.
+ */
+class ContractCache {
+public:
+    /**
+     * Constructor
+     *
+     * @param capacity Maximum number of contracts kept in memory
+     */
+    explicit ContractCache(size_t capacity = CONTRACT_CACHE_DEFAULT_CAPACITY);
+
+    /**
+     * Sets the maximum number of contracts kept in memory
+     *
+     * @param capacity The capacity, at least 1
+     */
+    void setCapacity(size_t capacity);
+
+    /**
+     * Sets the directory compiled contracts are stored in
+     *
+     * @param directory The directory, created if needed, or empty to keep contracts in memory only
+     * @return false if the directory could not be created
+     */
+    bool setDirectory(const std::string& directory);
+
+    /**
+     * Hashes contract source into a cache key
+     *
+     * @param source The contract source
+     * @return The source hash
+     */
+    static crypto::hash hashSource(std::string_view source);
+
+    /**
+     * Finds a compiled contract
+     *
+     * @param sourceHash Hash of the contract source
+     * @return The compiled contract, or nullptr if it is not cached
+     */
+    std::shared_ptr<const CompiledContract> find(const crypto::hash& sourceHash);
+
+    /**
+     * Adds a compiled contract
+     *
+     * @param sourceHash Hash of the contract source
+     * @param contract The compiled contract
+     */
+    void insert(const crypto::hash& sourceHash, std::shared_ptr<const CompiledContract> contract);
+
+    /**
+     * Removes all contracts from memory, keeping those on disk
+     */
+    void clear();
+
+private:
+    typedef std::pair<std::string, std::shared_ptr<const CompiledContract>> Entry;
+
+    // Prevent copying and assignment
+    ContractCache(const ContractCache&) = delete;
+    ContractCache& operator=(const ContractCache&) = delete;
+
+    void addEntry(const std::string& key, std::shared_ptr<const CompiledContract> contract);
+    std::string artifactPath(const std::string& key) const;
+    std::shared_ptr<const CompiledContract> loadArtifact(const crypto::hash& sourceHash) const;
+    void saveArtifact(const crypto::hash& sourceHash, const CompiledContract& contract) const;
+
+    mutable std::mutex m_mutex;
+    size_t m_capacity;                                                      // Maximum entries in memory
+    std::string m_directory;                                                // Artifact directory, empty for none
+    std::list<Entry> m_entries;                                             // Most recently used first
+    std::unordered_map<std::string, std::list<Entry>::iterator> m_index;    // Entries by key
+};
+
+} // namespace lumina
+
+#endif // LUMINA_CONTRACT_CACHE_H
@@ -0,0 +1,168 @@
+/**
+ * LuminaChain Wallet - Contract State
+ *
+ * This file defines the ContractState class, a copy-on-write store of
+ * contract storage values, and the StateFile class which persists it.
+ *
+ * Copyright (c) 2023 LuminaChain Development Team
+ * Licensed under MIT License
+ */
+
+#ifndef LUMINA_CONTRACT_STATE_H
+#define LUMINA_CONTRACT_STATE_H
+
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include "contract/vm.h"
+
+namespace lumina {
+
+/**
+ * The values written to a state, in key order
+ */
+typedef std::vector<std::pair<std::string, int64_t>> StateDiff;
+
+struct HamtNode;
+
+/**
+ * Contract storage held in a persistent hash array mapped trie
+ *
+ * Nodes are immutable and shared between states: a store copies only the
+ * path from the root to the changed value, so forking a state is O(1)
+ * and a fork can be changed or dropped without affecting its origin.
+ * Each state also remembers the keys written since it was forked, which
+ * becomes the compact diff of a commit.
+ *
+ * Concurrent loads from one state are safe; stores are not.
+ */
+class ContractState : public ContractStorage {
+public:
+    /**
+     * Constructor - Creates an empty state
+     */
+    ContractState();
+
+    /**
+     * Loads a value
+     *
+     * @param key The storage key
+     * @return The stored value, or 0 if nothing is stored under the key
+     */
+    int64_t load(const std::string& key) override;
+
+    /**
+     * Stores a value
+     *
+     * @param key The storage key
+     * @param value The value to store
+     */
+    void store(const std::string& key, int64_t value) override;
+
+    /**
+     * Finds a value
+     *
+     * @param key The storage key
+     * @param value Output parameter for the stored value
+     * @return false if nothing is stored under the key
+     */
+    bool find(const std::string& key, int64_t& value) const;
+
+    /**
+     * Forks the state in O(1)
+     *
+     * @return A state with the same values and no recorded writes
+     */
+    ContractState fork() const;
+
+    /**
+     * Takes the writes recorded since the state was forked or last diffed
+     *
+     * @return The final value of each written key
+     */
+    StateDiff takeDiff();
+
+    /**
+     * Stores every value of a diff
+     *
+     * @param diff The diff to apply
+     */
+    void apply(const StateDiff& diff);
+
+    /**
+     * Gets the number of stored keys
+     *
+     * @return The number of keys
+     */
+    size_t size() const;
+
+private:
+    std::shared_ptr<const HamtNode> m_root;     // Root of the trie, shared with forks
+    size_t m_size;                              // Number of stored keys
+    std::map<std::string, int64_t> m_writes;    // Keys written since the fork, with their values
+};
+
+/**
+ * Append-only file of contract state diffs
+ *
+ * Each committed diff is appended as one checksummed record. Opening the
+ * file replays the records into a state; a torn record at the end, left
+ * by a crash during a write, is discarded.
+ */
+class StateFile {
+public:
+    /**
+     * Constructor
+     */
+    StateFile();
+
+    /**
+     * Destructor - closes the file
+     */
+    ~StateFile();
+
+    /**
+     * Opens a state file, creating it if needed, and replays it
+     *
+     * @param path Path to the state file
+     * @param state Output parameter for the state the file records
+     * @return true if the file was opened successfully
+     */
+    bool open(const std::string& path, ContractState& state);
+
+    /**
+     * Closes the file
+     */
+    void close();
+
+    /**
+     * Checks whether a file is open
+     *
+     * @return true if a file is open
+     */
+    bool isOpen() const;
+
+    /**
+     * Durably appends a diff
+     *
+     * @param diff The diff to append
+     * @return true if the diff is on disk
+     */
+    bool append(const StateDiff& diff);
+
+private:
+    // Prevent copying and assignment
+    StateFile(const StateFile&) = delete;
+    StateFile& operator=(const StateFile&) = delete;
+
+    std::string m_path;
+    FILE* m_file;
+};
+
+} // namespace lumina
+
+#endif // LUMINA_CONTRACT_STATE_H
@@ -12,11 +12,30 @@
 #define LUMINA_CONTRACT_EXECUTOR_H
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <map>
+#include "core/amount.h"
+#include "contract/compiler.h"
+#include "contract/contract_cache.h"
+#include "contract/contract_state.h"
+#include "contract/gas_estimator.h"
+#include "contract/parallel_executor.h"
+#include "contract/tracer.h"
+#include "contract/vm.h"
 
 namespace lumina {
 
+/**
+ * Default gas limit of a contract execution
+ */
+const uint64_t CONTRACT_DEFAULT_GAS_LIMIT = 10000000;
+
+/**
+ * Price of one unit of contract gas, in atomic units
+ */
+const uint64_t CONTRACT_GAS_PRICE = 1000;
+
 /**
  * Represents the result of a contract execution
  */
@@ -24,6 +43,16 @@ struct ContractResult {
     bool success;           // Whether the execution was successful
     std::string message;    // Result message or error description
     std::string txId;       // Transaction ID if a transaction was created
+    int64_t value = 0;      // Value returned by the contract
+    uint64_t gasUsed = 0;   // Gas charged for the execution
+};
+
+/**
+ * A contract to execute as part of a batch
+ */
+struct ContractInvocation {
+    std::string contractCode;                         // The contract code
+    std::map<std::string, std::string> parameters;    // Parameters of the contract's main function
 };
 
 /**
@@ -46,6 +75,9 @@ public:
     /**
      * Executes a smart contract from a file
      * 
+     * The file is memory-mapped and compiled in place, without copying
+     * its contents.
+     * 
      * @param filePath Path to the contract file
      * @return The result of the contract execution
      */
@@ -57,7 +89,19 @@ public:
      * @param contractCode The contract code as a string
      * @return The result of the contract execution
      */
-    ContractResult executeFromString(const std::string& contractCode);
+    ContractResult executeFromString(std::string_view contractCode);
+    
+    /**
+     * Executes a batch of contracts
+     * 
+     * The contracts run in parallel, each with its own parameters, but
+     * with the results and final storage of running them one after
+     * another in batch order.
+     * 
+     * @param invocations The contracts to execute, in order
+     * @return The result of each contract execution
+     */
+    std::vector<ContractResult> executeBatch(const std::vector<ContractInvocation>& invocations);
     
     /**
      * Sets a parameter for contract execution
@@ -67,22 +111,60 @@ public:
      */
     void setParameter(const std::string& name, const std::string& value);
     
+    /**
+     * Sets the gas limit of contract executions
+     * 
+     * @param gasLimit Maximum gas an execution may use
+     */
+    void setGasLimit(uint64_t gasLimit);
+    
+    /**
+     * Enables or disables tracing of contract executions
+     * 
+     * While tracing, each execution adds to a profile which is rewritten
+     * after it: the file holds folded stacks weighted by gas,
+     * "<file>.cycles" the same weighted by CPU cycles, and
+     * "<file>.report" opcode counts, per-function gas and cycles, and
+     * storage accesses. Batches are not traced.
+     * 
+     * @param filePath Path to the trace file, or empty to disable tracing
+     */
+    void setTraceFile(const std::string& filePath);
+    
     /**
      * Gets the gas cost estimate for executing a contract
      * 
+     * The estimate is a static upper bound where the contract's control
+     * flow allows one, and otherwise the gas of a dry run with the current
+     * parameters, up to the gas limit.
+     * 
      * @param contractCode The contract code
-     * @return Estimated gas cost in LMT
+     * @return Estimated gas cost, or zero if the contract does not compile
      */
-    double estimateGasCost(const std::string& contractCode);
+    Amount estimateGasCost(std::string_view contractCode);
 
 private:
     std::string m_walletAddress;                      // Wallet address for execution
     std::map<std::string, std::string> m_parameters;  // Contract parameters
+    uint64_t m_gasLimit;                              // Gas limit of each execution
+    ContractCompiler m_compiler;                      // Compiles contract source
+    ContractCache m_cache;                            // Compiled contracts by source hash
+    ContractVM m_vm;                                  // Runs compiled contracts
+    ContractState m_state;                            // Storage of executed contracts
+    StateFile m_stateFile;                            // Persists committed state if configured
+    GasEstimator m_gasEstimator;                      // Estimates gas costs
+    ContractTracer m_tracer;                          // Profiles traced executions
+    std::string m_traceFile;                          // Trace output, empty if not tracing
     
     // Internal methods
-    bool validateContract(const std::string& contractCode);
-    std::string preprocessContract(const std::string& contractCode);
-    ContractResult interpretContract(const std::string& processedCode);
+    bool validateContract(std::string_view contractCode);
+    bool preprocessContract(std::string_view contractCode, CompiledContract& contract);
+    std::shared_ptr<const CompiledContract> loadContract(std::string_view contractCode, std::string& error);
+    void commitState(ContractState& state);
+    void writeTrace();
+    static bool buildArguments(const CompiledFunction& function, const std::map<std::string, std::string>& parameters,
+                               std::vector<int64_t>& args, std::string& error);
+    ContractResult interpretContract(const CompiledContract& contract);
 };
 
 } // namespace lumina
@@ -0,0 +1,76 @@
+/**
+ * LuminaChain Wallet - Contract Gas Estimator
+ *
+ * This file defines the GasEstimator class which estimates the gas a
+ * compiled Lumina smart contract uses.
+ *
+ * Copyright (c) 2023 LuminaChain Development Team
+ * Licensed under MIT License
+ */
+
+#ifndef LUMINA_CONTRACT_GAS_ESTIMATOR_H
+#define LUMINA_CONTRACT_GAS_ESTIMATOR_H
+
+#include <cstdint>
+#include <vector>
+#include "contract/bytecode.h"
+#include "contract/contract_state.h"
+#include "contract/vm.h"
+
+namespace lumina {
+
+/**
+ * Represents a gas estimate
+ */
+struct GasEstimate {
+    uint64_t gas = 0;               // Estimated gas
+    bool isUpperBound = false;      // Whether gas bounds every run, from static analysis
+    bool reachedLimit = false;      // Whether a dry run stopped at its gas limit, so more may be needed
+};
+
+/**
+ * Estimates the gas used by compiled contracts
+ *
+ * The estimator first tries to bound a function statically. It builds
+ * the control-flow graph from the basic blocks the compiler delimits with
+ * GAS instructions, collapses loops from the innermost outwards and takes
+ * the most expensive path through the remaining acyclic graph. Loop-free
+ * code is always bounded; a loop is bounded only if it is a for loop
+ * whose start and limit are constants and whose body leaves the counter
+ * alone. Calls add the bound of the callee, so recursion is unbounded.
+ *
+ * Functions that cannot be bounded are dry-run on a fork of the contract
+ * state, up to a gas limit.
+ */
+class GasEstimator {
+public:
+    /**
+     * Computes a static upper bound on the gas of a function
+     *
+     * @param contract The compiled contract
+     * @param functionIndex Index of the function
+     * @param gas Output parameter for the bound
+     * @return false if the function has no static bound
+     */
+    static bool computeBound(const CompiledContract& contract, size_t functionIndex, uint64_t& gas);
+
+    /**
+     * Estimates the gas of a function, dry-running it if it has no static bound
+     *
+     * @param contract The compiled contract
+     * @param functionIndex Index of the function
+     * @param args The function arguments for a dry run
+     * @param gasLimit Maximum gas of a dry run
+     * @param state The contract state, which a dry run forks and never changes
+     * @return The estimate
+     */
+    GasEstimate estimate(const CompiledContract& contract, size_t functionIndex,
+                         const std::vector<int64_t>& args, uint64_t gasLimit, const ContractState& state);
+
+private:
+    ContractVM m_vm;  // Runs dry runs
+};
+
+} // namespace lumina
+
+#endif // LUMINA_CONTRACT_GAS_ESTIMATOR_H
@@ -0,0 +1,87 @@
+/**
+ * LuminaChain Wallet - Parallel Contract Executor
+ *
+ * This file defines the ParallelExecutor class which runs batches of
+ * contract calls speculatively in parallel.
+ *
+ * Copyright (c) 2023 LuminaChain Development Team
+ * Licensed under MIT License
+ */
+
+#ifndef LUMINA_CONTRACT_PARALLEL_EXECUTOR_H
+#define LUMINA_CONTRACT_PARALLEL_EXECUTOR_H
+
+#include <memory>
+#include <vector>
+#include "contract/bytecode.h"
+#include "contract/vm.h"
+
+namespace lumina {
+
+/**
+ * Minimum number of calls per chunk of parallel work
+ */
+const size_t PARALLEL_EXECUTION_MIN_CHUNK = 1;
+
+/**
+ * Number of calls, from a stale one on, checked for running again together
+ */
+const size_t PARALLEL_EXECUTION_RERUN_WINDOW = 256;
+
+/**
+ * Minimum number of stale calls worth running again on the thread pool
+ */
+const size_t PARALLEL_EXECUTION_MIN_RERUN = 4;
+
+/**
+ * A call of a compiled contract function
+ */
+struct ContractCall {
+    std::shared_ptr<const CompiledContract> contract;  // The compiled contract
+    size_t functionIndex = 0;                          // Function to call
+    std::vector<int64_t> args;                         // Function arguments
+};
+
+/**
+ * Runs batches of contract calls in parallel with the results of running
+ * them one after another
+ *
+ * Every call first runs speculatively on the thread pool against the
+ * storage as it was before the batch, recording the keys it reads and
+ * buffering what it writes. The calls are then committed in batch order.
+ * A call whose reads include a key committed since it ran saw stale
+ * state. When the commit reaches one, the stale calls among the next
+ * PARALLEL_EXECUTION_RERUN_WINDOW run again together on the thread pool
+ * against the committed state, and the commit resumes, checking their
+ * reads again. Calls that fail are committed without their writes, as a
+ * serial run would leave them.
+ *
+ * Calls that depend on each other, such as a chain of updates of one key,
+ * make a round go stale again before most of it commits. After such a
+ * round the next stale calls run one at a time on the committing thread,
+ * for twice as many calls each time it happens in a row, so a batch costs
+ * little more than a serial run.
+ *
+ * Results and final storage are therefore identical to running the calls
+ * serially, while independent calls cost one parallel run.
+ */
+class ParallelExecutor {
+public:
+    /**
+     * Runs a batch of calls, applying their writes to the storage in order
+     *
+     * The storage must allow concurrent loads while nothing is stored.
+     *
+     * @param calls The calls in commit order
+     * @param gasLimit Gas limit of each call
+     * @param storage The contract storage
+     * @param reexecuted Output parameter for the number of calls run again after a conflict, may be nullptr
+     * @return The result of each call
+     */
+    static std::vector<ExecutionResult> execute(const std::vector<ContractCall>& calls, uint64_t gasLimit,
+                                                ContractStorage& storage, size_t* reexecuted = nullptr);
+};
+
+} // namespace lumina
+
+#endif // LUMINA_CONTRACT_PARALLEL_EXECUTOR_H
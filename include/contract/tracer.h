@@ -0,0 +1,194 @@
+/**
+ * LuminaChain Wallet - Contract Tracer
+ *
+ * This file defines the ContractTracer class which profiles contract runs.
+ *
+ * Copyright (c) 2023 LuminaChain Development Team
+ * Licensed under MIT License
+ */
+
+#ifndef LUMINA_CONTRACT_TRACER_H
+#define LUMINA_CONTRACT_TRACER_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "contract/bytecode.h"
+
+namespace lumina {
+
+/**
+ * What the samples of a folded-stack profile measure
+ */
+enum class TraceWeight {
+    GAS,    // Gas charged
+    CYCLES  // CPU cycles, or nanoseconds where no cycle counter is available
+};
+
+/**
+ * Profiles contract runs
+ *
+ * A tracer passed to ContractVM::execute counts every instruction by
+ * opcode, attributes gas and cycles to the call stack they were spent
+ * in, and counts loads and stores of each storage key. Profiles add up
+ * over all the runs traced until the tracer is cleared.
+ *
+ * Call stacks are interned in a tree, one node per distinct stack, so a
+ * call costs a lookup among the children of the caller. Cycles are
+ * self time: a function is charged only while it is on top of the stack.
+ *
+ * A tracer must not be shared between threads.
+ */
+class ContractTracer {
+public:
+    /**
+     * Gas, cycles and calls of one call stack
+     */
+    struct StackProfile {
+        uint64_t gas = 0;       // Gas charged by the innermost function
+        uint64_t cycles = 0;    // Self cycles of the innermost function
+        uint64_t calls = 0;     // Number of times the stack was entered
+    };
+
+    /**
+     * Accesses of one storage key
+     */
+    struct StorageProfile {
+        uint64_t loads = 0;
+        uint64_t stores = 0;
+    };
+
+    /**
+     * Constructor
+     */
+    ContractTracer();
+
+    /**
+     * Starts tracing a run
+     *
+     * @param contract The contract being run
+     * @param functionIndex Index of the function the run starts in
+     */
+    void beginRun(const CompiledContract& contract, size_t functionIndex);
+
+    /**
+     * Finishes tracing a run, leaving every function it was in
+     */
+    void endRun();
+
+    /**
+     * Records a call
+     *
+     * @param functionIndex Index of the called function
+     */
+    void enterFunction(size_t functionIndex);
+
+    /**
+     * Records a return
+     */
+    void exitFunction();
+
+    /**
+     * Counts an executed instruction
+     *
+     * @param opcode The opcode of the instruction
+     */
+    void countInstruction(Opcode opcode) {
+        ++m_opcodeCounts[static_cast<size_t>(opcode)];
+    }
+
+    /**
+     * Attributes gas to the current call stack
+     *
+     * @param gas The gas charged
+     */
+    void chargeGas(uint64_t gas) {
+        m_stacks[m_current].profile.gas += gas;
+    }
+
+    /**
+     * Counts a storage load
+     *
+     * @param key The storage key
+     */
+    void countLoad(const std::string& key);
+
+    /**
+     * Counts a storage store
+     *
+     * @param key The storage key
+     */
+    void countStore(const std::string& key);
+
+    /**
+     * Gets the number of instructions executed with an opcode
+     *
+     * @param opcode The opcode
+     * @return The instruction count
+     */
+    uint64_t getOpcodeCount(Opcode opcode) const;
+
+    /**
+     * Gets the profile of each call stack
+     *
+     * @return Profiles by stack, with frames separated by ';'
+     */
+    std::map<std::string, StackProfile> getStackProfiles() const;
+
+    /**
+     * Gets the accesses of each storage key
+     *
+     * @return Accesses by key
+     */
+    const std::map<std::string, StorageProfile>& getStorageProfiles() const;
+
+    /**
+     * Writes the profile as folded stacks, one "frame;frame weight" line
+     * per stack, for flamegraph.pl and compatible viewers
+     *
+     * @param path Path to the output file
+     * @param weight What the weights measure
+     * @return true if the file was written successfully
+     */
+    bool writeFoldedStacks(const std::string& path, TraceWeight weight) const;
+
+    /**
+     * Writes a readable report of opcode counts, per-function gas and
+     * cycles, and storage accesses
+     *
+     * @param path Path to the output file
+     * @return true if the file was written successfully
+     */
+    bool writeReport(const std::string& path) const;
+
+    /**
+     * Discards everything traced so far
+     */
+    void clear();
+
+private:
+    // A distinct call stack, identified by its innermost frame and its caller's stack
+    struct StackNode {
+        std::string frame;                                  // "contract.function"
+        size_t parent;                                      // Caller's stack, or the node itself at the root
+        std::unordered_map<std::string, size_t> children;   // Callee stacks by frame
+        StackProfile profile;
+    };
+
+    size_t childStack(size_t parent, const std::string& frame);
+    std::string stackName(size_t node) const;
+    void chargeCycles();
+
+    std::vector<uint64_t> m_opcodeCounts;                   // Instructions by opcode
+    std::vector<StackNode> m_stacks;                        // Node 0 is the root above all runs
+    std::map<std::string, StorageProfile> m_storage;        // Accesses by storage key
+    std::vector<std::string> m_frames;                      // Frame of each function of the current run
+    size_t m_current;                                       // Stack being executed
+    uint64_t m_lastCycle;                                   // Cycle counter when m_current was last charged
+};
+
+} // namespace lumina
+
+#endif // LUMINA_CONTRACT_TRACER_H
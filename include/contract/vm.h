@@ -0,0 +1,139 @@
+/**
+ * LuminaChain Wallet - Contract Virtual Machine
+ *
+ * This file defines the ContractVM class which runs compiled Lumina smart
+ * contracts, and the storage interface contracts run against.
+ *
+ * Copyright (c) 2023 LuminaChain Development Team
+ * Licensed under MIT License
+ */
+
+#ifndef LUMINA_CONTRACT_VM_H
+#define LUMINA_CONTRACT_VM_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "contract/bytecode.h"
+#include "contract/tracer.h"
+
+namespace lumina {
+
+/**
+ * Maximum depth of nested contract calls
+ */
+const size_t MAX_CALL_DEPTH = 128;
+
+/**
+ * Storage that contracts load from and store to
+ */
+class ContractStorage {
+public:
+    virtual ~ContractStorage() = default;
+
+    /**
+     * Loads a value
+     *
+     * @param key The storage key
+     * @return The stored value, or 0 if nothing is stored under the key
+     */
+    virtual int64_t load(const std::string& key) = 0;
+
+    /**
+     * Stores a value
+     *
+     * @param key The storage key
+     * @param value The value to store
+     */
+    virtual void store(const std::string& key, int64_t value) = 0;
+};
+
+/**
+ * Contract storage held in memory
+ */
+class MemoryContractStorage : public ContractStorage {
+public:
+    int64_t load(const std::string& key) override;
+    void store(const std::string& key, int64_t value) override;
+
+private:
+    std::unordered_map<std::string, int64_t> m_values;
+};
+
+/**
+ * Represents the result of running a contract function
+ */
+struct ExecutionResult {
+    bool success = false;       // Whether the function returned
+    int64_t value = 0;          // Returned value
+    uint64_t gasUsed = 0;       // Gas charged, up to the limit on failure
+    uint64_t instructions = 0;  // Instructions in the blocks that were charged
+    std::string error;          // Error description if the function failed
+};
+
+/**
+ * Runs compiled contracts
+ *
+ * The VM is register based: each call frame is a window of the register
+ * file, and a call places its arguments where the callee's parameters
+ * are, so nothing is copied. Dispatch uses computed goto where the
+ * compiler supports it and a switch otherwise. Gas is charged by the GAS
+ * instruction at the start of each basic block rather than per
+ * instruction.
+ *
+ * A VM keeps its register file between runs and must not be shared
+ * between threads.
+ */
+class ContractVM {
+public:
+    /**
+     * Runs a contract function
+     *
+     * @param contract The compiled contract
+     * @param functionIndex Index of the function to run
+     * @param args The function arguments
+     * @param gasLimit Maximum gas to charge
+     * @param storage The contract storage
+     * @return The result of the run
+     */
+    ExecutionResult execute(const CompiledContract& contract, size_t functionIndex,
+                            const std::vector<int64_t>& args, uint64_t gasLimit, ContractStorage& storage);
+
+    /**
+     * Runs a contract function, profiling it
+     *
+     * Tracing is compiled into a separate copy of the interpreter, so runs
+     * without a tracer pay nothing for it.
+     *
+     * @param contract The compiled contract
+     * @param functionIndex Index of the function to run
+     * @param args The function arguments
+     * @param gasLimit Maximum gas to charge
+     * @param storage The contract storage
+     * @param tracer Records the profile of the run
+     * @return The result of the run
+     */
+    ExecutionResult execute(const CompiledContract& contract, size_t functionIndex,
+                            const std::vector<int64_t>& args, uint64_t gasLimit, ContractStorage& storage,
+                            ContractTracer& tracer);
+
+private:
+    struct Frame {
+        const CompiledFunction* function;   // Caller
+        const Instruction* returnPc;        // Caller instruction after the call
+        size_t base;                        // First register of the caller
+        uint8_t resultRegister;             // Caller register for the returned value
+    };
+
+    template<bool Tracing>
+    ExecutionResult run(const CompiledContract& contract, size_t functionIndex, const std::vector<int64_t>& args,
+                        uint64_t gasLimit, ContractStorage& storage, ContractTracer* tracer);
+
+    std::vector<int64_t> m_registers;  // Register file of all frames
+    std::vector<Frame> m_frames;       // Suspended callers
+};
+
+} // namespace lumina
+
+#endif // LUMINA_CONTRACT_VM_H
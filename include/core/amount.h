@@ -0,0 +1,280 @@
+/**
+ * LuminaChain Wallet - Amount Type
+ *
+ * This file defines the Amount class which represents a token amount
+ * as an integer number of atomic units.
+ *
+ * Copyright (c) 2023 LuminaChain Development Team
+ * Licensed under MIT License
+ */
+
+#ifndef LUMINA_AMOUNT_H
+#define LUMINA_AMOUNT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace lumina {
+
+/**
+ * A token amount in atomic units (1 LMT = 10^12 atomic units)
+ *
+ * Arithmetic is checked and never wraps. Parsing and formatting work on
+ * caller-provided buffers and do not allocate.
+ */
+class Amount {
+public:
+    static constexpr unsigned DECIMALS = 12;
+    static constexpr uint64_t ATOMIC_UNITS_PER_COIN = 1000000000000ULL;
+
+    // Longest formatted amount: 20 digits, the point and 12 decimals
+    static constexpr size_t MAX_FORMATTED_LENGTH = 20 + 1 + DECIMALS;
+
+    constexpr Amount() : m_atomic(0) {}
+    constexpr explicit Amount(uint64_t atomicUnits) : m_atomic(atomicUnits) {}
+
+    /**
+     * Creates an amount from a whole number of coins
+     *
+     * @param coins Number of coins
+     * @param result Output parameter for the amount
+     * @return false if the amount does not fit in 64 bits
+     */
+    static constexpr bool fromCoins(uint64_t coins, Amount& result) {
+        if (coins > UINT64_MAX / ATOMIC_UNITS_PER_COIN) {
+            return false;
+        }
+        result = Amount(coins * ATOMIC_UNITS_PER_COIN);
+        return true;
+    }
+
+    constexpr uint64_t atomicUnits() const { return m_atomic; }
+    constexpr bool isZero() const { return m_atomic == 0; }
+
+    constexpr bool operator==(Amount other) const { return m_atomic == other.m_atomic; }
+    constexpr bool operator!=(Amount other) const { return m_atomic != other.m_atomic; }
+    constexpr bool operator<(Amount other) const { return m_atomic < other.m_atomic; }
+    constexpr bool operator<=(Amount other) const { return m_atomic <= other.m_atomic; }
+    constexpr bool operator>(Amount other) const { return m_atomic > other.m_atomic; }
+    constexpr bool operator>=(Amount other) const { return m_atomic >= other.m_atomic; }
+
+    /**
+     * Adds two amounts
+     *
+     * @return false on overflow, leaving result unchanged
+     */
+    constexpr bool checkedAdd(Amount other, Amount& result) const {
+        if (m_atomic > UINT64_MAX - other.m_atomic) {
+            return false;
+        }
+        result = Amount(m_atomic + other.m_atomic);
+        return true;
+    }
+
+    /**
+     * Subtracts an amount
+     *
+     * @return false if other is larger than this amount, leaving result unchanged
+     */
+    constexpr bool checkedSub(Amount other, Amount& result) const {
+        if (other.m_atomic > m_atomic) {
+            return false;
+        }
+        result = Amount(m_atomic - other.m_atomic);
+        return true;
+    }
+
+    /**
+     * Multiplies the amount by a whole factor, such as a price by a quantity
+     *
+     * @return false on overflow, leaving result unchanged
+     */
+    constexpr bool checkedMul(uint64_t factor, Amount& result) const {
+        if (factor != 0 && m_atomic > UINT64_MAX / factor) {
+            return false;
+        }
+        result = Amount(m_atomic * factor);
+        return true;
+    }
+
+    /**
+     * Scales the amount by numerator / denominator, rounding down, with a
+     * 128-bit intermediate so the product cannot overflow
+     *
+     * @return false if the denominator is zero or the result does not fit
+     */
+    constexpr bool mulDiv(uint64_t numerator, uint64_t denominator, Amount& result) const {
+        if (denominator == 0) {
+            return false;
+        }
+#if defined(__SIZEOF_INT128__)
+        unsigned __int128 scaled = static_cast<unsigned __int128>(m_atomic) * numerator / denominator;
+        if (scaled > UINT64_MAX) {
+            return false;
+        }
+        result = Amount(static_cast<uint64_t>(scaled));
+        return true;
+#else
+        // Compilers without a 128-bit type, such as MSVC, use the portable 128-bit helpers
+        uint64_t high = 0;
+        uint64_t low = 0;
+        multiplyWide(m_atomic, numerator, high, low);
+        uint64_t quotient = 0;
+        if (!divideWide(high, low, denominator, quotient)) {
+            return false;
+        }
+        result = Amount(quotient);
+        return true;
+#endif
+    }
+
+    /**
+     * Parses a decimal amount such as "12", "0.5" or "1.000000000001"
+     *
+     * @param text The text to parse
+     * @param result Output parameter for the parsed amount
+     * @return false if the text is not a valid amount or is out of range
+     */
+    static constexpr bool parse(std::string_view text, Amount& result) {
+        uint64_t whole = 0;
+        uint64_t fraction = 0;
+        unsigned fractionDigits = 0;
+        bool seenPoint = false;
+        bool seenDigit = false;
+
+        for (char c : text) {
+            if (c == '.') {
+                if (seenPoint) {
+                    return false;
+                }
+                seenPoint = true;
+                continue;
+            }
+            if (c < '0' || c > '9') {
+                return false;
+            }
+            seenDigit = true;
+            uint64_t digit = static_cast<uint64_t>(c - '0');
+            if (seenPoint) {
+                if (++fractionDigits > DECIMALS) {
+                    return false;
+                }
+                fraction = fraction * 10 + digit;
+            } else {
+                if (whole > (UINT64_MAX - digit) / 10) {
+                    return false;
+                }
+                whole = whole * 10 + digit;
+            }
+        }
+
+        if (!seenDigit) {
+            return false;
+        }
+
+        for (unsigned i = fractionDigits; i < DECIMALS; ++i) {
+            fraction *= 10;
+        }
+
+        Amount wholeAmount;
+        if (!fromCoins(whole, wholeAmount)) {
+            return false;
+        }
+        return wholeAmount.checkedAdd(Amount(fraction), result);
+    }
+
+    /**
+     * Formats the amount with all decimals, e.g. "1.500000000000"
+     *
+     * @param buffer Output buffer of at least MAX_FORMATTED_LENGTH bytes
+     * @return The number of characters written (no terminator is added)
+     */
+    constexpr size_t format(char* buffer) const {
+        uint64_t whole = m_atomic / ATOMIC_UNITS_PER_COIN;
+        uint64_t fraction = m_atomic % ATOMIC_UNITS_PER_COIN;
+
+        char digits[20] = {};
+        size_t count = 0;
+        do {
+            digits[count++] = static_cast<char>('0' + whole % 10);
+            whole /= 10;
+        } while (whole > 0);
+
+        size_t length = 0;
+        while (count > 0) {
+            buffer[length++] = digits[--count];
+        }
+
+        buffer[length++] = '.';
+        for (unsigned i = DECIMALS; i > 0; --i) {
+            buffer[length + i - 1] = static_cast<char>('0' + fraction % 10);
+            fraction /= 10;
+        }
+
+        return length + DECIMALS;
+    }
+
+    /**
+     * Formats the amount as a string
+     *
+     * @return The formatted amount
+     */
+    std::string toString() const {
+        char buffer[MAX_FORMATTED_LENGTH];
+        return std::string(buffer, format(buffer));
+    }
+
+private:
+#if !defined(__SIZEOF_INT128__)
+    /**
+     * Multiplies two 64-bit integers into a 128-bit product
+     */
+    static constexpr void multiplyWide(uint64_t a, uint64_t b, uint64_t& high, uint64_t& low) {
+        uint64_t aLow = a & 0xffffffffULL;
+        uint64_t aHigh = a >> 32;
+        uint64_t bLow = b & 0xffffffffULL;
+        uint64_t bHigh = b >> 32;
+        
+        uint64_t lowLow = aLow * bLow;
+        uint64_t highLow = aHigh * bLow;
+        uint64_t lowHigh = aLow * bHigh;
+        uint64_t highHigh = aHigh * bHigh;
+        
+        uint64_t middle = (lowLow >> 32) + (highLow & 0xffffffffULL) + (lowHigh & 0xffffffffULL);
+        low = (middle << 32) | (lowLow & 0xffffffffULL);
+        high = highHigh + (highLow >> 32) + (lowHigh >> 32) + (middle >> 32);
+    }
+
+    /**
+     * Divides a 128-bit integer by a 64-bit one, one quotient bit at a time
+     *
+     * @return false if the quotient does not fit in 64 bits
+     */
+    static constexpr bool divideWide(uint64_t high, uint64_t low, uint64_t divisor, uint64_t& quotient) {
+        if (high >= divisor) {
+            return false;
+        }
+        uint64_t remainder = high;
+        quotient = 0;
+        for (int bit = 63; bit >= 0; --bit) {
+            // The remainder is below the divisor, so one more bit overflows it by at most one bit
+            bool overflow = (remainder >> 63) != 0;
+            remainder = (remainder << 1) | ((low >> bit) & 1);
+            quotient <<= 1;
+            if (overflow || remainder >= divisor) {
+                remainder -= divisor;
+                quotient |= 1;
+            }
+        }
+        return true;
+    }
+#endif
+
+    uint64_t m_atomic;  // Amount in atomic units
+};
+
+} // namespace lumina
+
+#endif // LUMINA_AMOUNT_H
@@ -0,0 +1,135 @@
+/**
+ * LuminaChain Wallet - Asset Registry
+ *
+ * This file defines the AssetRegistry class which interns token symbols
+ * into compact asset ids.
+ *
+ * Copyright (c) 2023 LuminaChain Development Team
+ * Licensed under MIT License
+ */
+
+#ifndef LUMINA_ASSET_REGISTRY_H
+#define LUMINA_ASSET_REGISTRY_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+namespace lumina {
+
+/**
+ * Compact identifier of an asset type (token symbol)
+ */
+typedef uint32_t AssetId;
+
+/**
+ * Asset id of the native LMT token, always registered first
+ */
+const AssetId LMT_ASSET_ID = 0;
+
+/**
+ * Asset id returned for unknown symbols
+ */
+const AssetId INVALID_ASSET_ID = UINT32_MAX;
+
+/**
+ * Maximum number of registered assets
+ *
+ * Asset types come from scanned outputs and wallet files, so the registry
+ * is bounded rather than growing with whatever symbols they contain.
+ */
+const size_t MAX_ASSET_COUNT = 1024;
+
+/**
+ * Maximum length of a token symbol, the size of the symbol field of wallet records
+ */
+const size_t MAX_ASSET_SYMBOL_LENGTH = 16;
+
+/**
+ * Interns token symbols into dense asset ids
+ *
+ * Ids are assigned in registration order starting at 0, so they can index
+ * flat arrays. Symbols are never removed, and references returned by
+ * getSymbol stay valid for the lifetime of the process.
+ *
+ * The tables have a fixed capacity and are only appended to, so lookups
+ * read them without locking; only registering a new symbol takes a lock.
+ */
+class AssetRegistry {
+public:
+    /**
+     * Gets the singleton instance of the asset registry
+     *
+     * @return The asset registry instance
+     */
+    static AssetRegistry& getInstance();
+
+    /**
+     * Gets the id of a symbol, registering it if needed
+     *
+     * @param symbol The token symbol
+     * @return The asset id, or INVALID_ASSET_ID if the symbol is empty,
+     *         longer than MAX_ASSET_SYMBOL_LENGTH or the registry is full
+     */
+    AssetId intern(std::string_view symbol);
+
+    /**
+     * Looks up the id of a symbol without registering it
+     *
+     * @param symbol The token symbol
+     * @return The asset id, or INVALID_ASSET_ID if the symbol is unknown
+     */
+    AssetId find(std::string_view symbol) const;
+
+    /**
+     * Gets the symbol of an asset id
+     *
+     * @param id The asset id
+     * @return The token symbol, or an empty string for unknown ids
+     */
+    const std::string& getSymbol(AssetId id) const;
+
+    /**
+     * Gets the number of registered assets
+     *
+     * @return The number of registered assets
+     */
+    size_t size() const;
+
+private:
+    // Private constructor for singleton pattern
+    AssetRegistry();
+
+    // Prevent copying and assignment
+    AssetRegistry(const AssetRegistry&) = delete;
+    AssetRegistry& operator=(const AssetRegistry&) = delete;
+
+    // Slots of the symbol hash table, a power of two at most half full so probes end at an empty slot
+    static constexpr size_t SLOT_COUNT = 2 * MAX_ASSET_COUNT;
+
+    /**
+     * Gets the first hash table slot to probe for a symbol
+     *
+     * @param symbol The token symbol
+     * @return The slot index
+     */
+    static size_t firstSlot(std::string_view symbol);
+
+    // Symbols by id; an entry is written once, before m_count publishes it
+    std::array<std::string, MAX_ASSET_COUNT> m_symbols;
+    std::atomic<size_t> m_count;
+
+    // Open addressing table from symbol to id, each slot 0 or an id plus one
+    std::array<std::atomic<AssetId>, SLOT_COUNT> m_slots;
+
+    // Serializes registrations
+    std::mutex m_mutex;
+};
+
+} // namespace lumina
+
+#endif // LUMINA_ASSET_REGISTRY_H
@@ -0,0 +1,98 @@
+/**
+ * LuminaChain Wallet - Signing Key
+ *
+ * This file defines the SigningKey class which holds a wallet's transaction
+ * signing key together with the values precomputed from it.
+ *
+ * Copyright (c) 2023 LuminaChain Development Team
+ * Licensed under MIT License
+ */
+
+#ifndef LUMINA_SIGNING_KEY_H
+#define LUMINA_SIGNING_KEY_H
+
+#include "crypto/chacha.h"
+#include "crypto/crypto.h"
+#include "ringct/rctOps.h"
+
+namespace lumina {
+
+/**
+ * A transaction signing key with its precomputed public values
+ *
+ * The public key and its table for double-scalar multiplication are
+ * computed once when the key is set, so signing and checking the
+ * wallet's own signatures skip the point decompression and the table
+ * setup that a bare key would need on every call.
+ *
+ * The secret key is kept encrypted with a random per-process key and is
+ * only decrypted into the caller's buffer while it is used.
+ */
+class SigningKey {
+public:
+    /**
+     * Constructor - Creates an unset key
+     */
+    SigningKey();
+
+    /**
+     * Destructor - wipes the secret key
+     */
+    ~SigningKey();
+
+    /**
+     * Sets the secret key and precomputes its public values
+     *
+     * @param secretKey The secret key
+     * @return false if the secret key is not a valid scalar
+     */
+    bool setSecretKey(const crypto::secret_key& secretKey);
+
+    /**
+     * Wipes the key
+     */
+    void clear();
+
+    /**
+     * Checks whether a key is set
+     *
+     * @return true if a key is set
+     */
+    bool isValid() const;
+
+    /**
+     * Decrypts the secret key
+     *
+     * @param secretKey Output parameter for the secret key, to be wiped after use
+     */
+    void getSecretKey(crypto::secret_key& secretKey) const;
+
+    /**
+     * Gets the public key
+     *
+     * @return The public key
+     */
+    const crypto::public_key& getPublicKey() const;
+
+    /**
+     * Gets the double-scalar multiplication table of the public key
+     *
+     * @return The precomputed multiples of the public key
+     */
+    const ge_dsmp& getPublicKeyTable() const;
+
+private:
+    // Prevent copying and assignment, which would leave copies of the secret key
+    SigningKey(const SigningKey&) = delete;
+    SigningKey& operator=(const SigningKey&) = delete;
+
+    crypto::secret_key m_encryptedSecretKey;  // Secret key, encrypted in memory
+    crypto::chacha_iv m_iv;                   // IV of the encrypted secret key
+    crypto::public_key m_publicKey;           // Public key, secretKey * G
+    ge_dsmp m_publicKeyTable;                 // Odd multiples of the public key
+    bool m_valid;                             // Whether a key is set
+};
+
+} // namespace lumina
+
+#endif // LUMINA_SIGNING_KEY_H
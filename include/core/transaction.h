@@ -11,9 +11,16 @@
 #ifndef LUMINA_TRANSACTION_H
 #define LUMINA_TRANSACTION_H
 
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <ctime>
+#include "core/amount.h"
+#include "core/asset_registry.h"
+#include "core/signing_key.h"
+#include "crypto/crypto.h"
+#include "utils/fixed_string.h"
 
 namespace lumina {
 
@@ -26,58 +33,139 @@ enum class TransactionStatus {
     FAILED      // Transaction failed to be processed
 };
 
+/**
+ * Maximum length of a transaction ID
+ */
+const size_t TRANSACTION_ID_LENGTH = 48;
+
+/**
+ * Maximum length of an address stored in a transaction
+ */
+const size_t TRANSACTION_ADDRESS_LENGTH = 112;
+
+/**
+ * Length of a transaction signature: the commitment point R and the scalar s
+ */
+const size_t TRANSACTION_SIGNATURE_LENGTH = 64;
+
+/**
+ * Gets the display name of a transaction status
+ * 
+ * @param status The transaction status
+ * @return The status name, e.g. "PENDING"
+ */
+const char* transactionStatusToString(TransactionStatus status);
+
+/**
+ * Parses a transaction status name, ignoring case
+ * 
+ * @param text The status name
+ * @param status Output parameter for the parsed status
+ * @return true if the name is a valid status
+ */
+bool parseTransactionStatus(const std::string& text, TransactionStatus& status);
+
+/**
+ * Converts a stored status value back to a status
+ * 
+ * @param value The value, as stored in wallet files and journals
+ * @param status Output parameter for the status
+ * @return true if the value is a valid status
+ */
+bool transactionStatusFromValue(uint32_t value, TransactionStatus& status);
+
 /**
  * Represents a transaction in the LuminaChain network
+ *
+ * Transactions are values: the ID, addresses and signature are stored
+ * inline, so a transaction owns no heap memory and histories can be kept
+ * in contiguous arrays. Longer addresses are truncated.
  */
 class Transaction {
 public:
+    /**
+     * Constructor - Creates an empty transaction
+     */
+    Transaction();
+    
     /**
      * Constructor - Creates a new transaction
      * 
+     * The transaction ID is a hash of the transaction contents, so the nonce
+     * must differ between otherwise identical transactions of the sender.
+     * 
      * @param fromAddress The sender address
      * @param toAddress The recipient address
      * @param amount The amount to transfer
-     * @param tokenSymbol The token symbol (default: LMT)
+     * @param assetId The asset id (default: LMT)
+     * @param nonce Distinguishes the sender's transactions (default: 0)
      */
     Transaction(const std::string& fromAddress, 
                 const std::string& toAddress, 
-                double amount, 
-                const std::string& tokenSymbol = "LMT");
+                Amount amount, 
+                AssetId assetId = LMT_ASSET_ID,
+                uint64_t nonce = 0);
+    
+    /**
+     * Constructor - Restores a previously created transaction
+     * 
+     * @param id The transaction ID
+     * @param fromAddress The sender address
+     * @param toAddress The recipient address
+     * @param amount The amount transferred
+     * @param assetId The asset id
+     * @param timestamp The creation time
+     * @param status The transaction status
+     */
+    Transaction(std::string_view id,
+                std::string_view fromAddress, 
+                std::string_view toAddress, 
+                Amount amount, 
+                AssetId assetId,
+                time_t timestamp,
+                TransactionStatus status);
     
     /**
      * Gets the transaction ID
      * 
      * @return The transaction ID
      */
-    std::string getId() const;
+    std::string_view getId() const;
     
     /**
      * Gets the sender address
      * 
      * @return The sender address
      */
-    std::string getFromAddress() const;
+    std::string_view getFromAddress() const;
     
     /**
      * Gets the recipient address
      * 
      * @return The recipient address
      */
-    std::string getToAddress() const;
+    std::string_view getToAddress() const;
     
     /**
      * Gets the transaction amount
      * 
      * @return The transaction amount
      */
-    double getAmount() const;
+    Amount getAmount() const;
+    
+    /**
+     * Gets the asset id
+     * 
+     * @return The asset id
+     */
+    AssetId getAssetId() const;
     
     /**
      * Gets the token symbol
      * 
      * @return The token symbol
      */
-    std::string getTokenSymbol() const;
+    const std::string& getTokenSymbol() const;
     
     /**
      * Gets the transaction timestamp
@@ -101,12 +189,45 @@ public:
     void setStatus(TransactionStatus status);
     
     /**
-     * Signs the transaction with the sender's private key
+     * Signs the transaction with the sender's key
      * 
-     * @param privateKey The sender's private key
+     * Signatures are Schnorr signatures (R, s) over ed25519 with a
+     * deterministic nonce, so signing needs no random numbers.
+     * 
+     * @param key The sender's signing key
      * @return true if signing was successful
      */
-    bool sign(const std::string& privateKey);
+    bool sign(const SigningKey& key);
+    
+    /**
+     * Gets the public key that signed the transaction
+     * 
+     * @return The signer's public key
+     */
+    const crypto::public_key& getSignerKey() const;
+    
+    /**
+     * Gets the signature
+     * 
+     * @return The signature, R || s, or an empty view if the transaction is unsigned
+     */
+    std::string_view getSignature() const;
+    
+    /**
+     * Restores a signature saved with a previously created transaction
+     * 
+     * @param signerKey The signer's public key
+     * @param signature The signature, R || s
+     * @return false if the signature has the wrong size
+     */
+    bool restoreSignature(const crypto::public_key& signerKey, std::string_view signature);
+    
+    /**
+     * Checks whether the transaction has been signed
+     * 
+     * @return true if the transaction carries a signature
+     */
+    bool isSigned() const;
     
     /**
      * Verifies the transaction signature
@@ -115,6 +236,31 @@ public:
      */
     bool verifySignature() const;
     
+    /**
+     * Verifies the transaction signature against a known key
+     * 
+     * Uses the key's precomputed table, which makes checking the
+     * wallet's own transactions cheaper than verifySignature().
+     * 
+     * @param key The expected signer's key
+     * @return true if the signature is valid and made with the key
+     */
+    bool verifySignature(const SigningKey& key) const;
+    
+    /**
+     * Verifies the signatures of many transactions at once
+     * 
+     * All signature equations are combined with random weights into
+     * multi-scalar multiplications, which are split across the thread
+     * pool. This is much faster than verifying each signature, but only
+     * tells whether all of them are valid.
+     * 
+     * @param transactions The transactions to verify
+     * @param count The number of transactions
+     * @return true if every transaction carries a valid signature
+     */
+    static bool verifySignatures(const Transaction* transactions, size_t count);
+    
     /**
      * Converts the transaction to a string representation
      * 
@@ -123,17 +269,21 @@ public:
     std::string toString() const;
 
 private:
-    std::string m_id;             // Transaction ID
-    std::string m_fromAddress;    // Sender address
-    std::string m_toAddress;      // Recipient address
-    double m_amount;              // Transaction amount
-    std::string m_tokenSymbol;    // Token symbol
-    time_t m_timestamp;           // Transaction timestamp
-    TransactionStatus m_status;   // Transaction status
-    std::string m_signature;      // Transaction signature
+    FixedString<TRANSACTION_ID_LENGTH> m_id;                // Transaction ID
+    FixedString<TRANSACTION_ADDRESS_LENGTH> m_fromAddress;  // Sender address
+    FixedString<TRANSACTION_ADDRESS_LENGTH> m_toAddress;    // Recipient address
+    Amount m_amount;                                        // Transaction amount
+    AssetId m_assetId;                                      // Asset id
+    time_t m_timestamp;                                     // Transaction timestamp
+    TransactionStatus m_status;                             // Transaction status
+    crypto::public_key m_signerKey;                         // Signer's public key
+    FixedString<TRANSACTION_SIGNATURE_LENGTH> m_signature;  // Signature, R || s
     
     // Internal methods
-    std::string generateId() const;
+    void generateId(uint64_t nonce);
+    void computeChallenge(const unsigned char* commitment, unsigned char* challenge) const;
+    bool parseSignature(unsigned char* challenge, const unsigned char*& commitment,
+                        const unsigned char*& response) const;
 };
 
 } // namespace lumina
@@ -0,0 +1,173 @@
+/**
+ * LuminaChain Wallet - Transaction History Index
+ *
+ * This file defines the TransactionHistory class which indexes the wallet's
+ * transaction history for lookups and paged queries.
+ *
+ * Copyright (c) 2023 LuminaChain Development Team
+ * Licensed under MIT License
+ */
+
+#ifndef LUMINA_TRANSACTION_HISTORY_H
+#define LUMINA_TRANSACTION_HISTORY_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <set>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "core/transaction.h"
+
+namespace lumina {
+
+/**
+ * Position of a transaction in the wallet history, in creation order
+ */
+typedef size_t HistoryPosition;
+
+// Page size of a history query, also used when a query's limit is 0
+const size_t HISTORY_DEFAULT_PAGE_SIZE = 20;
+
+/**
+ * Resumes a paged history query after the last returned transaction
+ */
+struct HistoryCursor {
+    int64_t timestamp = 0;        // Timestamp of the last returned transaction
+    HistoryPosition position = 0; // Position of the last returned transaction
+    bool valid = false;           // false to start from the first page
+
+    /**
+     * Encodes the cursor as text, e.g. for the command line
+     *
+     * @return The encoded cursor
+     */
+    std::string toString() const;
+
+    /**
+     * Decodes a cursor produced by toString
+     *
+     * @param text The encoded cursor
+     * @param cursor Output parameter for the decoded cursor
+     * @return true if the text is a valid cursor
+     */
+    static bool parse(const std::string& text, HistoryCursor& cursor);
+};
+
+/**
+ * Filters and paging of a history query
+ */
+struct HistoryQuery {
+    std::string counterparty;                             // Only this address, if not empty
+    bool filterStatus = false;                            // Whether to filter by status
+    TransactionStatus status = TransactionStatus::PENDING; // Status to filter by
+    int64_t startTime = INT64_MIN;                        // Earliest timestamp, inclusive
+    int64_t endTime = INT64_MAX;                          // Latest timestamp, inclusive
+    bool newestFirst = true;                              // Order of the results
+    size_t limit = HISTORY_DEFAULT_PAGE_SIZE;             // Maximum number of results
+    HistoryCursor after;                                  // Where the previous page ended
+};
+
+/**
+ * One page of query results
+ */
+struct HistoryPage {
+    std::vector<HistoryPosition> positions; // Matching transactions in query order
+    HistoryCursor next;                     // Cursor for the following page
+    bool hasMore = false;                   // Whether more results follow
+};
+
+/**
+ * Indexes the wallet's transaction history
+ *
+ * Transactions are indexed by ID, by timestamp, by counterparty address
+ * and by status. Lookups, status updates and the start of each page are
+ * O(log n); the index stores positions, and the wallet resolves them to
+ * transactions.
+ */
+class TransactionHistory {
+public:
+    /**
+     * Adds the next transaction in the history
+     *
+     * @param id The transaction ID
+     * @param counterparty The other party's address
+     * @param timestamp The transaction timestamp
+     * @param status The transaction status
+     * @return The position of the transaction
+     */
+    HistoryPosition add(std::string_view id, std::string_view counterparty,
+                        int64_t timestamp, TransactionStatus status);
+
+    /**
+     * Finds a transaction by ID
+     *
+     * @param id The transaction ID
+     * @param position Output parameter for the position of the transaction
+     * @return true if the transaction was found
+     */
+    bool find(const std::string& id, HistoryPosition& position) const;
+
+    /**
+     * Gets the indexed status of a transaction
+     *
+     * @param position The position of the transaction
+     * @return The transaction status
+     */
+    TransactionStatus getStatus(HistoryPosition position) const;
+
+    /**
+     * Updates the status of a transaction
+     *
+     * @param position The position of the transaction
+     * @param status The new status
+     */
+    void setStatus(HistoryPosition position, TransactionStatus status);
+
+    /**
+     * Runs a paged query
+     *
+     * @param query The filters and paging of the query
+     * @return The matching transactions of the requested page
+     */
+    HistoryPage query(const HistoryQuery& query) const;
+
+    /**
+     * Gets the number of indexed transactions
+     *
+     * @return The number of transactions
+     */
+    size_t size() const;
+
+    /**
+     * Removes all transactions from the index
+     */
+    void clear();
+
+private:
+    // Index keys order transactions by time, then by position
+    typedef std::pair<int64_t, HistoryPosition> TimeKey;
+    typedef std::set<TimeKey> TimeIndex;
+
+    struct Entry {
+        int64_t timestamp;
+        uint32_t counterparty;
+        TransactionStatus status;
+    };
+
+    static size_t statusIndex(TransactionStatus status);
+
+    std::vector<Entry> m_entries;                              // Indexed by position
+    std::unordered_map<std::string, HistoryPosition> m_byId;
+    TimeIndex m_byTime;
+    std::unordered_map<std::string, uint32_t> m_counterpartyIds;
+    std::vector<TimeIndex> m_byCounterparty;                   // Indexed by counterparty id
+    std::array<TimeIndex, 3> m_byStatus;                       // Indexed by status
+};
+
+} // namespace lumina
+
+#endif // LUMINA_TRANSACTION_HISTORY_H
@@ -15,14 +15,49 @@
 #include <vector>
 #include <map>
 #include <memory>
+#include <set>
+#include <utility>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include "core/amount.h"
+#include "core/asset_registry.h"
+#include "core/seed_words.h"
+#include "core/signing_key.h"
+#include "core/transaction.h"
+#include "core/transaction_history.h"
+#include "core/wallet_file.h"
+#include "core/wallet_journal.h"
+#include "network/sync.h"
 
 // Forward declarations
 namespace lumina {
-    class Transaction;
+    struct ScannedOutput;
+    class OutputScanner;
 }
 
 namespace lumina {
 
+/**
+ * An output received by the wallet
+ */
+struct ReceivedOutput {
+    uint64_t height;        // Height of the block containing the output
+    std::string txHash;     // Hash of the transaction containing the output
+    uint32_t outputIndex;   // Index of the output in its transaction
+    uint64_t amount;        // Amount in atomic units
+    AssetId assetId;        // Asset type
+};
+
+/**
+ * One destination of a batch transfer
+ */
+struct TransferDestination {
+    std::string address;             // Recipient address
+    Amount amount;                   // Amount to transfer
+    AssetId assetId = LMT_ASSET_ID;  // Asset to transfer
+};
+
 /**
  * Represents a wallet in the LuminaChain network
  */
@@ -44,6 +79,9 @@ public:
     /**
      * Creates a new wallet with a random seed
      * 
+     * Fails if a wallet file already exists at the wallet path, even one
+     * that could not be opened.
+     * 
      * @return true if wallet creation was successful
      */
     bool create();
@@ -51,6 +89,9 @@ public:
     /**
      * Recovers a wallet using a 12-word seed phrase
      * 
+     * Fails if a wallet file already exists at the wallet path, even one
+     * that could not be opened.
+     * 
      * @param seedPhrase The 12-word seed phrase
      * @return true if wallet recovery was successful
      */
@@ -66,26 +107,103 @@ public:
     /**
      * Gets the balance of the wallet
      * 
-     * @param tokenSymbol The token symbol (default: LMT)
+     * @param assetId The asset id (default: LMT)
      * @return The balance amount
      */
-    double getBalance(const std::string& tokenSymbol = "LMT") const;
+    Amount getBalance(AssetId assetId = LMT_ASSET_ID) const;
+    
+    /**
+     * Gets the balance of the wallet by token symbol
+     * 
+     * @param tokenSymbol The token symbol
+     * @return The balance amount, zero for unknown tokens
+     */
+    Amount getBalance(const std::string& tokenSymbol) const;
     
     /**
      * Transfers funds to another address
      * 
+     * The transfer is applied once its journal record is queued, so
+     * concurrent transfers see the reduced balance, and undone if the
+     * record fails to reach the disk.
+     * 
+     * @param toAddress The recipient address
+     * @param amount The amount to transfer
+     * @param assetId The asset id (default: LMT)
+     * @return true if the transfer was successful
+     */
+    bool transfer(const std::string& toAddress, Amount amount, AssetId assetId = LMT_ASSET_ID);
+    
+    /**
+     * Transfers funds to another address by token symbol
+     * 
      * @param toAddress The recipient address
      * @param amount The amount to transfer
-     * @param tokenSymbol The token symbol (default: LMT)
+     * @param tokenSymbol The token symbol
      * @return true if the transfer was successful
      */
-    bool transfer(const std::string& toAddress, double amount, const std::string& tokenSymbol = "LMT");
+    bool transfer(const std::string& toAddress, Amount amount, const std::string& tokenSymbol);
+    
+    /**
+     * Transfers funds to many addresses at once
+     * 
+     * All destinations are validated against the balances before any
+     * transfer is made, so an invalid destination or an insufficient
+     * balance of any asset rejects the whole batch. The transfers are
+     * appended to the journal together and recorded with a single commit;
+     * if the commit fails, the whole batch is undone.
+     * 
+     * @param destinations The recipients and amounts
+     * @return true if every transfer was successful
+     */
+    bool transferBatch(const std::vector<TransferDestination>& destinations);
+    
+    /**
+     * Gets the number of transactions in the wallet history
+     * 
+     * @return The number of transactions
+     */
+    size_t getTransactionCount() const;
+    
+    /**
+     * Finds a transaction in the wallet history by ID
+     * 
+     * @param id The transaction ID
+     * @param transaction Output parameter for the transaction
+     * @return true if the transaction was found
+     */
+    bool findTransaction(const std::string& id, Transaction& transaction);
+    
+    /**
+     * Updates the status of a transaction in the wallet history
+     * 
+     * @param id The transaction ID
+     * @param status The new status
+     * @return true if the transaction was found
+     */
+    bool setTransactionStatus(const std::string& id, TransactionStatus status);
+    
+    /**
+     * Gets one page of the wallet history
+     * 
+     * The history index is built on first use, so opening a wallet does not
+     * read its history.
+     * 
+     * @param query Filters and paging of the query
+     * @param transactions Output parameter for the transactions of the page
+     * @return The page, with the cursor for the following page
+     */
+    HistoryPage queryHistory(const HistoryQuery& query, std::vector<Transaction>& transactions);
     
     /**
      * Gets the seed phrase for backup purposes
      * 
+     * The seed is kept encrypted in the wallet file and only decrypted
+     * here, after the password has been checked again.
+     * 
      * @param password The wallet password for verification
-     * @return The 12-word seed phrase
+     * @return The 12-word seed phrase, or an empty string if the password
+     *         is wrong or the wallet holds no seed
      */
     std::string getSeedPhrase(const std::string& password) const;
     
@@ -96,6 +214,47 @@ public:
      */
     bool synchronize();
     
+    /**
+     * Gets the last saved synchronization checkpoint
+     * 
+     * @return The scanned height and recent block hashes
+     */
+    SyncCheckpoint getSyncCheckpoint() const;
+    
+    /**
+     * Stores a new synchronization checkpoint and persists it
+     * 
+     * @param checkpoint The checkpoint reported by the network synchronizer
+     * @return true if the checkpoint was saved successfully
+     */
+    bool setSyncCheckpoint(const SyncCheckpoint& checkpoint);
+    
+    /**
+     * Records an output found by the output scanner and credits its amount
+     * 
+     * @param output The scanned output
+     * @return true if the output was new to the wallet
+     */
+    bool addScannedOutput(const ScannedOutput& output);
+    
+    /**
+     * Creates a scanner for the wallet's outputs
+     * 
+     * The view key is derived from the signing key, and every output the
+     * scanner finds is passed to addScannedOutput, so the scanner must not
+     * outlive the wallet.
+     * 
+     * @return The scanner, or nullptr if the wallet is not initialized
+     */
+    std::shared_ptr<OutputScanner> createOutputScanner();
+    
+    /**
+     * Removes outputs received at or above a height after a chain reorganization
+     * 
+     * @param height The first height that is no longer on the chain
+     */
+    void rollbackToHeight(uint64_t height);
+    
     /**
      * Gets the current status of the wallet
      * 
@@ -109,28 +268,80 @@ public:
      * @param amount The amount to donate
      * @return true if the donation was successful
      */
-    bool donate(double amount);
+    bool donate(Amount amount);
 
 private:
     // Wallet data
     std::string m_walletPath;
     std::string m_mainAddress;
     std::string m_encryptedSeed;
-    std::map<std::string, double> m_balances; // Token symbol -> balance
+    SigningKey m_signingKey;        // Signs the wallet's transactions
+    std::vector<Amount> m_balances; // Indexed by asset id
     
-    // Transaction history
-    std::vector<std::shared_ptr<Transaction>> m_transactions;
+    // Wallet file, which also holds the saved transaction history
+    WalletFile m_walletFile;
+    size_t m_savedTransactionCount;
+    
+    // Transactions created since the last save
+    std::vector<Transaction> m_transactions;
+    
+    // Index over saved and unsaved transactions, built on first use
+    TransactionHistory m_history;
+    bool m_historyIndexed;
+    
+    // Status changes of saved transactions not yet written to the wallet file
+    std::vector<WalletStatusUpdate> m_statusUpdates;
+    
+    // Journal of transfers made since the last save
+    WalletJournal m_journal;
+    uint64_t m_snapshotSequence; // Last journal record contained in the wallet file
+    
+    // Transfers applied to the state whose journal records are not yet committed
+    size_t m_transfersInFlight;
+    std::condition_variable m_transfersSettled;
+    
+    // Synchronization state
+    SyncCheckpoint m_syncCheckpoint;
+    std::vector<ReceivedOutput> m_receivedOutputs;
+    std::set<std::pair<std::string, uint32_t>> m_receivedOutputKeys; // (txHash, outputIndex) of each received output
     
     // Wallet state
     bool m_isInitialized;
     bool m_isSynchronized;
     
+    // Guards the wallet state against the snapshot thread
+    mutable std::mutex m_stateMutex;
+    
+    // Serializes writes of the wallet file
+    std::mutex m_saveMutex;
+    
+    // Background snapshots
+    std::thread m_snapshotThread;
+    std::mutex m_snapshotMutex;
+    std::condition_variable m_snapshotRequested;
+    bool m_snapshotPending;
+    bool m_stopSnapshots;
+    
     // Internal methods
-    bool saveWallet() const;
+    Amount& balanceOf(AssetId assetId);
+    bool saveWallet();
     bool loadWallet();
-    std::string generateSeed() const;
-    std::string encryptSeed(const std::string& seed, const std::string& password) const;
-    std::string decryptSeed(const std::string& encryptedSeed, const std::string& password) const;
+    bool openJournal(bool discardExisting);
+    bool prepareTransfer(const std::string& toAddress, Amount amount, AssetId assetId, size_t nonce,
+                         Transaction& transaction, JournalRecord& record);
+    void applyTransfer(const Transaction& transaction);
+    void rollbackTransfer(std::string_view txId, AssetId assetId, Amount amount);
+    void ensureHistoryIndex();
+    Transaction getHistoryTransaction(HistoryPosition position) const;
+    void applyJournalRecord(const JournalRecord& record);
+    void requestSnapshot();
+    void snapshotLoop();
+    std::string serializeKeys(uint64_t snapshotSequence) const;
+    bool deserializeKeys(const std::string& keySection);
+    SeedWordIndices generateSeed() const;
+    bool deriveSigningKey(const SeedWordIndices& seed);
+    std::string encryptSeed(const SeedWordIndices& seed) const;
+    bool decryptSeed(const std::string& encryptedSeed, SeedWordIndices& seed) const;
 };
 
 } // namespace lumina
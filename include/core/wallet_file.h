@@ -0,0 +1,230 @@
+/**
+ * LuminaChain Wallet - Wallet File Format
+ *
+ * This file defines the WalletFile class which reads and writes the
+ * binary wallet file.
+ *
+ * Copyright (c) 2023 LuminaChain Development Team
+ * Licensed under MIT License
+ */
+
+#ifndef LUMINA_WALLET_FILE_H
+#define LUMINA_WALLET_FILE_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include "crypto/chacha.h"
+#include "crypto/hash.h"
+#include "utils/mapped_file.h"
+
+namespace lumina {
+
+/**
+ * Current version of the wallet file format
+ */
+const uint32_t WALLET_FILE_VERSION = 3;
+
+/**
+ * Fixed header at the start of a wallet file
+ *
+ * Layout of the wallet file:
+ *   header | encrypted key section | status updates
+ *
+ * Layout of the history file next to it:
+ *   history records
+ *
+ * All integers are stored in host (little-endian) byte order.
+ */
+struct WalletFileHeader {
+    char magic[8];               // "LUMWALLT"
+    uint32_t version;            // WALLET_FILE_VERSION
+    uint32_t historyRecordSize;  // sizeof(WalletHistoryRecord)
+    uint64_t keySectionSize;     // Size of the encrypted key section
+    uint64_t historyCount;       // Number of valid records in the history file
+    uint64_t statusUpdateCount;  // Number of status updates after the key section
+    uint8_t iv[8];               // ChaCha20 IV of the key section
+    uint8_t mac[32];             // HMAC-Keccak of the header (with mac zeroed), key section and status updates
+};
+
+static_assert(sizeof(WalletFileHeader) == 80, "Wallet file header must be packed");
+
+/**
+ * Fixed-size transaction history record
+ *
+ * Text fields are zero-padded and not necessarily zero-terminated. The
+ * checksum is keyed with the wallet's MAC key and covers the record's
+ * index, so damaged, forged and reordered records are detected.
+ */
+struct WalletHistoryRecord {
+    char id[48];             // Transaction ID
+    char fromAddress[112];   // Sender address
+    char toAddress[112];     // Recipient address
+    char assetSymbol[16];    // Token symbol
+    uint64_t amount;         // Amount in atomic units
+    int64_t timestamp;       // Creation time
+    uint32_t status;         // TransactionStatus
+    uint32_t signatureSize;  // Size of the signature, 0 for an unsigned transaction
+    uint8_t signerKey[32];   // Signer's public key
+    uint8_t signature[64];   // Signature, R || s
+    uint8_t checksum[16];    // HMAC-Keccak of the record index and the fields above, truncated
+};
+
+static_assert(sizeof(WalletHistoryRecord) == 424, "Wallet history record must be packed");
+
+/**
+ * Status update of a history record, as stored in the wallet file
+ */
+struct WalletStatusRecord {
+    uint64_t index;     // Index of the history record
+    uint32_t status;    // New TransactionStatus
+    uint32_t reserved;  // Always zero
+};
+
+static_assert(sizeof(WalletStatusRecord) == 16, "Wallet status record must be packed");
+
+/**
+ * New status of a saved history record, as (record index, TransactionStatus)
+ */
+typedef std::pair<size_t, uint32_t> WalletStatusUpdate;
+
+/**
+ * Reads and writes the binary wallet file
+ *
+ * The key section holds the wallet's secrets and is encrypted with
+ * ChaCha20 and authenticated with HMAC-Keccak. History records live in a
+ * separate append-only file, "<path>.history", which is memory-mapped
+ * read-only, so opening a wallet does not read its history. History
+ * records are not encrypted, but each carries a keyed checksum.
+ *
+ * A save appends the new records to the history file and syncs it, then
+ * writes a temporary wallet file holding the new record count and the
+ * save's status updates, and renames it over the wallet file. Only then
+ * are the status updates patched into the saved records. A crash leaves
+ * either the old or the new wallet on disk; records past the count are
+ * left over from an interrupted save and are overwritten by the next one,
+ * and loading the new wallet file patches its status updates again. A
+ * save therefore costs the size of the key section, the new records and
+ * the status updates, not of the whole history.
+ */
+class WalletFile {
+public:
+    /**
+     * Constructor - derives the encryption key from the password
+     *
+     * @param path Path to the wallet file
+     * @param password Password to encrypt/decrypt the wallet
+     */
+    WalletFile(const std::string& path, const std::string& password);
+
+    /**
+     * Checks whether the wallet file exists
+     *
+     * @return true if the file exists
+     */
+    bool exists() const;
+
+    /**
+     * Checks a password against the one the wallet file was opened with
+     *
+     * Runs the slow key derivation again, so it is meant for confirming
+     * sensitive operations, not for frequent calls.
+     *
+     * @param password The password to check
+     * @return true if it derives the same encryption key
+     */
+    bool checkPassword(const std::string& password) const;
+
+    /**
+     * Gets the key that encrypts the seed inside the key section
+     *
+     * The seed is encrypted a second time under this key so that it is
+     * never held in the clear while the wallet is open.
+     *
+     * @return The seed key, derived from the encryption key
+     */
+    const crypto::chacha_key& getSeedKey() const;
+
+    /**
+     * Loads the wallet file and maps its history segment
+     *
+     * Status updates of a save interrupted after its rename are patched
+     * into the history file first.
+     *
+     * @param keySection Output parameter for the decrypted key section
+     * @return true if the file was valid and the password correct
+     */
+    bool load(std::string& keySection);
+
+    /**
+     * Saves the wallet atomically
+     *
+     * The new records are appended to the history file and the status
+     * updates are stored in the wallet file; neither takes effect until the
+     * wallet file recording them replaces the old one. The status updates
+     * are patched into the saved records after that.
+     *
+     * @param keySection The key section to encrypt
+     * @param newRecords History records to append
+     * @param statusUpdates Status changes of existing records
+     * @return true if the wallet was saved successfully
+     */
+    bool save(const std::string& keySection, const std::vector<WalletHistoryRecord>& newRecords,
+              const std::vector<WalletStatusUpdate>& statusUpdates);
+
+    /**
+     * Gets the number of history records in the file
+     *
+     * @return The number of history records
+     */
+    size_t getHistoryCount() const;
+
+    /**
+     * Gets a history record
+     *
+     * @param index Index of the record, less than getHistoryCount()
+     * @return The record, pointing into the mapped file
+     */
+    const WalletHistoryRecord& getHistoryRecord(size_t index) const;
+
+    /**
+     * Checks the checksum of a history record
+     *
+     * History records are read straight from the mapped file, so they are
+     * only checked when the caller asks.
+     *
+     * @param index Index of the record, less than getHistoryCount()
+     * @return true if the record is intact
+     */
+    bool isHistoryRecordValid(size_t index) const;
+
+private:
+    // Prevent copying and assignment
+    WalletFile(const WalletFile&) = delete;
+    WalletFile& operator=(const WalletFile&) = delete;
+
+    void computeMac(const WalletFileHeader& header, const char* keySection,
+                    const WalletStatusRecord* statusRecords, uint8_t* mac) const;
+    void computeChecksum(uint64_t index, const WalletHistoryRecord& record, uint8_t* checksum) const;
+    bool appendHistory(const std::vector<WalletHistoryRecord>& newRecords);
+    bool patchStatuses(const std::vector<WalletStatusRecord>& statusRecords);
+    std::unique_ptr<MappedFile> mapHistory(size_t historyCount) const;
+    bool writeKeyFile(const WalletFileHeader& header, const std::string& cipher,
+                      const std::vector<WalletStatusRecord>& statusRecords);
+
+    std::string m_path;
+    std::string m_historyPath;
+    crypto::chacha_key m_encryptionKey;
+    crypto::hash m_macKey;
+    crypto::chacha_key m_seedKey;
+    std::unique_ptr<MappedFile> m_historyMapping;   // Null while the wallet has no history
+    const WalletHistoryRecord* m_history;
+    size_t m_historyCount;
+    std::vector<WalletStatusRecord> m_unpatchedStatuses;    // Status updates in the wallet file not yet patched
+};
+
+} // namespace lumina
+
+#endif // LUMINA_WALLET_FILE_H
@@ -0,0 +1,166 @@
+/**
+ * LuminaChain Wallet - Wallet Journal
+ *
+ * This file defines the WalletJournal class which durably records wallet
+ * operations between full wallet saves.
+ *
+ * Copyright (c) 2023 LuminaChain Development Team
+ * Licensed under MIT License
+ */
+
+#ifndef LUMINA_WALLET_JOURNAL_H
+#define LUMINA_WALLET_JOURNAL_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace lumina {
+
+/**
+ * Fixed-size journal record describing one outgoing transfer
+ *
+ * Text fields are zero-padded and not necessarily zero-terminated.
+ */
+struct JournalRecord {
+    uint64_t sequence;       // Position in the journal, starting at 1
+    char txId[48];           // Transaction ID
+    char toAddress[112];     // Recipient address
+    char assetSymbol[16];    // Token symbol
+    uint64_t amount;         // Amount in atomic units
+    int64_t timestamp;       // Creation time
+    uint32_t status;         // TransactionStatus
+    uint32_t signatureSize;  // Size of the signature, 0 for an unsigned transaction
+    uint8_t signerKey[32];   // Signer's public key
+    uint8_t signature[64];   // Signature, R || s
+    uint64_t checksum;       // Detects torn writes at the end of the journal
+};
+
+static_assert(sizeof(JournalRecord) == 312, "Journal record must be packed");
+
+/**
+ * Write-ahead journal of wallet operations
+ *
+ * Records are appended by any thread and written by a single flusher
+ * thread. Records queued while a flush is in progress are written and
+ * synced together, so concurrent writers share one fsync (group commit).
+ *
+ * Records up to a sequence number are dropped once a wallet snapshot
+ * containing them has been saved.
+ *
+ * A failed write drops the records queued with it, so their commits fail.
+ * The next append or truncation rewrites the journal without them and
+ * writing resumes; their sequence numbers are not reused.
+ */
+class WalletJournal {
+public:
+    /**
+     * Constructor
+     */
+    WalletJournal();
+
+    /**
+     * Destructor - flushes pending records and closes the journal
+     */
+    ~WalletJournal();
+
+    /**
+     * Opens a journal file, creating it if needed
+     *
+     * A torn record at the end of the file, left by a crash during a write,
+     * is discarded.
+     *
+     * @param path Path to the journal file
+     * @param afterSequence Sequence number of the last record already in the wallet snapshot
+     * @param replay Output parameter for the records newer than afterSequence
+     * @return true if the journal was opened successfully
+     */
+    bool open(const std::string& path, uint64_t afterSequence, std::vector<JournalRecord>& replay);
+
+    /**
+     * Flushes pending records and closes the journal
+     */
+    void close();
+
+    /**
+     * Queues a record for writing
+     *
+     * After a failed write the journal is recovered first.
+     *
+     * @param record The record; its sequence number and checksum are filled in
+     * @return The sequence number assigned to the record, or 0 if the journal is not writable
+     */
+    uint64_t append(JournalRecord record);
+
+    /**
+     * Queues records for writing, all or none of them
+     *
+     * After a failed write the journal is recovered first.
+     *
+     * @param records The records; their sequence numbers and checksums are filled in
+     * @return The sequence number of the last record, or 0 if the journal is not writable
+     */
+    uint64_t appendBatch(std::vector<JournalRecord>& records);
+
+    /**
+     * Waits until a record is durably written
+     *
+     * @param sequence The sequence number returned by append
+     * @return true if the record is on disk
+     */
+    bool waitForCommit(uint64_t sequence);
+
+    /**
+     * Drops the records up to a sequence number
+     *
+     * This also drops the records of a failed write and resumes writing.
+     *
+     * @param sequence Sequence number of the last record contained in a saved snapshot
+     * @return true if the journal was rewritten successfully
+     */
+    bool truncateThrough(uint64_t sequence);
+
+    /**
+     * Gets the sequence number of the last appended record
+     *
+     * @return The sequence number, or 0 if no record was ever appended
+     */
+    uint64_t getLastSequence() const;
+
+private:
+    // Prevent copying and assignment
+    WalletJournal(const WalletJournal&) = delete;
+    WalletJournal& operator=(const WalletJournal&) = delete;
+
+    void flushLoop();
+    void stopFlusher();
+    bool recover(std::unique_lock<std::mutex>& lock);
+    bool rewrite(uint64_t sequence);
+
+    std::string m_path;
+    FILE* m_file;
+
+    // Queue shared with the flusher thread
+    mutable std::mutex m_mutex;
+    std::condition_variable m_pendingAvailable;
+    std::condition_variable m_committed;
+    std::vector<JournalRecord> m_pending;
+    uint64_t m_lastSequence;
+    uint64_t m_committedSequence;
+    std::vector<std::pair<uint64_t, uint64_t>> m_discarded;  // Sequence ranges dropped by failed writes
+    bool m_failed;
+    bool m_stopping;
+
+    // Held while the journal file is written or rewritten
+    std::mutex m_fileMutex;
+    std::thread m_flusher;
+};
+
+} // namespace lumina
+
+#endif // LUMINA_WALLET_JOURNAL_H
@@ -0,0 +1,125 @@
+/**
+ * LuminaChain Wallet - Output Scanner
+ *
+ * This file defines the OutputScanner class which finds the wallet's
+ * outputs in downloaded blocks using the private view key.
+ *
+ * Copyright (c) 2023 LuminaChain Development Team
+ * Licensed under MIT License
+ */
+
+#ifndef LUMINA_OUTPUT_SCANNER_H
+#define LUMINA_OUTPUT_SCANNER_H
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <cstdint>
+#include "crypto/crypto.h"
+
+namespace lumina {
+
+/**
+ * A transaction as decoded from getblocks.bin, reduced to what scanning needs
+ */
+struct ScanTransaction {
+    std::string txHash;                             // Transaction hash (hex)
+    crypto::public_key txPublicKey;                 // Transaction public key (R)
+    std::vector<crypto::public_key> outputKeys;     // One-time output keys
+    std::vector<crypto::view_tag> viewTags;         // View tags, empty for pre-view-tag outputs
+    std::vector<uint64_t> amounts;                  // Output amounts in atomic units
+    std::vector<uint64_t> outputIndices;            // Global output indices (output_indices)
+    std::string assetType;                          // Asset type of the outputs
+    std::vector<uint64_t> assetTypeOutputIndices;   // Per-asset output indices (asset_type_output_indices)
+};
+
+/**
+ * A block as decoded from getblocks.bin
+ */
+struct ScanBlock {
+    uint64_t height;                                // Block height
+    std::vector<ScanTransaction> transactions;      // Transactions in the block
+};
+
+/**
+ * An output that belongs to the wallet
+ */
+struct ScannedOutput {
+    uint64_t height;                // Height of the block containing the output
+    std::string txHash;             // Hash of the transaction containing the output
+    uint32_t outputIndex;           // Index of the output in its transaction
+    uint64_t globalIndex;           // Global output index
+    uint64_t assetTypeIndex;        // Output index within its asset type
+    crypto::public_key outputKey;   // One-time output key
+    uint64_t amount;                // Amount in atomic units
+    std::string assetType;          // Asset type
+};
+
+/**
+ * Callback type for outputs found by the scanner
+ */
+typedef std::function<void(const ScannedOutput& output)> ScanMatchCallback;
+
+/**
+ * Scans batches of blocks for outputs addressed to the wallet
+ *
+ * Each batch is laid out as contiguous structure-of-arrays buffers (one
+ * entry per transaction for the key derivations, one per output for the
+ * view tag and key checks) which are processed in parallel on the shared
+ * thread pool.
+ */
+class OutputScanner {
+public:
+    /**
+     * Constructor
+     *
+     * @param viewSecretKey The wallet's private view key
+     * @param spendPublicKey The wallet's public spend key
+     */
+    OutputScanner(const crypto::secret_key& viewSecretKey, const crypto::public_key& spendPublicKey);
+
+    /**
+     * Sets the callback invoked for each output that belongs to the wallet
+     *
+     * @param callback The callback, called on the scanning thread in chain order
+     */
+    void setMatchCallback(ScanMatchCallback callback);
+
+    /**
+     * Scans a batch of blocks
+     *
+     * @param blocks The blocks to scan, in chain order
+     * @return The number of outputs found
+     */
+    size_t scanBlocks(const std::vector<ScanBlock>& blocks);
+
+private:
+    crypto::secret_key m_viewSecretKey;     // Private view key
+    crypto::public_key m_spendPublicKey;    // Public spend key
+    ScanMatchCallback m_callback;           // Callback for found outputs
+
+    // Per-transaction buffers, reused between batches
+    std::vector<crypto::public_key> m_txPublicKeys;
+    std::vector<crypto::key_derivation> m_derivations;
+    std::vector<uint8_t> m_derivationValid;
+    std::vector<const ScanTransaction*> m_txSources;
+    std::vector<uint64_t> m_txHeights;
+
+    // Per-output buffers, reused between batches
+    std::vector<crypto::public_key> m_outputKeys;
+    std::vector<crypto::view_tag> m_viewTags;
+    std::vector<uint8_t> m_hasViewTag;
+    std::vector<uint32_t> m_outputTx;
+    std::vector<uint32_t> m_outputLocalIndex;
+    std::vector<uint8_t> m_matched;
+
+    // Internal methods
+    void buildBatch(const std::vector<ScanBlock>& blocks);
+    void deriveKeys();
+    void checkOutputs();
+    size_t reportMatches();
+};
+
+} // namespace lumina
+
+#endif // LUMINA_OUTPUT_SCANNER_H
@@ -13,7 +13,20 @@
 
 #include <string>
 #include <vector>
+#include <deque>
 #include <functional>
+#include <memory>
+#include <cstdint>
+
+// Forward declarations
+namespace blocks {
+    class CheckpointIndex;
+}
+
+namespace lumina {
+    class OutputScanner;
+    struct ScanBlock;
+}
 
 namespace lumina {
 
@@ -26,11 +39,32 @@ enum class SyncStatus {
     SYNCED          // Wallet is fully synchronized with the network
 };
 
+/**
+ * Identifies a block on the chain by its height and hash
+ */
+struct BlockId {
+    uint64_t height;        // Block height
+    std::string hash;       // Block hash (hex)
+};
+
+/**
+ * Persistent synchronization checkpoint stored in the wallet file
+ */
+struct SyncCheckpoint {
+    uint64_t height = 0;                // Number of blocks already scanned
+    std::vector<BlockId> recentBlocks;  // Most recently scanned blocks, oldest first
+};
+
 /**
  * Callback type for synchronization progress updates
  */
 typedef std::function<void(float progress, const std::string& message)> SyncProgressCallback;
 
+/**
+ * Callback type for chain reorganization notifications
+ */
+typedef std::function<void(uint64_t forkHeight)> SyncReorgCallback;
+
 /**
  * Responsible for synchronizing the wallet with the LuminaChain network
  */
@@ -52,7 +86,8 @@ public:
      * Starts the synchronization process
      * 
      * @param callback Callback function for progress updates
-     * @return true if synchronization started successfully
+     * @return false if synchronization could not start or a batch of blocks
+     *         failed verification; the checkpoint then stops before that batch
      */
     bool startSync(SyncProgressCallback callback = nullptr);
     
@@ -104,6 +139,43 @@ public:
      * @return The current network endpoint URL
      */
     std::string getNetworkEndpoint() const;
+    
+    /**
+     * Sets the checkpoint to resume synchronization from
+     * 
+     * @param checkpoint The checkpoint previously saved by the wallet
+     */
+    void setSyncCheckpoint(const SyncCheckpoint& checkpoint);
+    
+    /**
+     * Gets the current synchronization checkpoint
+     * 
+     * @return The checkpoint to persist in the wallet file
+     */
+    SyncCheckpoint getSyncCheckpoint() const;
+    
+    /**
+     * Sets the callback invoked when a chain reorganization is detected
+     * 
+     * @param callback Callback receiving the first height that was rolled back
+     */
+    void setReorgCallback(SyncReorgCallback callback);
+    
+    /**
+     * Sets the scanner used to find the wallet's outputs in processed blocks
+     * 
+     * @param scanner The output scanner, or nullptr to skip output scanning
+     */
+    void setOutputScanner(std::shared_ptr<OutputScanner> scanner);
+    
+    /**
+     * Sets the checkpoints that blocks below their trusted height are checked against
+     * 
+     * The index must outlive the synchronizer.
+     * 
+     * @param checkpoints The checkpoint index, or nullptr to validate every block in full
+     */
+    void setCheckpoints(const blocks::CheckpointIndex* checkpoints);
 
 private:
     std::string m_walletAddress;       // Wallet address to synchronize
@@ -114,12 +186,25 @@ private:
     uint64_t m_currentBlockHeight;     // Current block height of the wallet
     bool m_isSyncing;                  // Flag indicating if synchronization is in progress
     SyncProgressCallback m_callback;    // Callback for progress updates
+    SyncReorgCallback m_reorgCallback;  // Callback for chain reorganizations
+    std::deque<BlockId> m_recentBlocks; // Recently scanned blocks for reorg detection
+    
+    const blocks::CheckpointIndex* m_checkpoints; // Embedded checkpoints for the configured network
+    std::shared_ptr<OutputScanner> m_scanner;     // Scanner for the wallet's outputs
     
     // Internal methods
     bool connectToNetwork();
+    bool loadCheckpoints();
     bool fetchLatestBlockHeight();
+    bool fetchBlockHash(uint64_t height, std::string& hash);
+    bool fetchBlockHashes(uint64_t fromHeight, uint64_t toHeight, std::vector<std::string>& hashes);
+    bool fetchBlocks(uint64_t fromHeight, uint64_t toHeight, std::vector<ScanBlock>& blocks);
+    bool verifyCheckpoint(uint64_t fromHeight, const std::vector<std::string>& hashes) const;
+    bool validateBlock(uint64_t height, const std::string& hash);
     bool processBlocks(uint64_t fromHeight, uint64_t toHeight);
+    uint64_t detectReorg();
     void updateProgress(float progress, const std::string& message);
+    bool simulateSync();
 };
 
 } // namespace lumina
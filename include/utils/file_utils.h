@@ -0,0 +1,46 @@
+/**
+ * LuminaChain Wallet - File Utilities
+ *
+ * This file declares helpers for writing files durably.
+ *
+ * Copyright (c) 2023 LuminaChain Development Team
+ * Licensed under MIT License
+ */
+
+#ifndef LUMINA_FILE_UTILS_H
+#define LUMINA_FILE_UTILS_H
+
+#include <cstddef>
+#include <cstdio>
+#include <string>
+
+namespace lumina {
+
+/**
+ * Writes a whole buffer to a file
+ *
+ * @param file The file to write to
+ * @param data The data to write
+ * @param size Number of bytes to write
+ * @return false on a short write
+ */
+bool writeAll(FILE* file, const void* data, size_t size);
+
+/**
+ * Flushes a file's buffers and contents to disk
+ *
+ * @param file The file to flush
+ * @return true if the data reached the disk
+ */
+bool syncFile(FILE* file);
+
+/**
+ * Flushes the directory containing a file so a create or rename survives a crash
+ *
+ * @param path Path of the file whose directory is flushed
+ */
+void syncDirectory(const std::string& path);
+
+} // namespace lumina
+
+#endif // LUMINA_FILE_UTILS_H
@@ -0,0 +1,72 @@
+/**
+ * LuminaChain Wallet - Fixed-Capacity String
+ *
+ * This file defines the FixedString class template which stores a short
+ * string inline, without heap allocation.
+ *
+ * Copyright (c) 2023 LuminaChain Development Team
+ * Licensed under MIT License
+ */
+
+#ifndef LUMINA_FIXED_STRING_H
+#define LUMINA_FIXED_STRING_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+namespace lumina {
+
+/**
+ * A string of at most N characters stored inline
+ *
+ * The type is trivially copyable, so arrays of structures holding it are
+ * contiguous and can be copied with memcpy. Assigning a longer string
+ * truncates it.
+ */
+template <size_t N>
+class FixedString {
+    static_assert(N > 0 && N <= UINT8_MAX, "FixedString capacity must fit in one byte");
+
+public:
+    static constexpr size_t CAPACITY = N;
+
+    constexpr FixedString() : m_data(), m_size(0) {}
+
+    FixedString(std::string_view text) : m_data(), m_size(0) {
+        assign(text);
+    }
+
+    /**
+     * Replaces the contents
+     *
+     * @param text The new contents
+     * @return false if the text was truncated to fit
+     */
+    bool assign(std::string_view text) {
+        size_t size = text.size() < N ? text.size() : N;
+        std::memcpy(m_data, text.data(), size);
+        std::memset(m_data + size, 0, N - size);
+        m_size = static_cast<uint8_t>(size);
+        return size == text.size();
+    }
+
+    std::string_view view() const { return std::string_view(m_data, m_size); }
+    std::string str() const { return std::string(m_data, m_size); }
+    const char* data() const { return m_data; }
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+
+    bool operator==(const FixedString& other) const { return view() == other.view(); }
+    bool operator!=(const FixedString& other) const { return view() != other.view(); }
+
+private:
+    char m_data[N];   // Zero-padded contents
+    uint8_t m_size;   // Number of characters used
+};
+
+} // namespace lumina
+
+#endif // LUMINA_FIXED_STRING_H
@@ -12,9 +12,19 @@
 #define LUMINA_LOGGER_H
 
 #include <string>
+#include <string_view>
 #include <fstream>
 #include <iostream>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
 #include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include "utils/ring_buffer.h"
 
 namespace lumina {
 
@@ -29,8 +39,45 @@ enum class LogLevel {
     CRITICAL  // Critical errors
 };
 
+/**
+ * Number of messages the log queue holds (a power of two)
+ */
+const size_t LOG_QUEUE_CAPACITY = 8192;
+
+/**
+ * Maximum number of messages written between flushes
+ */
+const size_t LOG_BATCH_SIZE = 512;
+
+/**
+ * Longest time a logged message waits before it is written
+ */
+const std::chrono::milliseconds LOG_FLUSH_INTERVAL(100);
+
 /**
  * Provides logging functionality for the application
+ *
+ * Messages are pushed onto a lock-free queue as records of their level,
+ * time and content. A writer thread drains the queue, formatting and
+ * writing messages in batches with one flush per batch, and wakes at
+ * least every LOG_FLUSH_INTERVAL. A logging thread waits only when the
+ * queue is full. Critical messages, flush() and the logger's destruction
+ * wait until everything logged before them has been written.
+ *
+ * Console lines therefore appear up to LOG_FLUSH_INTERVAL after they are
+ * logged. Code that writes to standard output itself, like the command
+ * loop, must call flush() first to keep log lines ahead of its output.
+ * Only critical messages are flushed before log() returns: if the process
+ * crashes, the last error and lower-level lines may never be written.
+ *
+ * The LUMINA_LOG_* macros check the level before evaluating their
+ * arguments, and record the arguments in a compact binary form that is
+ * only turned into text on the writer thread:
+ *
+ *     LUMINA_LOG_DEBUG("Created transaction ", id, " with ", count, " outputs");
+ *
+ * Arguments may be strings, characters, booleans, numbers, or objects
+ * with a toString() method.
  */
 class Logger {
 public:
@@ -58,6 +105,28 @@ public:
      */
     void log(LogLevel level, const std::string& message);
     
+    /**
+     * Logs the concatenation of arguments, formatting them on the writer thread
+     * 
+     * Prefer the LUMINA_LOG_* macros, which skip evaluating the arguments
+     * of disabled levels.
+     * 
+     * @param level The log level
+     * @param args The message parts
+     */
+    template<typename... Args>
+    void write(LogLevel level, const Args&... args) {
+        if (!isEnabled(level)) {
+            return;
+        }
+        LogRecord record;
+        record.level = level;
+        record.encoded = true;
+        stampRecord(record);
+        (encodeArgument(record.payload, args), ...);
+        enqueue(std::move(record));
+    }
+    
     /**
      * Logs a debug message
      * 
@@ -93,6 +162,11 @@ public:
      */
     void critical(const std::string& message);
     
+    /**
+     * Waits until every message logged so far has been written and flushed
+     */
+    void flush();
+    
     /**
      * Sets the minimum log level to output
      * 
@@ -107,17 +181,67 @@ public:
      */
     LogLevel getLogLevel() const;
     
+    /**
+     * Checks whether messages of a level are logged
+     * 
+     * @param level The log level
+     * @return true if the level is at least the minimum log level
+     */
+    bool isEnabled(LogLevel level) const {
+        return level >= m_logLevel.load(std::memory_order_relaxed);
+    }
+    
     /**
      * Enables or disables console output
      * 
      * @param enabled Whether console output should be enabled
      */
     void setConsoleOutput(bool enabled);
+    
+    /**
+     * Enables or disables monotonic timestamps
+     * 
+     * When enabled, each message carries the seconds since the logger
+     * started, from a clock that wall-clock adjustments do not move, after
+     * its wall-clock timestamp.
+     * 
+     * @param enabled Whether monotonic timestamps should be added
+     */
+    void setMonotonicTimestamps(bool enabled);
+    
+    /**
+     * Gets a timestamp string for the current local time
+     * 
+     * @return The time as "YYYY-MM-DD HH:MM:SS.mmm"
+     */
+    std::string getTimestamp() const;
 
 private:
+    // A logged message waiting to be written
+    struct LogRecord {
+        LogLevel level = LogLevel::INFO;
+        bool encoded = false;                           // Payload holds encoded arguments, not the message
+        std::chrono::system_clock::time_point time;
+        std::chrono::steady_clock::time_point monotonicTime;   // Set only with monotonic timestamps
+        std::string payload;
+    };
+    
+    // Type tags of encoded arguments
+    enum class ArgumentType : uint8_t {
+        STRING,     // uint32_t length, then the characters
+        INT,        // int64_t
+        UINT,       // uint64_t
+        DOUBLE,     // double
+        CHAR,       // char
+        BOOL        // uint8_t
+    };
+    
     // Private constructor for singleton pattern
     Logger();
     
+    // Destructor - writes the queued messages and stops the writer thread
+    ~Logger();
+    
     // Prevent copying and assignment
     Logger(const Logger&) = delete;
     Logger& operator=(const Logger&) = delete;
@@ -126,14 +250,84 @@ private:
     std::string m_logFilePath;
     std::ofstream m_logFile;
     bool m_consoleOutput;
-    LogLevel m_logLevel;
-    std::mutex m_mutex;
+    std::atomic<LogLevel> m_logLevel;
+    std::mutex m_mutex;                         // Guards the outputs and the writer state
+    
+    // Asynchronous writing
+    MpscRingBuffer<LogRecord> m_queue;          // Messages waiting to be written
+    std::thread m_writer;
+    std::condition_variable m_writeRequested;   // Wakes the writer early
+    std::condition_variable m_written;          // Signals progress to flush()
+    size_t m_writtenCount;                      // Messages written so far
+    bool m_stopping;
+    std::atomic<bool> m_writerRunning;
+    
+    // Timestamps
+    std::atomic<bool> m_monotonicTimestamps;
+    std::chrono::steady_clock::time_point m_startTime;
     
     // Internal methods
-    std::string getTimestamp() const;
+    void stampRecord(LogRecord& record) const;
+    void appendTimestamp(const LogRecord& record, std::string& text) const;
+    static void appendLocalTime(std::chrono::system_clock::time_point time, std::string& text);
     std::string logLevelToString(LogLevel level) const;
+    void enqueue(LogRecord&& record);
+    void formatRecord(const LogRecord& record, std::string& text) const;
+    void writerLoop();
+    void writeText(const std::string& text);
+    static void decodeArguments(const std::string& payload, std::string& text);
+    
+    template<typename T>
+    static void encodeValue(std::string& payload, ArgumentType type, T value) {
+        payload += static_cast<char>(type);
+        char bytes[sizeof(T)];
+        std::memcpy(bytes, &value, sizeof(T));
+        payload.append(bytes, sizeof(T));
+    }
+    
+    static void encodeString(std::string& payload, std::string_view text) {
+        encodeValue(payload, ArgumentType::STRING, static_cast<uint32_t>(text.size()));
+        payload.append(text.data(), text.size());
+    }
+    
+    template<typename T>
+    static void encodeArgument(std::string& payload, const T& value) {
+        if constexpr (std::is_same_v<T, bool>) {
+            encodeValue(payload, ArgumentType::BOOL, static_cast<uint8_t>(value));
+        } else if constexpr (std::is_same_v<T, char>) {
+            encodeValue(payload, ArgumentType::CHAR, value);
+        } else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+            encodeValue(payload, ArgumentType::INT, static_cast<int64_t>(value));
+        } else if constexpr (std::is_integral_v<T>) {
+            encodeValue(payload, ArgumentType::UINT, static_cast<uint64_t>(value));
+        } else if constexpr (std::is_floating_point_v<T>) {
+            encodeValue(payload, ArgumentType::DOUBLE, static_cast<double>(value));
+        } else if constexpr (std::is_convertible_v<const T&, std::string_view>) {
+            encodeString(payload, value);
+        } else {
+            encodeString(payload, value.toString());
+        }
+    }
 };
 
 } // namespace lumina
 
+/**
+ * Logs the concatenation of the arguments if the level is enabled,
+ * without evaluating them otherwise
+ */
+#define LUMINA_LOG(level, ...)                                            \
+    do {                                                                  \
+        ::lumina::Logger& luminaLogger = ::lumina::Logger::getInstance(); \
+        if (luminaLogger.isEnabled(level)) {                              \
+            luminaLogger.write(level, __VA_ARGS__);                       \
+        }                                                                 \
+    } while (0)
+
+#define LUMINA_LOG_DEBUG(...) LUMINA_LOG(::lumina::LogLevel::DEBUG, __VA_ARGS__)
+#define LUMINA_LOG_INFO(...) LUMINA_LOG(::lumina::LogLevel::INFO, __VA_ARGS__)
+#define LUMINA_LOG_WARNING(...) LUMINA_LOG(::lumina::LogLevel::WARNING, __VA_ARGS__)
+#define LUMINA_LOG_ERROR(...) LUMINA_LOG(::lumina::LogLevel::ERROR, __VA_ARGS__)
+#define LUMINA_LOG_CRITICAL(...) LUMINA_LOG(::lumina::LogLevel::CRITICAL, __VA_ARGS__)
+
 #endif // LUMINA_LOGGER_H
\ No newline at end of file
@@ -0,0 +1,87 @@
+/**
+ * LuminaChain Wallet - Mapped File Utility
+ *
+ * This file defines the MappedFile class which maps a file read-only
+ * into memory.
+ *
+ * Copyright (c) 2023 LuminaChain Development Team
+ * Licensed under MIT License
+ */
+
+#ifndef LUMINA_MAPPED_FILE_H
+#define LUMINA_MAPPED_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace lumina {
+
+/**
+ * A read-only view of a whole file
+ *
+ * The file is memory-mapped where the platform supports it and read into
+ * a buffer otherwise. The view stays valid until the file is closed, even
+ * if the file is replaced on disk in the meantime.
+ */
+class MappedFile {
+public:
+    /**
+     * Constructor
+     */
+    MappedFile();
+
+    /**
+     * Destructor - unmaps the file
+     */
+    ~MappedFile();
+
+    /**
+     * Maps a file, closing any previously mapped file
+     *
+     * @param path Path to the file
+     * @return true if the file was mapped successfully
+     */
+    bool open(const std::string& path);
+
+    /**
+     * Unmaps the file
+     */
+    void close();
+
+    /**
+     * Checks whether a file is mapped
+     *
+     * @return true if a file is mapped
+     */
+    bool isOpen() const;
+
+    /**
+     * Gets the mapped file contents
+     *
+     * @return Pointer to the first byte, or nullptr if no file is mapped
+     */
+    const uint8_t* data() const;
+
+    /**
+     * Gets the size of the mapped file
+     *
+     * @return Size in bytes
+     */
+    size_t size() const;
+
+private:
+    // Prevent copying and assignment
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const uint8_t* m_data;
+    size_t m_size;
+    bool m_isOpen;
+    std::vector<uint8_t> m_buffer;  // Used where memory mapping is unavailable
+};
+
+} // namespace lumina
+
+#endif // LUMINA_MAPPED_FILE_H
@@ -0,0 +1,145 @@
+/**
+ * LuminaChain Wallet - Ring Buffer Utility
+ *
+ * This file defines the MpscRingBuffer class, a bounded lock-free queue
+ * for many producer threads and one consumer thread.
+ *
+ * Copyright (c) 2023 LuminaChain Development Team
+ * Licensed under MIT License
+ */
+
+#ifndef LUMINA_RING_BUFFER_H
+#define LUMINA_RING_BUFFER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+namespace lumina {
+
+/**
+ * A bounded lock-free queue for many producers and one consumer
+ *
+ * Each slot carries a sequence number telling whose turn it is: a
+ * producer claims the next position with a compare-and-swap, fills the
+ * slot, then publishes it by advancing the slot's sequence, which is
+ * what the consumer waits for. Producers never wait for each other
+ * except to retry a lost claim, and a full queue is reported rather
+ * than waited on.
+ *
+ * @tparam T The element type, which must be default constructible and movable
+ */
+template<typename T>
+class MpscRingBuffer {
+public:
+    /**
+     * Constructor
+     *
+     * @param capacity Number of slots, which must be a power of two
+     */
+    explicit MpscRingBuffer(size_t capacity)
+        : m_slots(new Slot[capacity]),
+          m_mask(capacity - 1),
+          m_tail(0),
+          m_head(0) {
+        for (size_t i = 0; i < capacity; ++i) {
+            m_slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * Adds an element, from any thread
+     *
+     * @param value The element, moved from only if it was added
+     * @return false if the queue is full
+     */
+    bool tryPush(T&& value) {
+        size_t position = m_tail.load(std::memory_order_relaxed);
+        while (true) {
+            Slot& slot = m_slots[position & m_mask];
+            size_t sequence = slot.sequence.load(std::memory_order_acquire);
+            intptr_t turn = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+            if (turn == 0) {
+                if (m_tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    slot.value = std::move(value);
+                    slot.sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (turn < 0) {
+                return false;
+            } else {
+                position = m_tail.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * Removes the oldest published element, from the consumer thread only
+     *
+     * @param value Output parameter for the element
+     * @return false if no element is published at the head of the queue
+     */
+    bool tryPop(T& value) {
+        size_t position = m_head.load(std::memory_order_relaxed);
+        Slot& slot = m_slots[position & m_mask];
+        if (slot.sequence.load(std::memory_order_acquire) != position + 1) {
+            return false;
+        }
+        value = std::move(slot.value);
+        slot.sequence.store(position + m_mask + 1, std::memory_order_release);
+        m_head.store(position + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    /**
+     * Gets the number of elements ever claimed by producers
+     *
+     * @return The number of pushes, including ones not yet published
+     */
+    size_t getPushCount() const {
+        return m_tail.load(std::memory_order_acquire);
+    }
+
+    /**
+     * Gets the approximate number of queued elements
+     *
+     * @return The number of elements, exact only while no thread is using the queue
+     */
+    size_t sizeApprox() const {
+        size_t head = m_head.load(std::memory_order_relaxed);
+        size_t tail = m_tail.load(std::memory_order_relaxed);
+        return tail > head ? tail - head : 0;
+    }
+
+    /**
+     * Gets the number of slots
+     *
+     * @return The capacity
+     */
+    size_t getCapacity() const {
+        return m_mask + 1;
+    }
+
+private:
+    // Prevent copying and assignment
+    MpscRingBuffer(const MpscRingBuffer&) = delete;
+    MpscRingBuffer& operator=(const MpscRingBuffer&) = delete;
+
+    struct Slot {
+        std::atomic<size_t> sequence;   // Position + 1 when published, position when free
+        T value;
+    };
+
+    std::unique_ptr<Slot[]> m_slots;
+    const size_t m_mask;
+
+    // Producer and consumer positions on separate cache lines
+    alignas(64) std::atomic<size_t> m_tail;
+    alignas(64) std::atomic<size_t> m_head;
+};
+
+} // namespace lumina
+
+#endif // LUMINA_RING_BUFFER_H
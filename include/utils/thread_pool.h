@@ -0,0 +1,104 @@
+/**
+ * LuminaChain Wallet - Thread Pool Utility
+ *
+ * This file defines the ThreadPool class which runs data-parallel work
+ * on a fixed set of worker threads.
+ *
+ * Copyright (c) 2023 LuminaChain Development Team
+ * Licensed under MIT License
+ */
+
+#ifndef LUMINA_THREAD_POOL_H
+#define LUMINA_THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace lumina {
+
+/**
+ * Function type for a chunk of parallel work over [begin, end)
+ */
+typedef std::function<void(size_t begin, size_t end)> ParallelTask;
+
+/**
+ * Runs data-parallel loops on a fixed set of worker threads
+ */
+class ThreadPool {
+public:
+    /**
+     * Gets the shared thread pool sized to the hardware concurrency
+     *
+     * @return The thread pool instance
+     */
+    static ThreadPool& getInstance();
+
+    /**
+     * Constructor
+     *
+     * @param threadCount Number of worker threads (0 = hardware concurrency)
+     */
+    explicit ThreadPool(size_t threadCount = 0);
+
+    /**
+     * Destructor - stops and joins all worker threads
+     */
+    ~ThreadPool();
+
+    /**
+     * Runs a task over [0, count) split into chunks and waits for completion
+     *
+     * The calling thread takes part in the work. Calls made from inside a
+     * running loop execute inline to avoid deadlocking the pool. The task
+     * must not throw.
+     *
+     * @param count Number of items to process
+     * @param task Function processing the items in [begin, end)
+     * @param minChunk Minimum number of items per chunk
+     */
+    void parallelFor(size_t count, const ParallelTask& task, size_t minChunk = 1);
+
+    /**
+     * Gets the number of threads taking part in parallel loops
+     *
+     * @return Worker threads plus the calling thread
+     */
+    size_t getConcurrency() const;
+
+private:
+    // Prevent copying and assignment
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Worker threads
+    std::vector<std::thread> m_workers;
+
+    // Current job
+    const ParallelTask* m_task;
+    size_t m_count;
+    size_t m_chunk;
+    std::atomic<size_t> m_nextIndex;
+    size_t m_activeWorkers;
+    uint64_t m_generation;
+    bool m_stopping;
+
+    // Synchronization
+    std::mutex m_submitMutex;
+    std::mutex m_mutex;
+    std::condition_variable m_workAvailable;
+    std::condition_variable m_workDone;
+
+    // Internal methods
+    void workerLoop();
+    void runChunks();
+};
+
+} // namespace lumina
+
+#endif // LUMINA_THREAD_POOL_H
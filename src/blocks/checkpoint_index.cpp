@@ -0,0 +1,158 @@
+#include "checkpoint_index.h"
+#include "blocks.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "common/util.h"
+#include "string_tools.h"
+
+namespace blocks
+{
+
+  namespace
+  {
+    // sha256 of checkpoints.dat, must be updated together with the file
+    const char expected_mainnet_checkpoints_hash[] = "e9371004b9f6be59921b27bc81e28b4715845ade1c6d16891d5c455f72e21365";
+
+    struct LoadedIndex
+    {
+      CheckpointIndex index;
+      CheckpointLoadStatus status;
+    };
+
+    LoadedIndex LoadNetworkIndex(cryptonote::network_type network)
+    {
+      crypto::hash expected;
+      const crypto::hash *expected_hash = nullptr;
+      if (network == cryptonote::MAINNET && epee::string_tools::hex_to_pod(expected_mainnet_checkpoints_hash, expected))
+        expected_hash = &expected;
+
+      LoadedIndex loaded;
+      loaded.status = loaded.index.Load(GetCheckpointsData(network), expected_hash);
+      if (loaded.status != CheckpointLoadStatus::Ok)
+        loaded.index = CheckpointIndex();
+      return loaded;
+    }
+
+    template<typename T>
+    T ReadLittleEndian(const unsigned char *data)
+    {
+      T value = 0;
+      for (size_t i = 0; i < sizeof(T); ++i)
+        value |= static_cast<T>(data[i]) << (8 * i);
+      return value;
+    }
+  }
+
+  CheckpointLoadStatus CheckpointIndex::Load(epee::span<const unsigned char> data, const crypto::hash *expected_sha256)
+  {
+    m_heights.clear();
+    m_hashes.clear();
+    m_version = 0;
+    m_group_size = CHECKPOINT_GROUP_SIZE;
+
+    if (expected_sha256)
+    {
+      crypto::hash hash;
+      if (!tools::sha256sum(data.data(), data.size(), hash) || hash != *expected_sha256)
+        return CheckpointLoadStatus::BadHash;
+    }
+
+    const unsigned char *ptr = data.data();
+    size_t count = 0;
+
+    if (data.size() >= sizeof(CheckpointHeaderV2) && std::memcmp(ptr, CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC)) == 0)
+    {
+      const uint32_t version = ReadLittleEndian<uint32_t>(ptr + offsetof(CheckpointHeaderV2, version));
+      if (version != CHECKPOINT_FORMAT_VERSION)
+        return CheckpointLoadStatus::BadVersion;
+      m_group_size = ReadLittleEndian<uint32_t>(ptr + offsetof(CheckpointHeaderV2, group_size));
+      count = ReadLittleEndian<uint32_t>(ptr + offsetof(CheckpointHeaderV2, count));
+
+      const size_t entry_size = sizeof(uint64_t) + sizeof(crypto::hash);
+      if (m_group_size == 0 || data.size() != sizeof(CheckpointHeaderV2) + count * entry_size)
+        return CheckpointLoadStatus::Malformed;
+
+      m_heights.resize(count);
+      m_hashes.resize(count);
+      ptr += sizeof(CheckpointHeaderV2);
+      for (size_t i = 0; i < count; ++i, ptr += entry_size)
+      {
+        m_heights[i] = ReadLittleEndian<uint64_t>(ptr);
+        std::memcpy(&m_hashes[i], ptr + sizeof(uint64_t), sizeof(crypto::hash));
+        if (i > 0 && m_heights[i] < m_heights[i - 1] + m_group_size)
+          return CheckpointLoadStatus::Malformed;
+      }
+      m_version = version;
+    }
+    else
+    {
+      // v1 blobs carry no header; an empty blob is a valid v1 blob with no groups
+      if (data.size() >= sizeof(uint32_t))
+        count = ReadLittleEndian<uint32_t>(ptr);
+      else if (!data.empty())
+        return CheckpointLoadStatus::Malformed;
+
+      if (!data.empty() && data.size() != sizeof(uint32_t) + count * sizeof(crypto::hash) * 2)
+        return CheckpointLoadStatus::Malformed;
+
+      m_heights.resize(count);
+      m_hashes.resize(count);
+      for (size_t i = 0; i < count; ++i)
+        m_heights[i] = i * m_group_size;
+      if (count > 0)
+        std::memcpy(m_hashes.data(), ptr + sizeof(uint32_t), count * sizeof(crypto::hash));
+      m_version = 1;
+    }
+
+    return CheckpointLoadStatus::Ok;
+  }
+
+  uint64_t CheckpointIndex::TrustedHeight() const
+  {
+    return m_heights.empty() ? 0 : m_heights.back() + m_group_size;
+  }
+
+  size_t CheckpointIndex::LowerBound(uint64_t height) const
+  {
+    return std::lower_bound(m_heights.begin(), m_heights.end(), height) - m_heights.begin();
+  }
+
+  CheckpointIndex::const_iterator CheckpointIndex::Find(uint64_t height) const
+  {
+    const size_t pos = std::upper_bound(m_heights.begin(), m_heights.end(), height) - m_heights.begin();
+    if (pos == 0 || height >= m_heights[pos - 1] + m_group_size)
+      return end();
+    return const_iterator(*this, pos - 1);
+  }
+
+  CheckpointIndex::Range CheckpointIndex::Between(uint64_t from_height, uint64_t to_height) const
+  {
+    const size_t first = LowerBound(from_height);
+    const size_t last = std::max(first, LowerBound(to_height));
+    return {const_iterator(*this, first), const_iterator(*this, last)};
+  }
+
+  const CheckpointIndex &GetCheckpointIndex(cryptonote::network_type network, CheckpointLoadStatus *status)
+  {
+    static const LoadedIndex mainnet = LoadNetworkIndex(cryptonote::MAINNET);
+    static const LoadedIndex testnet = LoadNetworkIndex(cryptonote::TESTNET);
+    static const LoadedIndex stagenet = LoadNetworkIndex(cryptonote::STAGENET);
+    static const LoadedIndex none = {CheckpointIndex(), CheckpointLoadStatus::Ok};
+
+    const LoadedIndex *loaded = &none;
+    switch (network)
+    {
+      case cryptonote::MAINNET: loaded = &mainnet; break;
+      case cryptonote::TESTNET: loaded = &testnet; break;
+      case cryptonote::STAGENET: loaded = &stagenet; break;
+      default: break;
+    }
+
+    if (status)
+      *status = loaded->status;
+    return loaded->index;
+  }
+
+}
@@ -0,0 +1,108 @@
+#ifndef SRC_BLOCKS_CHECKPOINT_INDEX_H_
+#define SRC_BLOCKS_CHECKPOINT_INDEX_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "cryptonote_config.h"
+#include "crypto/hash.h"
+#include "span.h"
+
+namespace blocks
+{
+  // Format of the embedded checkpoint blobs:
+  //  v1: uint32 group count, then one hash of block hashes per group of
+  //      CHECKPOINT_GROUP_SIZE blocks, then one hash of block weights per group
+  //  v2: CheckpointHeaderV2, then (uint64 start height, hash) per group
+  constexpr uint32_t CHECKPOINT_FORMAT_VERSION = 2;
+  constexpr uint64_t CHECKPOINT_GROUP_SIZE = 512;
+  constexpr char CHECKPOINT_MAGIC[4] = {'L', 'C', 'P', 'I'};
+
+#pragma pack(push, 1)
+  struct CheckpointHeaderV2
+  {
+    char magic[4];
+    uint32_t version;
+    uint32_t group_size;
+    uint32_t count;
+  };
+#pragma pack(pop)
+
+  enum class CheckpointLoadStatus
+  {
+    Ok,
+    Malformed,
+    BadVersion,
+    BadHash
+  };
+
+  struct CheckpointEntry
+  {
+    uint64_t height;          // first block covered by this checkpoint
+    const crypto::hash &hash; // hash of the block hashes in [height, height + group size)
+  };
+
+  // Parse-once index of the embedded checkpoints. Heights and hashes are kept
+  // in separate contiguous arrays so that lookups by height only walk the
+  // (densely packed) height array.
+  class CheckpointIndex
+  {
+  public:
+    class const_iterator
+    {
+    public:
+      const_iterator(const CheckpointIndex &index, size_t pos): m_index(&index), m_pos(pos) {}
+      CheckpointEntry operator*() const { return {m_index->m_heights[m_pos], m_index->m_hashes[m_pos]}; }
+      const_iterator &operator++() { ++m_pos; return *this; }
+      bool operator==(const const_iterator &other) const { return m_pos == other.m_pos; }
+      bool operator!=(const const_iterator &other) const { return m_pos != other.m_pos; }
+    private:
+      const CheckpointIndex *m_index;
+      size_t m_pos;
+    };
+
+    struct Range
+    {
+      const_iterator first;
+      const_iterator last;
+      const_iterator begin() const { return first; }
+      const_iterator end() const { return last; }
+    };
+
+    CheckpointIndex() = default;
+
+    // Parses a checkpoint blob; when expected_sha256 is set, the blob must hash to it
+    CheckpointLoadStatus Load(epee::span<const unsigned char> data, const crypto::hash *expected_sha256);
+
+    bool Empty() const { return m_heights.empty(); }
+    size_t Size() const { return m_heights.size(); }
+    uint32_t Version() const { return m_version; }
+    uint64_t GroupSize() const { return m_group_size; }
+
+    // First height after the last checkpointed group
+    uint64_t TrustedHeight() const;
+
+    // Checkpoint whose group covers the given height, end() if there is none
+    const_iterator Find(uint64_t height) const;
+
+    // Checkpoints whose groups start in [from_height, to_height)
+    Range Between(uint64_t from_height, uint64_t to_height) const;
+
+    const_iterator begin() const { return const_iterator(*this, 0); }
+    const_iterator end() const { return const_iterator(*this, m_heights.size()); }
+
+  private:
+    size_t LowerBound(uint64_t height) const;
+
+    std::vector<uint64_t> m_heights;
+    std::vector<crypto::hash> m_hashes;
+    uint32_t m_version = 0;
+    uint64_t m_group_size = CHECKPOINT_GROUP_SIZE;
+  };
+
+  // Index of the compiled-in checkpoints for a network, parsed on first use
+  const CheckpointIndex &GetCheckpointIndex(cryptonote::network_type network, CheckpointLoadStatus *status = nullptr);
+}
+
+#endif /* SRC_BLOCKS_CHECKPOINT_INDEX_H_ */
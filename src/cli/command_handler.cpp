@@ -15,6 +15,7 @@
 #include "utils/logger.h"
 #include "utils/config.h"
 #include <iostream>
+#include <fstream>
 #include <sstream>
 #include <iomanip>
 
@@ -50,7 +51,7 @@ void CommandHandler::registerCommand(const std::string& command,
     m_commandFunctions[command] = function;
     m_commandDescriptions[command] = description;
     
-    Logger::getInstance().debug("Registered command: " + command);
+    LUMINA_LOG_DEBUG("Registered command: ", command);
 }
 
 /**
@@ -65,7 +66,7 @@ CommandResult CommandHandler::executeCommand(const std::string& command,
     
     // Execute the command
     try {
-        Logger::getInstance().debug("Executing command: " + command);
+        LUMINA_LOG_DEBUG("Executing command: ", command);
         return m_commandFunctions[command](args);
     } catch (const std::exception& e) {
         Logger::getInstance().error("Exception in command execution: " + std::string(e.what()));
@@ -131,6 +132,14 @@ void CommandHandler::initializeDefaultCommands() {
                    std::bind(&CommandHandler::handleTransfer, this, std::placeholders::_1),
                    "Transfer funds to another address: transfer <address> <amount> [payment_id]");
     
+    registerCommand("transfer_batch", 
+                   std::bind(&CommandHandler::handleTransferBatch, this, std::placeholders::_1),
+                   "Transfer funds to many addresses from a CSV file of address,amount[,token] lines: transfer_batch <csv-file>");
+    
+    registerCommand("history", 
+                   std::bind(&CommandHandler::handleHistory, this, std::placeholders::_1),
+                   "Display transaction history: history [--status <status>] [--address <address>] [--limit <n>] [--after <cursor>] [--oldest-first]");
+    
     registerCommand("seed", 
                    std::bind(&CommandHandler::handleSeed, this, std::placeholders::_1),
                    "Display wallet seed phrase (WARNING: sensitive information)");
@@ -216,6 +225,8 @@ CommandResult CommandHandler::handleHelp(const std::vector<std::string>& args) {
             {"wallet_info", getCommandDescription("wallet_info")},
             {"balance", getCommandDescription("balance")},
             {"transfer", getCommandDescription("transfer")},
+            {"transfer_batch", getCommandDescription("transfer_batch")},
+            {"history", getCommandDescription("history")},
             {"seed", getCommandDescription("seed")}
         };
         
@@ -259,7 +270,7 @@ CommandResult CommandHandler::handleWalletInfo(const std::vector<std::string>& a
     std::stringstream ss;
     ss << "Wallet Information:\n";
     ss << "  Address: " << m_wallet->getAddress() << "\n";
-    ss << "  Balance: " << m_wallet->getBalance() << " LUMI\n";
+    ss << "  Balance: " << m_wallet->getBalance().toString() << " LUMI\n";
     ss << "  Transactions: " << m_wallet->getTransactionCount() << "\n";
     ss << "  Created: " << m_wallet->getCreationTime() << "\n";
     
@@ -274,10 +285,10 @@ CommandResult CommandHandler::handleBalance(const std::vector<std::string>& args
         return {false, "Wallet is not initialized"};
     }
     
-    double balance = m_wallet->getBalance();
+    Amount balance = m_wallet->getBalance();
     
     std::stringstream ss;
-    ss << "Balance: " << std::fixed << std::setprecision(8) << balance << " LUMI\n";
+    ss << "Balance: " << balance.toString() << " LUMI\n";
     
     return {true, ss.str()};
 }
@@ -296,17 +307,15 @@ CommandResult CommandHandler::handleTransfer(const std::vector<std::string>& arg
     }
     
     std::string address = args[0];
-    double amount;
+    Amount amount;
     
     // Parse amount
-    try {
-        amount = std::stod(args[1]);
-    } catch (const std::exception&) {
+    if (!Amount::parse(args[1], amount)) {
         return {false, "Invalid amount: " + args[1]};
     }
     
     // Check amount
-    if (amount <= 0) {
+    if (amount.isZero()) {
         return {false, "Amount must be positive"};
     }
     
@@ -321,7 +330,7 @@ CommandResult CommandHandler::handleTransfer(const std::vector<std::string>& arg
     
     if (success) {
         std::stringstream ss;
-        ss << "Transferred " << std::fixed << std::setprecision(8) << amount << " LUMI to " << address;
+        ss << "Transferred " << amount.toString() << " LUMI to " << address;
         if (!paymentId.empty()) {
             ss << " with payment ID " << paymentId;
         }
@@ -331,6 +340,163 @@ CommandResult CommandHandler::handleTransfer(const std::vector<std::string>& arg
     }
 }
 
+/**
+ * Handles the transfer_batch command
+ */
+CommandResult CommandHandler::handleTransferBatch(const std::vector<std::string>& args) {
+    if (!m_wallet) {
+        return {false, "Wallet is not initialized"};
+    }
+    
+    // Check arguments
+    if (args.size() != 1) {
+        return {false, "Usage: transfer_batch <csv-file>"};
+    }
+    
+    std::ifstream file(args[0]);
+    if (!file) {
+        return {false, "Failed to open " + args[0]};
+    }
+    
+    // Each line is address,amount[,token]; blank lines and # comments are skipped
+    std::vector<TransferDestination> destinations;
+    std::string line;
+    size_t lineNumber = 0;
+    while (std::getline(file, line)) {
+        ++lineNumber;
+        
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        
+        std::vector<std::string> fields;
+        std::stringstream lineStream(line);
+        std::string field;
+        while (std::getline(lineStream, field, ',')) {
+            fields.push_back(field);
+        }
+        
+        std::string location = args[0] + ":" + std::to_string(lineNumber);
+        if (fields.size() < 2 || fields.size() > 3) {
+            return {false, location + ": expected address,amount[,token]"};
+        }
+        
+        TransferDestination destination;
+        destination.address = fields[0];
+        if (destination.address.empty()) {
+            return {false, location + ": missing address"};
+        }
+        if (!Amount::parse(fields[1], destination.amount) || destination.amount.isZero()) {
+            return {false, location + ": invalid amount: " + fields[1]};
+        }
+        if (fields.size() == 3) {
+            destination.assetId = AssetRegistry::getInstance().find(fields[2]);
+            if (destination.assetId == INVALID_ASSET_ID) {
+                return {false, location + ": unknown token: " + fields[2]};
+            }
+        }
+        
+        destinations.push_back(destination);
+    }
+    
+    if (destinations.empty()) {
+        return {false, "No transfers found in " + args[0]};
+    }
+    
+    // Perform the transfers
+    if (!m_wallet->transferBatch(destinations)) {
+        return {false, "Batch transfer failed. Please check your balances and the recipient addresses."};
+    }
+    
+    return {true, "Transferred to " + std::to_string(destinations.size()) + " addresses"};
+}
+
+/**
+ * Handles the history command
+ */
+CommandResult CommandHandler::handleHistory(const std::vector<std::string>& args) {
+    if (!m_wallet) {
+        return {false, "Wallet is not initialized"};
+    }
+    
+    const std::string usage = "Usage: history [--status <status>] [--address <address>] [--limit <n>] [--after <cursor>] [--oldest-first]";
+    
+    // Parse options
+    HistoryQuery query;
+    for (size_t i = 0; i < args.size(); ++i) {
+        const std::string& option = args[i];
+        
+        if (option == "--oldest-first") {
+            query.newestFirst = false;
+            continue;
+        }
+        
+        if (i + 1 >= args.size()) {
+            return {false, usage};
+        }
+        const std::string& value = args[++i];
+        
+        if (option == "--status") {
+            if (!parseTransactionStatus(value, query.status)) {
+                return {false, "Invalid status: " + value + " (expected pending, confirmed or failed)"};
+            }
+            query.filterStatus = true;
+        } else if (option == "--address") {
+            query.counterparty = value;
+        } else if (option == "--limit") {
+            try {
+                query.limit = std::stoul(value);
+            } catch (const std::exception&) {
+                return {false, "Invalid limit: " + value};
+            }
+            if (query.limit == 0) {
+                return {false, "Limit must be positive"};
+            }
+        } else if (option == "--after") {
+            if (!HistoryCursor::parse(value, query.after)) {
+                return {false, "Invalid cursor: " + value};
+            }
+        } else {
+            return {false, usage};
+        }
+    }
+    
+    std::vector<Transaction> transactions;
+    HistoryPage page = m_wallet->queryHistory(query, transactions);
+    
+    if (transactions.empty()) {
+        return {true, "No transactions found"};
+    }
+    
+    std::stringstream ss;
+    ss << "Transactions:\n";
+    for (const auto& transaction : transactions) {
+        time_t timestamp = transaction.getTimestamp();
+        char timeBuffer[20];
+        struct tm timeInfo;
+#ifndef _WIN32
+        localtime_r(&timestamp, &timeInfo);
+#else
+        localtime_s(&timeInfo, &timestamp);
+#endif
+        strftime(timeBuffer, sizeof(timeBuffer), "%Y-%m-%d %H:%M:%S", &timeInfo);
+        
+        ss << "  " << timeBuffer << "  " << std::left << std::setw(9) << transactionStatusToString(transaction.getStatus())
+           << "  " << transaction.getAmount().toString() << " " << transaction.getTokenSymbol()
+           << " to " << transaction.getToAddress() << "\n"
+           << "      " << transaction.getId() << "\n";
+    }
+    
+    if (page.hasMore) {
+        ss << "More transactions: history --after " << page.next.toString() << "\n";
+    }
+    
+    return {true, ss.str()};
+}
+
 /**
  * Handles the seed command
  */
@@ -387,13 +553,21 @@ CommandResult CommandHandler::handleRefresh(const std::vector<std::string>& args
         return {false, "Network synchronizer or wallet is not initialized"};
     }
     
+    // Resume from the wallet's saved checkpoint instead of rescanning from genesis
+    m_networkSync->setSyncCheckpoint(m_wallet->getSyncCheckpoint());
+    m_networkSync->setReorgCallback([this](uint64_t forkHeight) {
+        m_wallet->rollbackToHeight(forkHeight);
+    });
+    m_networkSync->setOutputScanner(m_wallet->createOutputScanner());
+    
     // Start synchronization
-    bool success = m_networkSync->synchronize(m_wallet->getAddress());
+    bool success = m_networkSync->startSync();
     
     if (success) {
+        m_wallet->setSyncCheckpoint(m_networkSync->getSyncCheckpoint());
         return {true, "Wallet refreshed successfully"};
     } else {
-        return {false, "Failed to refresh wallet. Check your network connection."};
+        return {false, "Failed to refresh wallet. The network could not be reached or its blocks failed verification."};
     }
 }
 
@@ -443,25 +617,23 @@ CommandResult CommandHandler::handleDonate(const std::vector<std::string>& args)
     std::string donationAddress = "LUMI1DevelopmentTeamDonationAddressXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXX";
     
     // Default donation amount
-    double amount = 1.0;
+    Amount amount(Amount::ATOMIC_UNITS_PER_COIN);
     
     // Parse custom amount if provided
     if (!args.empty()) {
-        try {
-            amount = std::stod(args[0]);
-            if (amount <= 0) {
-                return {false, "Donation amount must be positive"};
-            }
-        } catch (const std::exception&) {
+        if (!Amount::parse(args[0], amount)) {
             return {false, "Invalid donation amount: " + args[0]};
         }
+        if (amount.isZero()) {
+            return {false, "Donation amount must be positive"};
+        }
     }
     
     // Confirm donation
     if (args.size() < 2 || args[1] != "confirm") {
         std::stringstream ss;
-        ss << "You are about to donate " << std::fixed << std::setprecision(8) << amount << " LUMI to the LuminaChain development team.\n";
-        ss << "To confirm, type: donate " << amount << " confirm";
+        ss << "You are about to donate " << amount.toString() << " LUMI to the LuminaChain development team.\n";
+        ss << "To confirm, type: donate " << amount.toString() << " confirm";
         return {true, ss.str()};
     }
     
@@ -469,7 +641,7 @@ CommandResult CommandHandler::handleDonate(const std::vector<std::string>& args)
     bool success = m_wallet->transfer(donationAddress, amount, "Donation");
     
     if (success) {
-        return {true, "Thank you for your donation of " + std::to_string(amount) + " LUMI to the LuminaChain development team!"};
+        return {true, "Thank you for your donation of " + amount.toString() + " LUMI to the LuminaChain development team!"};
     } else {
         return {false, "Donation failed. Please check your balance."};
     }
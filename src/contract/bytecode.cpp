@@ -0,0 +1,169 @@
+/**
+ * LuminaChain Wallet - Contract Bytecode Implementation
+ *
+ * This file implements helpers for the compiled form of Lumina smart
+ * contracts.
+ *
+ * Copyright (c) 2023 LuminaChain Development Team
+ * Licensed under MIT License
+ */
+
+#include "contract/bytecode.h"
+
+namespace lumina {
+
+/**
+ * Gets the mnemonic of an opcode
+ */
+const char* opcodeName(Opcode opcode) {
+    static const char* const names[OPCODE_COUNT] = {
+#define LUMA_OPCODE_NAME(name, cost) #name,
+        LUMA_OPCODES(LUMA_OPCODE_NAME)
+#undef LUMA_OPCODE_NAME
+    };
+
+    size_t index = static_cast<size_t>(opcode);
+    return index < OPCODE_COUNT ? names[index] : "UNKNOWN";
+}
+
+/**
+ * Checks whether an opcode may leave its block other than by falling through
+ */
+static bool endsBlock(Opcode op) {
+    return op == Opcode::JMP || op == Opcode::JMPIF || op == Opcode::JMPIFNOT ||
+           op == Opcode::FORPREP || op == Opcode::FORLOOP || op == Opcode::RET;
+}
+
+/**
+ * Finds a function by name
+ */
+int CompiledContract::findFunction(const std::string& functionName) const {
+    for (size_t i = 0; i < functions.size(); ++i) {
+        if (functions[i].name == functionName) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+/**
+ * Checks that a compiled contract is safe to run
+ */
+bool verifyContract(const CompiledContract& contract, std::string& error) {
+    if (contract.functions.empty()) {
+        error = "Contract has no functions";
+        return false;
+    }
+
+    for (const CompiledFunction& function : contract.functions) {
+        const std::vector<Instruction>& code = function.code;
+        size_t registers = function.registerCount;
+        auto fail = [&](const std::string& reason) {
+            error = "Function '" + function.name + "': " + reason;
+            return false;
+        };
+
+        if (registers > MAX_FUNCTION_REGISTERS || function.paramCount > registers ||
+            function.params.size() != function.paramCount) {
+            return fail("Invalid register or parameter count");
+        }
+        if (code.empty() || code.front().op != Opcode::GAS) {
+            return fail("Code does not start with a gas charge");
+        }
+        if (code.back().op != Opcode::RET && code.back().op != Opcode::JMP) {
+            return fail("Code runs past its end");
+        }
+
+        for (size_t pc = 0; pc < code.size(); ++pc) {
+            const Instruction& ins = code[pc];
+            if (static_cast<size_t>(ins.op) >= OPCODE_COUNT) {
+                return fail("Invalid opcode at " + std::to_string(pc));
+            }
+
+            bool valid = true;
+            bool jumps = false;
+            switch (ins.op) {
+                case Opcode::GAS:
+                    break;
+                case Opcode::LOADI:
+                case Opcode::RET:
+                    valid = ins.a < registers;
+                    break;
+                case Opcode::LOADK:
+                    valid = ins.a < registers && ins.bx() < contract.constants.size();
+                    break;
+                case Opcode::MOVE:
+                case Opcode::NEG:
+                case Opcode::NOT:
+                case Opcode::BOOL:
+                    valid = ins.a < registers && ins.b < registers;
+                    break;
+                case Opcode::JMP:
+                    jumps = true;
+                    break;
+                case Opcode::JMPIF:
+                case Opcode::JMPIFNOT:
+                    valid = ins.a < registers;
+                    jumps = true;
+                    break;
+                case Opcode::FORPREP:
+                case Opcode::FORLOOP:
+                    valid = ins.a + 1u < registers;
+                    jumps = true;
+                    break;
+                case Opcode::CALL:
+                    valid = ins.b < contract.functions.size() && ins.a + static_cast<size_t>(ins.c) < registers &&
+                            ins.c == contract.functions[ins.b].paramCount;
+                    break;
+                case Opcode::SLOAD:
+                case Opcode::SSTORE:
+                    valid = ins.a < registers && ins.bx() < contract.strings.size();
+                    break;
+                case Opcode::SLOADX:
+                case Opcode::SSTOREX:
+                    valid = ins.a < registers && ins.b < contract.strings.size() && ins.c < registers;
+                    break;
+                default:
+                    // Binary operations
+                    valid = ins.a < registers && ins.b < registers && ins.c < registers;
+                    break;
+            }
+            if (!valid) {
+                return fail("Operand out of range at " + std::to_string(pc));
+            }
+
+            if (jumps) {
+                int64_t target = static_cast<int64_t>(pc) + 1 + ins.sbx();
+                if (target < 0 || target >= static_cast<int64_t>(code.size()) || code[target].op != Opcode::GAS) {
+                    return fail("Invalid jump target at " + std::to_string(pc));
+                }
+            }
+        }
+
+        // Each GAS must charge exactly the block it heads, and the next block must start with one,
+        // so neither a wrong charge nor the fall-through of a branch escapes metering
+        for (size_t pc = 0; pc < code.size();) {
+            const Instruction& charge = code[pc];
+            if (charge.op != Opcode::GAS || charge.a == 0 || charge.a >= code.size() - pc) {
+                return fail("Invalid gas charge at " + std::to_string(pc));
+            }
+
+            size_t end = pc + 1 + charge.a;
+            uint32_t cost = 0;
+            for (size_t i = pc + 1; i < end; ++i) {
+                if (code[i].op == Opcode::GAS || (endsBlock(code[i].op) && i + 1 < end)) {
+                    return fail("Block charged at " + std::to_string(pc) + " is not a basic block");
+                }
+                cost += OPCODE_GAS_COST[static_cast<size_t>(code[i].op)];
+            }
+            if (cost != charge.bx()) {
+                return fail("Gas charge at " + std::to_string(pc) + " does not match its block");
+            }
+            pc = end;
+        }
+    }
+
+    return true;
+}
+
+} // namespace lumina
@@ -0,0 +1,1047 @@
+/**
+ * LuminaChain Wallet - Contract Compiler Implementation
+ *
+ * This file implements the ContractCompiler class which compiles Lumina
+ * smart contract source (.luma) into bytecode.
+ *
+ * Copyright (c) 2023 LuminaChain Development Team
+ * Licensed under MIT License
+ */
+
+#include "contract/compiler.h"
+#include <algorithm>
+#include <cctype>
+#include <limits>
+
+namespace lumina {
+
+// Maximum number of instructions charged by one GAS instruction
+const size_t GAS_CHUNK_MAX_INSTRUCTIONS = 255;
+
+// Maximum nesting of parentheses, prefix operators and blocks, well within the stack of any thread
+const size_t MAX_NESTING_DEPTH = 256;
+
+/**
+ * Checks whether an opcode ends a basic block with a jump or branch
+ */
+static bool isJump(Opcode op) {
+    return op == Opcode::JMP || op == Opcode::JMPIF || op == Opcode::JMPIFNOT ||
+           op == Opcode::FORPREP || op == Opcode::FORLOOP;
+}
+
+/**
+ * Wrapping 64-bit arithmetic, matching the VM
+ */
+static int64_t wrapAdd(int64_t a, int64_t b) {
+    return static_cast<int64_t>(static_cast<uint64_t>(a) + static_cast<uint64_t>(b));
+}
+
+static int64_t wrapSub(int64_t a, int64_t b) {
+    return static_cast<int64_t>(static_cast<uint64_t>(a) - static_cast<uint64_t>(b));
+}
+
+static int64_t wrapMul(int64_t a, int64_t b) {
+    return static_cast<int64_t>(static_cast<uint64_t>(a) * static_cast<uint64_t>(b));
+}
+
+/**
+ * Compiles contract source
+ */
+bool ContractCompiler::compile(std::string_view source, CompiledContract& contract) {
+    contract = CompiledContract();
+    m_contract = &contract;
+    m_currentFunction = 0;
+    m_locals.clear();
+    m_freeRegister = 0;
+    m_nestingDepth = 0;
+    m_functionIndices.clear();
+    m_functionDefined.clear();
+    m_calls.clear();
+    m_constantIndices.clear();
+    m_stringIndices.clear();
+    m_error.clear();
+
+    bool compiled = true;
+    try {
+        tokenize(source);
+        parseContract(contract);
+    } catch (const CompileError& error) {
+        m_error = error.message;
+        contract = CompiledContract();
+        compiled = false;
+    }
+
+    // Tokens, locals and indices view the source, which the caller may now release
+    m_tokens.clear();
+    m_locals.clear();
+    m_functionIndices.clear();
+    m_stringIndices.clear();
+    m_contract = nullptr;
+    return compiled;
+}
+
+/**
+ * Gets the error of the last failed compilation
+ */
+const std::string& ContractCompiler::getError() const {
+    return m_error;
+}
+
+/**
+ * Splits the source into tokens
+ */
+void ContractCompiler::tokenize(std::string_view source) {
+    static const std::unordered_map<std::string_view, TokenType> keywords = {
+        {"contract", TokenType::CONTRACT}, {"function", TokenType::FUNCTION},
+        {"let", TokenType::LET}, {"if", TokenType::IF}, {"else", TokenType::ELSE},
+        {"while", TokenType::WHILE}, {"for", TokenType::FOR}, {"in", TokenType::IN},
+        {"return", TokenType::RETURN}, {"load", TokenType::LOAD}, {"store", TokenType::STORE},
+        {"true", TokenType::TRUE}, {"false", TokenType::FALSE}
+    };
+
+    m_tokens.clear();
+    m_position = 0;
+
+    int line = 1;
+    size_t i = 0;
+    while (i < source.size()) {
+        char c = source[i];
+
+        if (c == '\n') {
+            ++line;
+            ++i;
+            continue;
+        }
+        if (std::isspace(static_cast<unsigned char>(c))) {
+            ++i;
+            continue;
+        }
+        if (c == '/' && i + 1 < source.size() && source[i + 1] == '/') {
+            while (i < source.size() && source[i] != '\n') {
+                ++i;
+            }
+            continue;
+        }
+
+        Token token{TokenType::END, "", 0, line};
+
+        if (std::isalpha(static_cast<unsigned char>(c)) || c == '_') {
+            size_t start = i;
+            while (i < source.size() && (std::isalnum(static_cast<unsigned char>(source[i])) || source[i] == '_')) {
+                ++i;
+            }
+            token.text = source.substr(start, i - start);
+            auto keyword = keywords.find(token.text);
+            token.type = keyword != keywords.end() ? keyword->second : TokenType::IDENTIFIER;
+        } else if (std::isdigit(static_cast<unsigned char>(c))) {
+            uint64_t value = 0;
+            while (i < source.size() && std::isdigit(static_cast<unsigned char>(source[i]))) {
+                uint64_t digit = source[i] - '0';
+                if (value > (static_cast<uint64_t>(std::numeric_limits<int64_t>::max()) - digit) / 10) {
+                    throw CompileError{"line " + std::to_string(line) + ": Number is too large"};
+                }
+                value = value * 10 + digit;
+                ++i;
+            }
+            token.type = TokenType::NUMBER;
+            token.number = static_cast<int64_t>(value);
+        } else if (c == '"') {
+            size_t start = ++i;
+            while (i < source.size() && source[i] != '"' && source[i] != '\n') {
+                ++i;
+            }
+            if (i >= source.size() || source[i] != '"') {
+                throw CompileError{"line " + std::to_string(line) + ": Unterminated string"};
+            }
+            token.type = TokenType::STRING;
+            token.text = source.substr(start, i - start);
+            ++i;
+        } else {
+            char following = i + 1 < source.size() ? source[i + 1] : '\0';
+            size_t length = 2;
+            if (c == '=' && following == '=') token.type = TokenType::EQ;
+            else if (c == '!' && following == '=') token.type = TokenType::NE;
+            else if (c == '<' && following == '=') token.type = TokenType::LE;
+            else if (c == '>' && following == '=') token.type = TokenType::GE;
+            else if (c == '&' && following == '&') token.type = TokenType::AND;
+            else if (c == '|' && following == '|') token.type = TokenType::OR;
+            else if (c == '.' && following == '.') token.type = TokenType::RANGE;
+            else {
+                length = 1;
+                switch (c) {
+                    case '(': token.type = TokenType::LPAREN; break;
+                    case ')': token.type = TokenType::RPAREN; break;
+                    case '{': token.type = TokenType::LBRACE; break;
+                    case '}': token.type = TokenType::RBRACE; break;
+                    case ',': token.type = TokenType::COMMA; break;
+                    case ';': token.type = TokenType::SEMICOLON; break;
+                    case '=': token.type = TokenType::ASSIGN; break;
+                    case '+': token.type = TokenType::PLUS; break;
+                    case '-': token.type = TokenType::MINUS; break;
+                    case '*': token.type = TokenType::STAR; break;
+                    case '/': token.type = TokenType::SLASH; break;
+                    case '%': token.type = TokenType::PERCENT; break;
+                    case '!': token.type = TokenType::NOT; break;
+                    case '<': token.type = TokenType::LT; break;
+                    case '>': token.type = TokenType::GT; break;
+                    default:
+                        throw CompileError{"line " + std::to_string(line) + ": Unexpected character '" + c + "'"};
+                }
+            }
+            token.text = source.substr(i, length);
+            i += length;
+        }
+
+        m_tokens.push_back(token);
+    }
+
+    m_tokens.push_back({TokenType::END, "end of file", 0, line});
+}
+
+/**
+ * Gets a token without consuming it
+ */
+const ContractCompiler::Token& ContractCompiler::peek(size_t ahead) const {
+    return m_tokens[std::min(m_position + ahead, m_tokens.size() - 1)];
+}
+
+/**
+ * Consumes the next token
+ */
+ContractCompiler::Token ContractCompiler::next() {
+    Token token = peek();
+    if (m_position < m_tokens.size() - 1) {
+        ++m_position;
+    }
+    return token;
+}
+
+/**
+ * Consumes the next token if it has the given type
+ */
+bool ContractCompiler::accept(TokenType type) {
+    if (peek().type != type) {
+        return false;
+    }
+    next();
+    return true;
+}
+
+/**
+ * Consumes the next token, failing unless it has the given type
+ */
+void ContractCompiler::expect(TokenType type, const char* what) {
+    if (!accept(type)) {
+        fail(std::string("Expected ") + what + " but found '" + std::string(peek().text) + "'");
+    }
+}
+
+/**
+ * Parses a contract: contract Name { function ... }
+ */
+void ContractCompiler::parseContract(CompiledContract& contract) {
+    expect(TokenType::CONTRACT, "'contract'");
+    if (peek().type != TokenType::IDENTIFIER) {
+        fail("Expected a contract name");
+    }
+    contract.name = next().text;
+    expect(TokenType::LBRACE, "'{'");
+
+    while (peek().type == TokenType::FUNCTION) {
+        parseFunction();
+    }
+
+    expect(TokenType::RBRACE, "'}'");
+    expect(TokenType::END, "end of file");
+
+    if (contract.functions.empty()) {
+        fail("Contract has no functions");
+    }
+
+    // Calls may precede the definition of their function, so check them now
+    for (const PendingCall& call : m_calls) {
+        const CompiledFunction& function = contract.functions[call.function];
+        std::string where = "line " + std::to_string(call.line) + ": ";
+        if (!m_functionDefined[call.function]) {
+            throw CompileError{where + "Call to undefined function '" + function.name + "'"};
+        }
+        if (call.argCount != function.paramCount) {
+            throw CompileError{where + "Function '" + function.name + "' takes " +
+                               std::to_string(function.paramCount) + " arguments but is called with " +
+                               std::to_string(call.argCount)};
+        }
+    }
+}
+
+/**
+ * Parses a function: function name(params) { body }
+ */
+void ContractCompiler::parseFunction() {
+    expect(TokenType::FUNCTION, "'function'");
+    if (peek().type != TokenType::IDENTIFIER) {
+        fail("Expected a function name");
+    }
+    std::string_view name = next().text;
+
+    m_currentFunction = functionIndex(name);
+    if (m_functionDefined[m_currentFunction]) {
+        fail("Function '" + std::string(name) + "' is defined twice");
+    }
+    m_functionDefined[m_currentFunction] = true;
+
+    m_locals.clear();
+    m_freeRegister = 0;
+
+    expect(TokenType::LPAREN, "'('");
+    if (peek().type != TokenType::RPAREN) {
+        do {
+            if (peek().type != TokenType::IDENTIFIER) {
+                fail("Expected a parameter name");
+            }
+            std::string_view param = next().text;
+            declareLocal(param);
+            currentFunction().params.emplace_back(param);
+        } while (accept(TokenType::COMMA));
+    }
+    expect(TokenType::RPAREN, "')'");
+    currentFunction().paramCount = static_cast<uint8_t>(m_locals.size());
+
+    parseBlock();
+
+    // Functions that fall off their end return 0
+    uint8_t result = allocRegister();
+    emit(Instruction::makeAsBx(Opcode::LOADI, result, 0));
+    emit(Instruction::makeABC(Opcode::RET, result, 0, 0));
+
+    insertGasCharges(currentFunction());
+}
+
+/**
+ * Parses a block: { statements }
+ */
+void ContractCompiler::parseBlock() {
+    NestingGuard nesting(*this);
+    expect(TokenType::LBRACE, "'{'");
+
+    size_t localCount = m_locals.size();
+    while (peek().type != TokenType::RBRACE && peek().type != TokenType::END) {
+        parseStatement();
+    }
+    expect(TokenType::RBRACE, "'}'");
+
+    m_locals.resize(localCount);
+    m_freeRegister = localCount;
+}
+
+/**
+ * Parses a statement
+ */
+void ContractCompiler::parseStatement() {
+    switch (peek().type) {
+        case TokenType::LET: {
+            next();
+            if (peek().type != TokenType::IDENTIFIER) {
+                fail("Expected a variable name");
+            }
+            std::string_view name = next().text;
+            expect(TokenType::ASSIGN, "'='");
+            ExprDesc value = parseExpression();
+            expect(TokenType::SEMICOLON, "';'");
+
+            // The variable takes the first free register, where a temporary value already is
+            freeExpr(value);
+            uint8_t reg = declareLocal(name);
+            toRegister(value, reg);
+            break;
+        }
+        case TokenType::IF:
+            next();
+            parseIf();
+            break;
+        case TokenType::WHILE:
+            next();
+            parseWhile();
+            break;
+        case TokenType::FOR:
+            next();
+            parseFor();
+            break;
+        case TokenType::STORE:
+            next();
+            parseStore();
+            break;
+        case TokenType::RETURN: {
+            next();
+            uint8_t reg;
+            if (peek().type == TokenType::SEMICOLON) {
+                reg = allocRegister();
+                emit(Instruction::makeAsBx(Opcode::LOADI, reg, 0));
+            } else {
+                ExprDesc value = parseExpression();
+                reg = toAnyRegister(value);
+            }
+            expect(TokenType::SEMICOLON, "';'");
+            emit(Instruction::makeABC(Opcode::RET, reg, 0, 0));
+            break;
+        }
+        case TokenType::IDENTIFIER: {
+            if (peek(1).type == TokenType::LPAREN) {
+                // Call for its side effects, discarding the result
+                std::string_view name = next().text;
+                parseCall(name);
+                expect(TokenType::SEMICOLON, "';'");
+                break;
+            }
+
+            std::string_view name = next().text;
+            int local = findLocal(name);
+            if (local < 0) {
+                fail("Unknown variable '" + std::string(name) + "'");
+            }
+            expect(TokenType::ASSIGN, "'='");
+            ExprDesc value = parseExpression();
+            expect(TokenType::SEMICOLON, "';'");
+            toRegister(value, m_locals[local].reg);
+            break;
+        }
+        default:
+            fail("Expected a statement but found '" + std::string(peek().text) + "'");
+    }
+
+    // Temporaries do not outlive their statement
+    m_freeRegister = m_locals.size();
+}
+
+/**
+ * Parses the rest of an if statement: (condition) { ... } [else ...]
+ */
+void ContractCompiler::parseIf() {
+    expect(TokenType::LPAREN, "'('");
+    ExprDesc condition = parseExpression();
+    expect(TokenType::RPAREN, "')'");
+
+    uint8_t reg = toAnyRegister(condition);
+    freeExpr(condition);
+    size_t skipThen = emitJump(Opcode::JMPIFNOT, reg);
+    parseBlock();
+
+    if (accept(TokenType::ELSE)) {
+        size_t skipElse = emitJump(Opcode::JMP, 0);
+        patchJump(skipThen, currentFunction().code.size());
+        if (accept(TokenType::IF)) {
+            parseIf();
+        } else {
+            parseBlock();
+        }
+        patchJump(skipElse, currentFunction().code.size());
+    } else {
+        patchJump(skipThen, currentFunction().code.size());
+    }
+}
+
+/**
+ * Parses the rest of a while loop: (condition) { ... }
+ */
+void ContractCompiler::parseWhile() {
+    size_t loopStart = currentFunction().code.size();
+
+    expect(TokenType::LPAREN, "'('");
+    ExprDesc condition = parseExpression();
+    expect(TokenType::RPAREN, "')'");
+
+    uint8_t reg = toAnyRegister(condition);
+    freeExpr(condition);
+    size_t exit = emitJump(Opcode::JMPIFNOT, reg);
+    parseBlock();
+
+    size_t loop = emitJump(Opcode::JMP, 0);
+    patchJump(loop, loopStart);
+    patchJump(exit, currentFunction().code.size());
+}
+
+/**
+ * Parses the rest of a for loop: name in start..limit { ... }
+ *
+ * The loop variable and a hidden copy of the limit take two consecutive
+ * registers, as FORPREP and FORLOOP expect.
+ */
+void ContractCompiler::parseFor() {
+    if (peek().type != TokenType::IDENTIFIER) {
+        fail("Expected a loop variable");
+    }
+    std::string_view name = next().text;
+    expect(TokenType::IN, "'in'");
+
+    ExprDesc start = parseExpression();
+    freeExpr(start);
+    uint8_t base = allocRegister();
+    toRegister(start, base);
+
+    expect(TokenType::RANGE, "'..'");
+    uint8_t limitReg = allocRegister();
+    ExprDesc limit = parseExpression();
+    freeExpr(limit);
+    toRegister(limit, limitReg);
+
+    // The limit becomes a local under a name no identifier can have
+    m_freeRegister = base;
+    declareLocal(name);
+    declareLocal("(limit)");
+
+    size_t prep = emitJump(Opcode::FORPREP, base);
+    size_t bodyStart = currentFunction().code.size();
+    parseBlock();
+    size_t loop = emitJump(Opcode::FORLOOP, base);
+    patchJump(loop, bodyStart);
+    patchJump(prep, currentFunction().code.size());
+
+    m_locals.resize(m_locals.size() - 2);
+}
+
+/**
+ * Parses the rest of a store statement: (key[, index], value);
+ */
+void ContractCompiler::parseStore() {
+    expect(TokenType::LPAREN, "'('");
+    if (peek().type != TokenType::STRING) {
+        fail("Expected a storage key string");
+    }
+    std::string_view key = next().text;
+    expect(TokenType::COMMA, "','");
+
+    ExprDesc first = parseExpression();
+    uint8_t firstReg = toAnyRegister(first);
+
+    if (accept(TokenType::COMMA)) {
+        ExprDesc value = parseExpression();
+        uint8_t valueReg = toAnyRegister(value);
+        uint16_t keyIndex = stringIndex(key);
+        if (keyIndex > 0xff) {
+            fail("Too many indexed storage keys");
+        }
+        emit(Instruction::makeABC(Opcode::SSTOREX, valueReg, static_cast<uint8_t>(keyIndex), firstReg));
+    } else {
+        emit(Instruction::makeABx(Opcode::SSTORE, firstReg, stringIndex(key)));
+    }
+
+    expect(TokenType::RPAREN, "')'");
+    expect(TokenType::SEMICOLON, "';'");
+}
+
+/**
+ * Parses an expression
+ */
+ContractCompiler::ExprDesc ContractCompiler::parseExpression() {
+    return parseBinary(1);
+}
+
+/**
+ * Parses binary operators of at least the given precedence
+ */
+ContractCompiler::ExprDesc ContractCompiler::parseBinary(int precedence) {
+    auto precedenceOf = [](TokenType type) {
+        switch (type) {
+            case TokenType::OR: return 1;
+            case TokenType::AND: return 2;
+            case TokenType::EQ: case TokenType::NE: return 3;
+            case TokenType::LT: case TokenType::LE: case TokenType::GT: case TokenType::GE: return 4;
+            case TokenType::PLUS: case TokenType::MINUS: return 5;
+            case TokenType::STAR: case TokenType::SLASH: case TokenType::PERCENT: return 6;
+            default: return 0;
+        }
+    };
+
+    ExprDesc left = parseUnary();
+
+    while (true) {
+        TokenType op = peek().type;
+        int opPrecedence = precedenceOf(op);
+        if (opPrecedence == 0 || opPrecedence < precedence) {
+            break;
+        }
+        next();
+
+        if (op == TokenType::AND || op == TokenType::OR) {
+            // Keep the left value in a temporary and skip the right side if it decides the result
+            freeExpr(left);
+            uint8_t dest = allocRegister();
+            toRegister(left, dest);
+            size_t skip = emitJump(op == TokenType::AND ? Opcode::JMPIFNOT : Opcode::JMPIF, dest);
+            ExprDesc right = parseBinary(opPrecedence + 1);
+            toRegister(right, dest);
+            m_freeRegister = dest + 1;
+            patchJump(skip, currentFunction().code.size());
+            emit(Instruction::makeABC(Opcode::BOOL, dest, dest, 0));
+            left = {ExprDesc::TEMP, 0, dest, 0};
+            continue;
+        }
+
+        // A pending instruction must get its register before the right side is compiled
+        if (left.kind == ExprDesc::RELOC) {
+            toAnyRegister(left);
+        }
+        ExprDesc right = parseBinary(opPrecedence + 1);
+
+        if (left.kind == ExprDesc::CONSTANT && right.kind == ExprDesc::CONSTANT) {
+            int64_t a = left.value;
+            int64_t b = right.value;
+            bool folded = true;
+            int64_t result = 0;
+            switch (op) {
+                case TokenType::PLUS: result = wrapAdd(a, b); break;
+                case TokenType::MINUS: result = wrapSub(a, b); break;
+                case TokenType::STAR: result = wrapMul(a, b); break;
+                case TokenType::SLASH:
+                case TokenType::PERCENT:
+                    // Division by zero is left to fail at run time
+                    if (b == 0 || (a == std::numeric_limits<int64_t>::min() && b == -1)) {
+                        folded = false;
+                    } else {
+                        result = op == TokenType::SLASH ? a / b : a % b;
+                    }
+                    break;
+                case TokenType::EQ: result = a == b; break;
+                case TokenType::NE: result = a != b; break;
+                case TokenType::LT: result = a < b; break;
+                case TokenType::LE: result = a <= b; break;
+                case TokenType::GT: result = a > b; break;
+                case TokenType::GE: result = a >= b; break;
+                default: folded = false; break;
+            }
+            if (folded) {
+                left = {ExprDesc::CONSTANT, result, 0, 0};
+                continue;
+            }
+        }
+
+        uint8_t rightReg = toAnyRegister(right);
+        uint8_t leftReg = toAnyRegister(left);
+        if (leftReg > rightReg) {
+            freeExpr(left);
+            freeExpr(right);
+        } else {
+            freeExpr(right);
+            freeExpr(left);
+        }
+
+        Opcode opcode;
+        bool swap = false;
+        switch (op) {
+            case TokenType::PLUS: opcode = Opcode::ADD; break;
+            case TokenType::MINUS: opcode = Opcode::SUB; break;
+            case TokenType::STAR: opcode = Opcode::MUL; break;
+            case TokenType::SLASH: opcode = Opcode::DIV; break;
+            case TokenType::PERCENT: opcode = Opcode::MOD; break;
+            case TokenType::EQ: opcode = Opcode::EQ; break;
+            case TokenType::NE: opcode = Opcode::NE; break;
+            case TokenType::LT: opcode = Opcode::LT; break;
+            case TokenType::LE: opcode = Opcode::LE; break;
+            case TokenType::GT: opcode = Opcode::LT; swap = true; break;
+            default: opcode = Opcode::LE; swap = true; break;
+        }
+
+        size_t pc = swap ? emit(Instruction::makeABC(opcode, 0, rightReg, leftReg))
+                         : emit(Instruction::makeABC(opcode, 0, leftReg, rightReg));
+        left = {ExprDesc::RELOC, 0, 0, pc};
+    }
+
+    return left;
+}
+
+/**
+ * Parses unary operators
+ */
+ContractCompiler::ExprDesc ContractCompiler::parseUnary() {
+    // Every level of parentheses and every prefix operator passes through here
+    NestingGuard nesting(*this);
+
+    if (accept(TokenType::MINUS)) {
+        ExprDesc operand = parseUnary();
+        if (operand.kind == ExprDesc::CONSTANT) {
+            operand.value = wrapSub(0, operand.value);
+            return operand;
+        }
+        uint8_t reg = toAnyRegister(operand);
+        freeExpr(operand);
+        return {ExprDesc::RELOC, 0, 0, emit(Instruction::makeABC(Opcode::NEG, 0, reg, 0))};
+    }
+
+    if (accept(TokenType::NOT)) {
+        ExprDesc operand = parseUnary();
+        if (operand.kind == ExprDesc::CONSTANT) {
+            operand.value = operand.value == 0;
+            return operand;
+        }
+        uint8_t reg = toAnyRegister(operand);
+        freeExpr(operand);
+        return {ExprDesc::RELOC, 0, 0, emit(Instruction::makeABC(Opcode::NOT, 0, reg, 0))};
+    }
+
+    return parsePrimary();
+}
+
+/**
+ * Parses a number, variable, call, load or parenthesized expression
+ */
+ContractCompiler::ExprDesc ContractCompiler::parsePrimary() {
+    const Token& token = peek();
+    switch (token.type) {
+        case TokenType::NUMBER:
+            return {ExprDesc::CONSTANT, next().number, 0, 0};
+        case TokenType::TRUE:
+            next();
+            return {ExprDesc::CONSTANT, 1, 0, 0};
+        case TokenType::FALSE:
+            next();
+            return {ExprDesc::CONSTANT, 0, 0, 0};
+        case TokenType::LPAREN: {
+            next();
+            ExprDesc inner = parseExpression();
+            expect(TokenType::RPAREN, "')'");
+            return inner;
+        }
+        case TokenType::LOAD:
+            next();
+            return parseLoad();
+        case TokenType::IDENTIFIER: {
+            std::string_view name = next().text;
+            if (peek().type == TokenType::LPAREN) {
+                return parseCall(name);
+            }
+            int local = findLocal(name);
+            if (local < 0) {
+                fail("Unknown variable '" + std::string(name) + "'");
+            }
+            return {ExprDesc::LOCAL, 0, m_locals[local].reg, 0};
+        }
+        default:
+            fail("Expected an expression but found '" + std::string(token.text) + "'");
+    }
+}
+
+/**
+ * Parses the arguments of a call: (args)
+ *
+ * The result register is followed by the arguments, which become the
+ * parameter registers of the callee.
+ */
+ContractCompiler::ExprDesc ContractCompiler::parseCall(std::string_view name) {
+    int line = peek().line;
+    size_t function = functionIndex(name);
+    if (function > 0xff) {
+        fail("Too many functions");
+    }
+
+    expect(TokenType::LPAREN, "'('");
+    uint8_t base = allocRegister();
+    size_t argCount = 0;
+    if (peek().type != TokenType::RPAREN) {
+        do {
+            ExprDesc arg = parseExpression();
+            freeExpr(arg);
+            toRegister(arg, allocRegister());
+            ++argCount;
+        } while (accept(TokenType::COMMA));
+    }
+    expect(TokenType::RPAREN, "')'");
+
+    m_calls.push_back({function, static_cast<uint8_t>(argCount), line});
+    emit(Instruction::makeABC(Opcode::CALL, base, static_cast<uint8_t>(function), static_cast<uint8_t>(argCount)));
+    m_freeRegister = base + 1;
+    return {ExprDesc::TEMP, 0, base, 0};
+}
+
+/**
+ * Parses the rest of a load: (key[, index])
+ */
+ContractCompiler::ExprDesc ContractCompiler::parseLoad() {
+    expect(TokenType::LPAREN, "'('");
+    if (peek().type != TokenType::STRING) {
+        fail("Expected a storage key string");
+    }
+    std::string_view key = next().text;
+
+    size_t pc;
+    if (accept(TokenType::COMMA)) {
+        ExprDesc index = parseExpression();
+        uint8_t indexReg = toAnyRegister(index);
+        freeExpr(index);
+        uint16_t keyIndex = stringIndex(key);
+        if (keyIndex > 0xff) {
+            fail("Too many indexed storage keys");
+        }
+        pc = emit(Instruction::makeABC(Opcode::SLOADX, 0, static_cast<uint8_t>(keyIndex), indexReg));
+    } else {
+        pc = emit(Instruction::makeABx(Opcode::SLOAD, 0, stringIndex(key)));
+    }
+    expect(TokenType::RPAREN, "')'");
+
+    return {ExprDesc::RELOC, 0, 0, pc};
+}
+
+/**
+ * Allocates the next free register
+ */
+uint8_t ContractCompiler::allocRegister() {
+    if (m_freeRegister >= MAX_FUNCTION_REGISTERS) {
+        fail("Function needs too many registers");
+    }
+    uint8_t reg = static_cast<uint8_t>(m_freeRegister++);
+    CompiledFunction& function = currentFunction();
+    function.registerCount = std::max<uint16_t>(function.registerCount, static_cast<uint16_t>(m_freeRegister));
+    return reg;
+}
+
+/**
+ * Frees a temporary register if it is the last one allocated
+ */
+void ContractCompiler::freeRegister(uint8_t reg) {
+    if (reg >= m_locals.size() && reg + 1u == m_freeRegister) {
+        --m_freeRegister;
+    }
+}
+
+/**
+ * Frees the temporary register holding an expression, if any
+ */
+void ContractCompiler::freeExpr(const ExprDesc& expr) {
+    if (expr.kind == ExprDesc::TEMP) {
+        freeRegister(expr.reg);
+    }
+}
+
+/**
+ * Puts the value of an expression into the given register
+ */
+void ContractCompiler::toRegister(const ExprDesc& expr, uint8_t reg) {
+    switch (expr.kind) {
+        case ExprDesc::CONSTANT:
+            if (expr.value >= std::numeric_limits<int16_t>::min() && expr.value <= std::numeric_limits<int16_t>::max()) {
+                emit(Instruction::makeAsBx(Opcode::LOADI, reg, static_cast<int16_t>(expr.value)));
+            } else {
+                emit(Instruction::makeABx(Opcode::LOADK, reg, constantIndex(expr.value)));
+            }
+            break;
+        case ExprDesc::LOCAL:
+        case ExprDesc::TEMP:
+            if (expr.reg != reg) {
+                emit(Instruction::makeABC(Opcode::MOVE, reg, expr.reg, 0));
+            }
+            break;
+        case ExprDesc::RELOC:
+            currentFunction().code[expr.pc].a = reg;
+            break;
+    }
+}
+
+/**
+ * Puts the value of an expression into a register, allocating a temporary if needed
+ */
+uint8_t ContractCompiler::toAnyRegister(ExprDesc& expr) {
+    if (expr.kind == ExprDesc::LOCAL || expr.kind == ExprDesc::TEMP) {
+        return expr.reg;
+    }
+    uint8_t reg = allocRegister();
+    toRegister(expr, reg);
+    expr = {ExprDesc::TEMP, 0, reg, 0};
+    return reg;
+}
+
+/**
+ * Finds the innermost local variable with a name
+ */
+int ContractCompiler::findLocal(std::string_view name) const {
+    for (size_t i = m_locals.size(); i > 0; --i) {
+        if (m_locals[i - 1].name == name) {
+            return static_cast<int>(i - 1);
+        }
+    }
+    return -1;
+}
+
+/**
+ * Declares a local variable in the next free register
+ */
+uint8_t ContractCompiler::declareLocal(std::string_view name) {
+    uint8_t reg = allocRegister();
+    m_locals.push_back({name, reg});
+    return reg;
+}
+
+/**
+ * Gets the function being compiled
+ */
+CompiledFunction& ContractCompiler::currentFunction() {
+    return m_contract->functions[m_currentFunction];
+}
+
+/**
+ * Appends an instruction to the current function
+ */
+size_t ContractCompiler::emit(Instruction instruction) {
+    std::vector<Instruction>& code = currentFunction().code;
+    code.push_back(instruction);
+    return code.size() - 1;
+}
+
+/**
+ * Appends a jump whose offset is patched later
+ */
+size_t ContractCompiler::emitJump(Opcode op, uint8_t reg) {
+    return emit(Instruction::makeAsBx(op, reg, 0));
+}
+
+/**
+ * Points a jump at a target instruction
+ */
+void ContractCompiler::patchJump(size_t jumpPc, size_t targetPc) {
+    int64_t offset = static_cast<int64_t>(targetPc) - static_cast<int64_t>(jumpPc + 1);
+    if (offset < std::numeric_limits<int16_t>::min() || offset > std::numeric_limits<int16_t>::max()) {
+        fail("Function is too large");
+    }
+    Instruction& jump = currentFunction().code[jumpPc];
+    jump = Instruction::makeAsBx(jump.op, jump.a, static_cast<int16_t>(offset));
+}
+
+/**
+ * Gets the index of an integer constant, adding it if needed
+ */
+uint16_t ContractCompiler::constantIndex(int64_t value) {
+    auto it = m_constantIndices.find(value);
+    if (it != m_constantIndices.end()) {
+        return it->second;
+    }
+    if (m_contract->constants.size() > 0xffff) {
+        fail("Too many constants");
+    }
+    uint16_t index = static_cast<uint16_t>(m_contract->constants.size());
+    m_contract->constants.push_back(value);
+    m_constantIndices[value] = index;
+    return index;
+}
+
+/**
+ * Gets the index of a storage key, adding it if needed
+ */
+uint16_t ContractCompiler::stringIndex(std::string_view text) {
+    auto it = m_stringIndices.find(text);
+    if (it != m_stringIndices.end()) {
+        return it->second;
+    }
+    if (m_contract->strings.size() > 0xffff) {
+        fail("Too many storage keys");
+    }
+    uint16_t index = static_cast<uint16_t>(m_contract->strings.size());
+    m_contract->strings.emplace_back(text);
+    m_stringIndices[text] = index;
+    return index;
+}
+
+/**
+ * Gets the index of a function, adding an undefined one if needed
+ */
+size_t ContractCompiler::functionIndex(std::string_view name) {
+    auto it = m_functionIndices.find(name);
+    if (it != m_functionIndices.end()) {
+        return it->second;
+    }
+    size_t index = m_contract->functions.size();
+    CompiledFunction function;
+    function.name = name;
+    m_contract->functions.push_back(function);
+    m_functionDefined.push_back(false);
+    m_functionIndices[name] = index;
+    return index;
+}
+
+/**
+ * Inserts a GAS instruction at the start of each basic block
+ *
+ * Blocks start at the entry, at jump targets and after jumps and returns.
+ * Blocks longer than a GAS instruction can count are split. Jumps are
+ * then relocated to the GAS instruction of their target block.
+ */
+void ContractCompiler::insertGasCharges(CompiledFunction& function) {
+    const std::vector<Instruction>& code = function.code;
+    size_t count = code.size();
+
+    std::vector<bool> leader(count + 1, false);
+    leader[0] = true;
+    for (size_t i = 0; i < count; ++i) {
+        if (isJump(code[i].op)) {
+            leader[i + 1 + code[i].sbx()] = true;
+            leader[i + 1] = true;
+        } else if (code[i].op == Opcode::RET) {
+            leader[i + 1] = true;
+        }
+    }
+
+    std::vector<Instruction> charged;
+    charged.reserve(count + count / 4 + 1);
+    std::vector<size_t> blockStart(count + 1, 0);    // New index of the block starting at an old index
+    std::vector<size_t> newIndex(count, 0);          // New index of each old instruction
+
+    size_t start = 0;
+    while (start < count) {
+        size_t end = start + 1;
+        while (end < count && !leader[end] && end - start < GAS_CHUNK_MAX_INSTRUCTIONS) {
+            ++end;
+        }
+
+        uint32_t cost = 0;
+        for (size_t i = start; i < end; ++i) {
+            cost += OPCODE_GAS_COST[static_cast<size_t>(code[i].op)];
+        }
+
+        blockStart[start] = charged.size();
+        charged.push_back(Instruction::makeABx(Opcode::GAS, static_cast<uint8_t>(end - start), static_cast<uint16_t>(cost)));
+        for (size_t i = start; i < end; ++i) {
+            newIndex[i] = charged.size();
+            charged.push_back(code[i]);
+        }
+        start = end;
+    }
+    blockStart[count] = charged.size();
+
+    for (size_t i = 0; i < count; ++i) {
+        if (!isJump(code[i].op)) {
+            continue;
+        }
+        size_t target = blockStart[i + 1 + code[i].sbx()];
+        int64_t offset = static_cast<int64_t>(target) - static_cast<int64_t>(newIndex[i] + 1);
+        if (offset < std::numeric_limits<int16_t>::min() || offset > std::numeric_limits<int16_t>::max()) {
+            fail("Function is too large");
+        }
+        Instruction& jump = charged[newIndex[i]];
+        jump = Instruction::makeAsBx(jump.op, jump.a, static_cast<int16_t>(offset));
+    }
+
+    function.code.swap(charged);
+}
+
+/**
+ * Enters a level of nesting, failing before the parser runs out of stack
+ */
+ContractCompiler::NestingGuard::NestingGuard(ContractCompiler& compiler)
+    : m_compiler(compiler) {
+    if (m_compiler.m_nestingDepth >= MAX_NESTING_DEPTH) {
+        m_compiler.fail("Expression nested too deeply");
+    }
+    ++m_compiler.m_nestingDepth;
+}
+
+/**
+ * Leaves a level of nesting
+ */
+ContractCompiler::NestingGuard::~NestingGuard() {
+    --m_compiler.m_nestingDepth;
+}
+
+/**
+ * Aborts compilation with an error at the current token
+ */
+void ContractCompiler::fail(const std::string& message) const {
+    throw CompileError{"line " + std::to_string(peek().line) + ": " + message};
+}
+
+} // namespace lumina
@@ -0,0 +1,366 @@
+/**
+ * LuminaChain Wallet - Compiled Contract Cache Implementation
+ *
+ * This file implements the ContractCache class which keeps compiled Lumina
+ * smart contracts, keyed by a hash of their source.
+ *
+ * Copyright (c) 2023 LuminaChain Development Team
+ * Licensed under MIT License
+ */
+
+#include "contract/contract_cache.h"
+#include "utils/file_utils.h"
+#include "utils/logger.h"
+#include "utils/mapped_file.h"
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+
+namespace lumina {
+
+// Artifact file layout: magic, format version, source hash, then the contract
+static const char ARTIFACT_MAGIC[4] = {'L', 'U', 'M', 'C'};
+static const uint32_t ARTIFACT_VERSION = 1;     // Bump whenever the instruction set or layout changes
+static const char ARTIFACT_EXTENSION[] = ".lumc";
+
+/**
+ * Appends the binary encoding of contract fields to a buffer
+ */
+class ArtifactWriter {
+public:
+    explicit ArtifactWriter(std::vector<uint8_t>& buffer) : m_buffer(buffer) {}
+
+    void bytes(const void* data, size_t size) {
+        if (size == 0) {
+            return;
+        }
+        const uint8_t* begin = static_cast<const uint8_t*>(data);
+        m_buffer.insert(m_buffer.end(), begin, begin + size);
+    }
+
+    template <typename T>
+    void value(T v) {
+        bytes(&v, sizeof(v));
+    }
+
+    void string(const std::string& text) {
+        value(static_cast<uint32_t>(text.size()));
+        bytes(text.data(), text.size());
+    }
+
+private:
+    std::vector<uint8_t>& m_buffer;
+};
+
+/**
+ * Reads contract fields from a buffer, failing instead of reading past its end
+ */
+class ArtifactReader {
+public:
+    ArtifactReader(const uint8_t* data, size_t size) : m_data(data), m_size(size), m_position(0) {}
+
+    bool bytes(void* out, size_t size) {
+        if (size == 0) {
+            return true;
+        }
+        if (size > m_size - m_position) {
+            return false;
+        }
+        std::memcpy(out, m_data + m_position, size);
+        m_position += size;
+        return true;
+    }
+
+    template <typename T>
+    bool value(T& v) {
+        return bytes(&v, sizeof(v));
+    }
+
+    bool string(std::string& text) {
+        uint32_t size;
+        if (!value(size) || size > m_size - m_position) {
+            return false;
+        }
+        text.assign(reinterpret_cast<const char*>(m_data + m_position), size);
+        m_position += size;
+        return true;
+    }
+
+    // Reads an element count, rejecting counts the remaining bytes cannot hold
+    bool count(uint32_t& n, size_t minElementSize) {
+        return value(n) && n <= (m_size - m_position) / minElementSize;
+    }
+
+    bool atEnd() const {
+        return m_position == m_size;
+    }
+
+private:
+    const uint8_t* m_data;
+    size_t m_size;
+    size_t m_position;
+};
+
+/**
+ * Encodes a source hash as a hex key
+ */
+static std::string hashKey(const crypto::hash& hash) {
+    static const char hexChars[] = "0123456789abcdef";
+    std::string key(2 * sizeof(hash.data), '\0');
+    for (size_t i = 0; i < sizeof(hash.data); ++i) {
+        uint8_t byte = static_cast<uint8_t>(hash.data[i]);
+        key[2 * i] = hexChars[byte >> 4];
+        key[2 * i + 1] = hexChars[byte & 0x0f];
+    }
+    return key;
+}
+
+/**
+ * Constructor
+ */
+ContractCache::ContractCache(size_t capacity)
+    : m_capacity(capacity > 0 ? capacity : 1) {
+}
+
+/**
+ * Sets the maximum number of contracts kept in memory
+ */
+void ContractCache::setCapacity(size_t capacity) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_capacity = capacity > 0 ? capacity : 1;
+    while (m_entries.size() > m_capacity) {
+        m_index.erase(m_entries.back().first);
+        m_entries.pop_back();
+    }
+}
+
+/**
+ * Sets the directory compiled contracts are stored in
+ */
+bool ContractCache::setDirectory(const std::string& directory) {
+    if (!directory.empty()) {
+        std::error_code ec;
+        std::filesystem::create_directories(directory, ec);
+        if (ec) {
+            Logger::getInstance().error("Failed to create contract cache directory " + directory + ": " + ec.message());
+            return false;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_directory = directory;
+    return true;
+}
+
+/**
+ * Hashes contract source into a cache key
+ */
+crypto::hash ContractCache::hashSource(std::string_view source) {
+    return crypto::cn_fast_hash(source.data(), source.size());
+}
+
+/**
+ * Finds a compiled contract
+ */
+std::shared_ptr<const CompiledContract> ContractCache::find(const crypto::hash& sourceHash) {
+    std::string key = hashKey(sourceHash);
+    std::string directory;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_index.find(key);
+        if (it != m_index.end()) {
+            m_entries.splice(m_entries.begin(), m_entries, it->second);
+            return it->second->second;
+        }
+        directory = m_directory;
+    }
+
+    if (directory.empty()) {
+        return nullptr;
+    }
+
+    // Read from disk without holding the lock
+    std::shared_ptr<const CompiledContract> contract = loadArtifact(sourceHash);
+    if (contract) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        addEntry(key, contract);
+    }
+    return contract;
+}
+
+/**
+ * Adds a compiled contract
+ */
+void ContractCache::insert(const crypto::hash& sourceHash, std::shared_ptr<const CompiledContract> contract) {
+    std::string key = hashKey(sourceHash);
+    bool persist;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        addEntry(key, contract);
+        persist = !m_directory.empty();
+    }
+
+    if (persist) {
+        saveArtifact(sourceHash, *contract);
+    }
+}
+
+/**
+ * Removes all contracts from memory, keeping those on disk
+ */
+void ContractCache::clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.clear();
+    m_index.clear();
+}
+
+/**
+ * Adds or refreshes an entry, evicting the least recently used one if full
+ */
+void ContractCache::addEntry(const std::string& key, std::shared_ptr<const CompiledContract> contract) {
+    auto it = m_index.find(key);
+    if (it != m_index.end()) {
+        it->second->second = std::move(contract);
+        m_entries.splice(m_entries.begin(), m_entries, it->second);
+        return;
+    }
+
+    if (m_entries.size() >= m_capacity) {
+        m_index.erase(m_entries.back().first);
+        m_entries.pop_back();
+    }
+    m_entries.emplace_front(key, std::move(contract));
+    m_index[key] = m_entries.begin();
+}
+
+/**
+ * Gets the path of the artifact file for a key
+ */
+std::string ContractCache::artifactPath(const std::string& key) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return (std::filesystem::path(m_directory) / (key + ARTIFACT_EXTENSION)).string();
+}
+
+/**
+ * Reads and verifies a compiled contract from its artifact file
+ */
+std::shared_ptr<const CompiledContract> ContractCache::loadArtifact(const crypto::hash& sourceHash) const {
+    std::string path = artifactPath(hashKey(sourceHash));
+    if (!std::filesystem::exists(path)) {
+        return nullptr;
+    }
+
+    MappedFile file;
+    if (!file.open(path)) {
+        return nullptr;
+    }
+
+    ArtifactReader reader(file.data(), file.size());
+    char magic[sizeof(ARTIFACT_MAGIC)];
+    uint32_t version;
+    crypto::hash storedHash;
+    if (!reader.bytes(magic, sizeof(magic)) || std::memcmp(magic, ARTIFACT_MAGIC, sizeof(magic)) != 0 ||
+        !reader.value(version) || version != ARTIFACT_VERSION ||
+        !reader.value(storedHash) || storedHash != sourceHash) {
+        Logger::getInstance().warning("Ignoring stale contract cache file: " + path);
+        return nullptr;
+    }
+
+    auto contract = std::make_shared<CompiledContract>();
+    uint32_t count;
+    bool valid = reader.string(contract->name) && reader.count(count, sizeof(int64_t));
+    if (valid) {
+        contract->constants.resize(count);
+        valid = reader.bytes(contract->constants.data(), count * sizeof(int64_t));
+    }
+    valid = valid && reader.count(count, sizeof(uint32_t));
+    for (uint32_t i = 0; valid && i < count; ++i) {
+        contract->strings.emplace_back();
+        valid = reader.string(contract->strings.back());
+    }
+    valid = valid && reader.count(count, sizeof(uint32_t));
+    for (uint32_t i = 0; valid && i < count; ++i) {
+        contract->functions.emplace_back();
+        CompiledFunction& function = contract->functions.back();
+        uint32_t paramCount;
+        uint32_t codeSize;
+        valid = reader.string(function.name) && reader.value(function.paramCount) &&
+                reader.value(function.registerCount) && reader.count(paramCount, sizeof(uint32_t));
+        for (uint32_t p = 0; valid && p < paramCount; ++p) {
+            function.params.emplace_back();
+            valid = reader.string(function.params.back());
+        }
+        valid = valid && reader.count(codeSize, sizeof(Instruction));
+        if (valid) {
+            function.code.resize(codeSize);
+            valid = reader.bytes(function.code.data(), codeSize * sizeof(Instruction));
+        }
+    }
+
+    std::string error;
+    if (!valid || !reader.atEnd() || !verifyContract(*contract, error)) {
+        Logger::getInstance().warning("Ignoring corrupt contract cache file: " + path +
+                                      (error.empty() ? "" : " (" + error + ")"));
+        return nullptr;
+    }
+
+    LUMINA_LOG_DEBUG("Loaded compiled contract ", contract->name, " from ", path);
+    return contract;
+}
+
+/**
+ * Writes a compiled contract to its artifact file
+ *
+ * The file is written under a temporary name and renamed into place, so
+ * readers never see a partial artifact. It is not synced: a lost
+ * artifact is simply compiled again.
+ */
+void ContractCache::saveArtifact(const crypto::hash& sourceHash, const CompiledContract& contract) const {
+    std::vector<uint8_t> buffer;
+    ArtifactWriter writer(buffer);
+
+    writer.bytes(ARTIFACT_MAGIC, sizeof(ARTIFACT_MAGIC));
+    writer.value(ARTIFACT_VERSION);
+    writer.value(sourceHash);
+    writer.string(contract.name);
+    writer.value(static_cast<uint32_t>(contract.constants.size()));
+    writer.bytes(contract.constants.data(), contract.constants.size() * sizeof(int64_t));
+    writer.value(static_cast<uint32_t>(contract.strings.size()));
+    for (const std::string& text : contract.strings) {
+        writer.string(text);
+    }
+    writer.value(static_cast<uint32_t>(contract.functions.size()));
+    for (const CompiledFunction& function : contract.functions) {
+        writer.string(function.name);
+        writer.value(function.paramCount);
+        writer.value(function.registerCount);
+        writer.value(static_cast<uint32_t>(function.params.size()));
+        for (const std::string& param : function.params) {
+            writer.string(param);
+        }
+        writer.value(static_cast<uint32_t>(function.code.size()));
+        writer.bytes(function.code.data(), function.code.size() * sizeof(Instruction));
+    }
+
+    std::string path = artifactPath(hashKey(sourceHash));
+    std::string tempPath = path + ".tmp";
+    FILE* file = std::fopen(tempPath.c_str(), "wb");
+    if (!file) {
+        Logger::getInstance().warning("Failed to write contract cache file: " + tempPath);
+        return;
+    }
+
+    bool written = writeAll(file, buffer.data(), buffer.size());
+    written = std::fclose(file) == 0 && written;
+
+    std::error_code ec;
+    if (written) {
+        std::filesystem::rename(tempPath, path, ec);
+    }
+    if (!written || ec) {
+        std::filesystem::remove(tempPath, ec);
+        Logger::getInstance().warning("Failed to write contract cache file: " + path);
+    }
+}
+
+} // namespace lumina
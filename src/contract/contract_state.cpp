@@ -0,0 +1,430 @@
+/**
+ * LuminaChain Wallet - Contract State Implementation
+ *
+ * This file implements the ContractState class, a copy-on-write store of
+ * contract storage values, and the StateFile class which persists it.
+ *
+ * Copyright (c) 2023 LuminaChain Development Team
+ * Licensed under MIT License
+ */
+
+#include "contract/contract_state.h"
+#include "crypto/hash.h"
+#include "utils/file_utils.h"
+#include "utils/logger.h"
+#include "utils/mapped_file.h"
+#include <bitset>
+#include <cstring>
+#include <filesystem>
+
+namespace lumina {
+
+// Each trie level consumes this many bits of the key hash
+const unsigned HAMT_BITS = 5;
+const uint64_t HAMT_MASK = (1u << HAMT_BITS) - 1;
+
+/**
+ * The values whose keys share one hash; more than one only on a full
+ * 64-bit hash collision
+ */
+struct HamtLeaf {
+    uint64_t hash;
+    std::vector<std::pair<std::string, int64_t>> entries;
+};
+
+/**
+ * A slot of a trie node, holding either a subtrie or a leaf
+ */
+struct HamtSlot {
+    std::shared_ptr<const HamtNode> node;
+    std::shared_ptr<const HamtLeaf> leaf;
+};
+
+/**
+ * A trie node with a slot for each set bit of its bitmap
+ */
+struct HamtNode {
+    uint32_t bitmap = 0;
+    std::vector<HamtSlot> slots;
+};
+
+/**
+ * Hashes a storage key (64-bit FNV-1a)
+ */
+static uint64_t hashKey(const std::string& key) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (unsigned char c : key) {
+        hash = (hash ^ c) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+/**
+ * Gets the bitmap bit of a hash at a trie level
+ */
+static uint32_t slotBit(uint64_t hash, unsigned shift) {
+    return 1u << ((hash >> shift) & HAMT_MASK);
+}
+
+/**
+ * Gets the position of a slot among the occupied slots of a node
+ */
+static size_t slotIndex(uint32_t bitmap, uint32_t bit) {
+    return std::bitset<32>(bitmap & (bit - 1)).count();
+}
+
+/**
+ * Makes a leaf holding one value
+ */
+static std::shared_ptr<const HamtLeaf> makeLeaf(uint64_t hash, const std::string& key, int64_t value) {
+    auto leaf = std::make_shared<HamtLeaf>();
+    leaf->hash = hash;
+    leaf->entries.emplace_back(key, value);
+    return leaf;
+}
+
+/**
+ * Makes the subtrie holding two leaves with different hashes
+ */
+static std::shared_ptr<const HamtNode> mergeLeaves(std::shared_ptr<const HamtLeaf> first,
+                                                   std::shared_ptr<const HamtLeaf> second, unsigned shift) {
+    auto node = std::make_shared<HamtNode>();
+    uint32_t firstBit = slotBit(first->hash, shift);
+    uint32_t secondBit = slotBit(second->hash, shift);
+
+    if (firstBit == secondBit) {
+        node->bitmap = firstBit;
+        node->slots.push_back({mergeLeaves(std::move(first), std::move(second), shift + HAMT_BITS), nullptr});
+    } else {
+        node->bitmap = firstBit | secondBit;
+        if (firstBit > secondBit) {
+            std::swap(first, second);
+        }
+        node->slots.push_back({nullptr, std::move(first)});
+        node->slots.push_back({nullptr, std::move(second)});
+    }
+    return node;
+}
+
+/**
+ * Stores a value below a node, copying the nodes on the path to it
+ */
+static std::shared_ptr<const HamtNode> insertValue(const HamtNode* node, uint64_t hash, const std::string& key,
+                                                   int64_t value, unsigned shift, bool& added) {
+    auto copy = node ? std::make_shared<HamtNode>(*node) : std::make_shared<HamtNode>();
+    uint32_t bit = slotBit(hash, shift);
+    size_t index = slotIndex(copy->bitmap, bit);
+
+    if ((copy->bitmap & bit) == 0) {
+        copy->bitmap |= bit;
+        copy->slots.insert(copy->slots.begin() + index, HamtSlot{nullptr, makeLeaf(hash, key, value)});
+        added = true;
+        return copy;
+    }
+
+    HamtSlot& slot = copy->slots[index];
+    if (slot.node) {
+        slot.node = insertValue(slot.node.get(), hash, key, value, shift + HAMT_BITS, added);
+    } else if (slot.leaf->hash == hash) {
+        auto leaf = std::make_shared<HamtLeaf>(*slot.leaf);
+        bool found = false;
+        for (auto& entry : leaf->entries) {
+            if (entry.first == key) {
+                entry.second = value;
+                found = true;
+                break;
+            }
+        }
+        if (!found) {
+            leaf->entries.emplace_back(key, value);
+            added = true;
+        }
+        slot.leaf = leaf;
+    } else {
+        slot.node = mergeLeaves(slot.leaf, makeLeaf(hash, key, value), shift + HAMT_BITS);
+        slot.leaf.reset();
+        added = true;
+    }
+    return copy;
+}
+
+/**
+ * Constructor - Creates an empty state
+ */
+ContractState::ContractState()
+    : m_size(0) {
+}
+
+/**
+ * Loads a value
+ */
+int64_t ContractState::load(const std::string& key) {
+    int64_t value = 0;
+    find(key, value);
+    return value;
+}
+
+/**
+ * Stores a value
+ */
+void ContractState::store(const std::string& key, int64_t value) {
+    bool added = false;
+    m_root = insertValue(m_root.get(), hashKey(key), key, value, 0, added);
+    if (added) {
+        ++m_size;
+    }
+    m_writes[key] = value;
+}
+
+/**
+ * Finds a value
+ */
+bool ContractState::find(const std::string& key, int64_t& value) const {
+    uint64_t hash = hashKey(key);
+    const HamtNode* node = m_root.get();
+    unsigned shift = 0;
+
+    while (node) {
+        uint32_t bit = slotBit(hash, shift);
+        if ((node->bitmap & bit) == 0) {
+            return false;
+        }
+
+        const HamtSlot& slot = node->slots[slotIndex(node->bitmap, bit)];
+        if (slot.node) {
+            node = slot.node.get();
+            shift += HAMT_BITS;
+            continue;
+        }
+
+        if (slot.leaf->hash != hash) {
+            return false;
+        }
+        for (const auto& entry : slot.leaf->entries) {
+            if (entry.first == key) {
+                value = entry.second;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    return false;
+}
+
+/**
+ * Forks the state in O(1)
+ */
+ContractState ContractState::fork() const {
+    ContractState forked;
+    forked.m_root = m_root;
+    forked.m_size = m_size;
+    return forked;
+}
+
+/**
+ * Takes the writes recorded since the state was forked or last diffed
+ */
+StateDiff ContractState::takeDiff() {
+    StateDiff diff(m_writes.begin(), m_writes.end());
+    m_writes.clear();
+    return diff;
+}
+
+/**
+ * Stores every value of a diff
+ */
+void ContractState::apply(const StateDiff& diff) {
+    for (const auto& write : diff) {
+        store(write.first, write.second);
+    }
+}
+
+/**
+ * Gets the number of stored keys
+ */
+size_t ContractState::size() const {
+    return m_size;
+}
+
+/**
+ * Computes the checksum of a state file record
+ */
+static uint64_t recordChecksum(const uint8_t* data, size_t size) {
+    crypto::hash hash;
+    crypto::cn_fast_hash(data, size, hash);
+
+    uint64_t checksum;
+    std::memcpy(&checksum, &hash, sizeof(checksum));
+    return checksum;
+}
+
+/**
+ * Constructor
+ */
+StateFile::StateFile()
+    : m_file(nullptr) {
+}
+
+/**
+ * Destructor - closes the file
+ */
+StateFile::~StateFile() {
+    close();
+}
+
+/**
+ * Opens a state file, creating it if needed, and replays it
+ *
+ * A record is an entry count, a payload size, the payload of key length,
+ * key and value of each entry, and a checksum of all of these.
+ */
+bool StateFile::open(const std::string& path, ContractState& state) {
+    close();
+    state = ContractState();
+
+    size_t validSize = 0;
+    size_t recordCount = 0;
+    if (std::filesystem::exists(path)) {
+        MappedFile file;
+        if (!file.open(path)) {
+            Logger::getInstance().error("Failed to read contract state file: " + path);
+            return false;
+        }
+
+        const uint8_t* data = file.data();
+        size_t size = file.size();
+        while (true) {
+            uint32_t entryCount;
+            uint32_t payloadSize;
+            const size_t headerSize = sizeof(entryCount) + sizeof(payloadSize);
+            if (size - validSize < headerSize) {
+                break;
+            }
+            const uint8_t* record = data + validSize;
+            std::memcpy(&entryCount, record, sizeof(entryCount));
+            std::memcpy(&payloadSize, record + sizeof(entryCount), sizeof(payloadSize));
+            if (size - validSize - headerSize < static_cast<size_t>(payloadSize) + sizeof(uint64_t)) {
+                break;
+            }
+
+            uint64_t checksum;
+            std::memcpy(&checksum, record + headerSize + payloadSize, sizeof(checksum));
+            if (checksum != recordChecksum(record, headerSize + payloadSize)) {
+                break;
+            }
+
+            // Parse the entries, treating a malformed payload like a torn record
+            StateDiff diff;
+            const uint8_t* entry = record + headerSize;
+            const uint8_t* end = entry + payloadSize;
+            bool valid = true;
+            for (uint32_t i = 0; valid && i < entryCount; ++i) {
+                uint32_t keySize;
+                int64_t value;
+                valid = static_cast<size_t>(end - entry) >= sizeof(keySize);
+                if (valid) {
+                    std::memcpy(&keySize, entry, sizeof(keySize));
+                    entry += sizeof(keySize);
+                    valid = static_cast<size_t>(end - entry) >= static_cast<size_t>(keySize) + sizeof(value);
+                }
+                if (valid) {
+                    std::string key(reinterpret_cast<const char*>(entry), keySize);
+                    std::memcpy(&value, entry + keySize, sizeof(value));
+                    entry += keySize + sizeof(value);
+                    diff.emplace_back(std::move(key), value);
+                }
+            }
+            if (!valid || entry != end) {
+                break;
+            }
+
+            state.apply(diff);
+            validSize += headerSize + payloadSize + sizeof(checksum);
+            ++recordCount;
+        }
+
+        if (size > validSize) {
+            Logger::getInstance().warning("Discarding " + std::to_string(size - validSize) +
+                                          " bytes of incomplete records at the end of " + path);
+            file.close();
+            std::error_code ec;
+            std::filesystem::resize_file(path, validSize, ec);
+            if (ec) {
+                Logger::getInstance().error("Failed to truncate contract state file: " + ec.message());
+                return false;
+            }
+        }
+    }
+    state.takeDiff();
+
+    m_file = std::fopen(path.c_str(), "ab");
+    if (!m_file) {
+        Logger::getInstance().error("Failed to open contract state file for writing: " + path);
+        return false;
+    }
+    syncDirectory(path);
+    m_path = path;
+
+    Logger::getInstance().info("Loaded " + std::to_string(state.size()) + " contract state values from " +
+                               std::to_string(recordCount) + " records in " + path);
+    return true;
+}
+
+/**
+ * Closes the file
+ */
+void StateFile::close() {
+    if (m_file) {
+        std::fclose(m_file);
+        m_file = nullptr;
+    }
+}
+
+/**
+ * Checks whether a file is open
+ */
+bool StateFile::isOpen() const {
+    return m_file != nullptr;
+}
+
+/**
+ * Durably appends a diff
+ */
+bool StateFile::append(const StateDiff& diff) {
+    if (!m_file) {
+        return false;
+    }
+    if (diff.empty()) {
+        return true;
+    }
+
+    std::vector<uint8_t> record(2 * sizeof(uint32_t));
+    for (const auto& write : diff) {
+        uint32_t keySize = static_cast<uint32_t>(write.first.size());
+        const uint8_t* keySizeBytes = reinterpret_cast<const uint8_t*>(&keySize);
+        const uint8_t* valueBytes = reinterpret_cast<const uint8_t*>(&write.second);
+        record.insert(record.end(), keySizeBytes, keySizeBytes + sizeof(keySize));
+        record.insert(record.end(), write.first.begin(), write.first.end());
+        record.insert(record.end(), valueBytes, valueBytes + sizeof(write.second));
+    }
+
+    uint32_t entryCount = static_cast<uint32_t>(diff.size());
+    uint32_t payloadSize = static_cast<uint32_t>(record.size() - 2 * sizeof(uint32_t));
+    std::memcpy(record.data(), &entryCount, sizeof(entryCount));
+    std::memcpy(record.data() + sizeof(entryCount), &payloadSize, sizeof(payloadSize));
+
+    uint64_t checksum = recordChecksum(record.data(), record.size());
+    const uint8_t* checksumBytes = reinterpret_cast<const uint8_t*>(&checksum);
+    record.insert(record.end(), checksumBytes, checksumBytes + sizeof(checksum));
+
+    if (!writeAll(m_file, record.data(), record.size()) || !syncFile(m_file)) {
+        // Stop appending after a partial write; reopening discards it
+        Logger::getInstance().error("Failed to write contract state file: " + m_path);
+        close();
+        return false;
+    }
+    return true;
+}
+
+} // namespace lumina
@@ -10,9 +10,11 @@
 
 #include "contract/executor.h"
 #include "utils/logger.h"
-#include <fstream>
-#include <sstream>
+#include "utils/config.h"
+#include "utils/mapped_file.h"
 #include <iostream>
+#include <cerrno>
+#include <cstdlib>
 
 namespace lumina {
 
@@ -20,7 +22,22 @@ namespace lumina {
  * Constructor
  */
 ContractExecutor::ContractExecutor(const std::string& walletAddress)
-    : m_walletAddress(walletAddress) {
+    : m_walletAddress(walletAddress),
+      m_gasLimit(CONTRACT_DEFAULT_GAS_LIMIT) {
+    
+    // Compiled contracts are kept on disk too if a cache directory is configured
+    Config& config = Config::getInstance();
+    int cacheSize = config.getInt("contract_cache_size", static_cast<int>(CONTRACT_CACHE_DEFAULT_CAPACITY));
+    m_cache.setCapacity(cacheSize > 0 ? static_cast<size_t>(cacheSize) : 1);
+    m_cache.setDirectory(config.getString("contract_cache_dir"));
+    
+    // Contract state survives restarts if a state file is configured
+    std::string statePath = config.getString("contract_state_file");
+    if (!statePath.empty()) {
+        m_stateFile.open(statePath, m_state);
+    }
+    
+    setTraceFile(config.getString("contract_trace_file"));
     
     Logger::getInstance().info("Contract executor initialized for wallet: " + walletAddress);
 }
@@ -38,37 +55,83 @@ ContractExecutor::~ContractExecutor() {
 ContractResult ContractExecutor::executeFromFile(const std::string& filePath) {
     Logger::getInstance().info("Executing contract from file: " + filePath);
     
-    // Read contract file
-    std::ifstream file(filePath);
-    if (!file) {
+    // Map the contract file; the mapping outlives the execution below
+    MappedFile file;
+    if (!file.open(filePath)) {
         Logger::getInstance().error("Failed to open contract file: " + filePath);
         return { false, "Failed to open contract file", "" };
     }
     
-    // Read file content into a string
-    std::stringstream buffer;
-    buffer << file.rdbuf();
-    std::string contractCode = buffer.str();
-    
     // Execute the contract
-    return executeFromString(contractCode);
+    return executeFromString(std::string_view(reinterpret_cast<const char*>(file.data()), file.size()));
 }
 
 /**
  * Executes a smart contract from a string
  */
-ContractResult ContractExecutor::executeFromString(const std::string& contractCode) {
-    // Validate the contract
-    if (!validateContract(contractCode)) {
-        Logger::getInstance().error("Contract validation failed");
-        return { false, "Contract validation failed", "" };
+ContractResult ContractExecutor::executeFromString(std::string_view contractCode) {
+    std::string error;
+    std::shared_ptr<const CompiledContract> contract = loadContract(contractCode, error);
+    if (!contract) {
+        return { false, error, "" };
     }
     
-    // Preprocess the contract
-    std::string processedCode = preprocessContract(contractCode);
-    
     // Interpret and execute the contract
-    return interpretContract(processedCode);
+    return interpretContract(*contract);
+}
+
+/**
+ * Executes a batch of contracts
+ */
+std::vector<ContractResult> ContractExecutor::executeBatch(const std::vector<ContractInvocation>& invocations) {
+    std::vector<ContractResult> results(invocations.size(), ContractResult{ false, "", "" });
+    std::vector<ContractCall> calls;
+    std::vector<size_t> callInvocations;    // Invocation of each call
+    calls.reserve(invocations.size());
+    callInvocations.reserve(invocations.size());
+    
+    // Compile the contracts and bind their parameters, mostly from the cache
+    for (size_t i = 0; i < invocations.size(); ++i) {
+        std::string error;
+        std::shared_ptr<const CompiledContract> contract = loadContract(invocations[i].contractCode, error);
+        int mainIndex = contract ? contract->findFunction("main") : -1;
+        if (contract && mainIndex < 0) {
+            error = "Contract has no main function";
+        }
+        
+        ContractCall call;
+        if (mainIndex < 0 ||
+            !buildArguments(contract->functions[mainIndex], invocations[i].parameters, call.args, error)) {
+            results[i].message = error;
+            continue;
+        }
+        call.contract = contract;
+        call.functionIndex = static_cast<size_t>(mainIndex);
+        calls.push_back(std::move(call));
+        callInvocations.push_back(i);
+    }
+    
+    // The batch runs on a fork of the state, committed as one diff
+    size_t reexecuted = 0;
+    ContractState batchState = m_state.fork();
+    std::vector<ExecutionResult> executions = ParallelExecutor::execute(calls, m_gasLimit, batchState, &reexecuted);
+    commitState(batchState);
+    
+    for (size_t i = 0; i < executions.size(); ++i) {
+        const ExecutionResult& execution = executions[i];
+        ContractResult& result = results[callInvocations[i]];
+        result.success = execution.success;
+        result.message = execution.success
+            ? "Contract returned " + std::to_string(execution.value) + " (gas used: " +
+                  std::to_string(execution.gasUsed) + ")"
+            : "Contract execution failed: " + execution.error;
+        result.value = execution.value;
+        result.gasUsed = execution.gasUsed;
+    }
+    
+    LUMINA_LOG_INFO("Executed batch of ", invocations.size(), " contracts (", reexecuted,
+                    " re-executed after conflicts)");
+    return results;
 }
 
 /**
@@ -76,23 +139,58 @@ ContractResult ContractExecutor::executeFromString(const std::string& contractCo
  */
 void ContractExecutor::setParameter(const std::string& name, const std::string& value) {
     m_parameters[name] = value;
-    Logger::getInstance().debug("Set contract parameter: " + name + " = " + value);
+    LUMINA_LOG_DEBUG("Set contract parameter: ", name, " = ", value);
+}
+
+/**
+ * Sets the gas limit of contract executions
+ */
+void ContractExecutor::setGasLimit(uint64_t gasLimit) {
+    m_gasLimit = gasLimit;
+}
+
+/**
+ * Enables or disables tracing of contract executions
+ */
+void ContractExecutor::setTraceFile(const std::string& filePath) {
+    m_traceFile = filePath;
+    m_tracer.clear();
+    if (!filePath.empty()) {
+        Logger::getInstance().info("Tracing contract executions to " + filePath);
+    }
 }
 
 /**
  * Gets the gas cost estimate for executing a contract
  */
-double ContractExecutor::estimateGasCost(const std::string& contractCode) {
-    // TODO: Implement proper gas cost estimation
+Amount ContractExecutor::estimateGasCost(std::string_view contractCode) {
+    std::string error;
+    std::shared_ptr<const CompiledContract> contract = loadContract(contractCode, error);
+    int mainIndex = contract ? contract->findFunction("main") : -1;
+    if (mainIndex < 0) {
+        Logger::getInstance().error("Cannot estimate gas: " + (contract ? "contract has no main function" : error));
+        return Amount();
+    }
+    
+    // Missing parameters only matter if the estimate needs a dry run
+    std::vector<int64_t> args;
+    buildArguments(contract->functions[mainIndex], m_parameters, args, error);
     
-    // For now, just return a simple estimate based on code length
-    return 0.001 * (contractCode.length() / 1000.0);
+    GasEstimate estimate = m_gasEstimator.estimate(*contract, mainIndex, args, m_gasLimit, m_state);
+    LUMINA_LOG_DEBUG("Estimated ", estimate.gas, " gas for contract ", contract->name,
+                     estimate.isUpperBound ? " (static bound)" : estimate.reachedLimit ? " (gas limit)" : " (dry run)");
+    
+    Amount cost;
+    if (!Amount(CONTRACT_GAS_PRICE).checkedMul(estimate.gas, cost)) {
+        cost = Amount(UINT64_MAX);
+    }
+    return cost;
 }
 
 /**
  * Validates a contract
  */
-bool ContractExecutor::validateContract(const std::string& contractCode) {
+bool ContractExecutor::validateContract(std::string_view contractCode) {
     // TODO: Implement proper contract validation
     
     // For now, just check if the contract is not empty and has some basic structure
@@ -102,7 +200,7 @@ bool ContractExecutor::validateContract(const std::string& contractCode) {
     }
     
     // Check for basic contract structure (placeholder)
-    if (contractCode.find("contract") == std::string::npos) {
+    if (contractCode.find("contract") == std::string_view::npos) {
         Logger::getInstance().error("Contract does not contain 'contract' keyword");
         return false;
     }
@@ -111,29 +209,144 @@ bool ContractExecutor::validateContract(const std::string& contractCode) {
 }
 
 /**
- * Preprocesses a contract
+ * Compiles a contract to bytecode
  */
-std::string ContractExecutor::preprocessContract(const std::string& contractCode) {
-    // TODO: Implement proper contract preprocessing
+bool ContractExecutor::preprocessContract(std::string_view contractCode, CompiledContract& contract) {
+    if (!m_compiler.compile(contractCode, contract)) {
+        Logger::getInstance().error("Contract compilation failed: " + m_compiler.getError());
+        return false;
+    }
     
-    // For now, just return the original code
-    return contractCode;
+    return true;
 }
 
 /**
- * Interprets and executes a contract
+ * Gets the compiled form of a contract, validating and compiling it unless it is cached
  */
-ContractResult ContractExecutor::interpretContract(const std::string& processedCode) {
-    // TODO: Implement proper contract interpretation and execution
+std::shared_ptr<const CompiledContract> ContractExecutor::loadContract(std::string_view contractCode,
+                                                                       std::string& error) {
+    // Contracts compiled before skip validation and compilation
+    crypto::hash sourceHash = ContractCache::hashSource(contractCode);
+    std::shared_ptr<const CompiledContract> cached = m_cache.find(sourceHash);
+    if (cached) {
+        return cached;
+    }
     
-    Logger::getInstance().info("Executing contract (simulation mode)");
+    // Validate the contract
+    if (!validateContract(contractCode)) {
+        Logger::getInstance().error("Contract validation failed");
+        error = "Contract validation failed";
+        return nullptr;
+    }
+    
+    // Compile the contract
+    auto contract = std::make_shared<CompiledContract>();
+    if (!preprocessContract(contractCode, *contract)) {
+        error = "Contract compilation failed: " + m_compiler.getError();
+        return nullptr;
+    }
+    m_cache.insert(sourceHash, contract);
+    return contract;
+}
+
+/**
+ * Takes the arguments of a function from the contract parameters with the same names
+ */
+bool ContractExecutor::buildArguments(const CompiledFunction& function,
+                                      const std::map<std::string, std::string>& parameters,
+                                      std::vector<int64_t>& args, std::string& error) {
+    args.clear();
+    args.reserve(function.params.size());
+    for (const std::string& param : function.params) {
+        auto it = parameters.find(param);
+        if (it == parameters.end()) {
+            error = "Missing contract parameter: " + param;
+            return false;
+        }
+        
+        const char* text = it->second.c_str();
+        char* end = nullptr;
+        errno = 0;
+        long long value = std::strtoll(text, &end, 10);
+        if (end == text || *end != '\0' || errno == ERANGE) {
+            error = "Contract parameter is not an integer: " + param;
+            return false;
+        }
+        args.push_back(value);
+    }
+    
+    return true;
+}
+
+/**
+ * Runs the main function of a compiled contract
+ */
+ContractResult ContractExecutor::interpretContract(const CompiledContract& contract) {
+    int mainIndex = contract.findFunction("main");
+    if (mainIndex < 0) {
+        Logger::getInstance().error("Contract " + contract.name + " has no main function");
+        return { false, "Contract has no main function", "" };
+    }
     
-    // For now, just simulate a successful execution
-    return {
+    // The parameters of main are taken from the contract parameters by name
+    std::vector<int64_t> args;
+    std::string error;
+    if (!buildArguments(contract.functions[mainIndex], m_parameters, args, error)) {
+        Logger::getInstance().error(error);
+        return { false, error, "" };
+    }
+    
+    Logger::getInstance().info("Executing contract " + contract.name);
+    
+    // Run on a fork so that a failed run leaves no writes behind
+    ContractState runState = m_state.fork();
+    ExecutionResult execution;
+    if (m_traceFile.empty()) {
+        execution = m_vm.execute(contract, mainIndex, args, m_gasLimit, runState);
+    } else {
+        execution = m_vm.execute(contract, mainIndex, args, m_gasLimit, runState, m_tracer);
+        writeTrace();
+    }
+    if (!execution.success) {
+        Logger::getInstance().error("Contract execution failed: " + execution.error);
+        ContractResult result = { false, "Contract execution failed: " + execution.error, "" };
+        result.gasUsed = execution.gasUsed;
+        return result;
+    }
+    
+    commitState(runState);
+    
+    ContractResult result = {
         true,
-        "Contract executed successfully (simulation mode)",
-        "TX-" + m_walletAddress.substr(0, 8) + "-CONTRACT"
+        "Contract returned " + std::to_string(execution.value) + " (gas used: " +
+            std::to_string(execution.gasUsed) + ")",
+        ""
     };
+    result.value = execution.value;
+    result.gasUsed = execution.gasUsed;
+    return result;
+}
+
+/**
+ * Writes the trace profile
+ */
+void ContractExecutor::writeTrace() {
+    if (m_tracer.writeFoldedStacks(m_traceFile, TraceWeight::GAS) &&
+        m_tracer.writeFoldedStacks(m_traceFile + ".cycles", TraceWeight::CYCLES) &&
+        m_tracer.writeReport(m_traceFile + ".report")) {
+        LUMINA_LOG_DEBUG("Wrote contract trace to ", m_traceFile);
+    }
+}
+
+/**
+ * Makes a fork of the state current and persists its writes
+ */
+void ContractExecutor::commitState(ContractState& state) {
+    StateDiff diff = state.takeDiff();
+    m_state = state;
+    if (m_stateFile.isOpen() && !m_stateFile.append(diff)) {
+        Logger::getInstance().error("Contract state changes were not persisted");
+    }
 }
 
 } // namespace lumina
\ No newline at end of file
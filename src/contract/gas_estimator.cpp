@@ -0,0 +1,404 @@
+/**
+ * LuminaChain Wallet - Contract Gas Estimator Implementation
+ *
+ * This file implements the GasEstimator class which estimates the gas a
+ * compiled Lumina smart contract uses.
+ *
+ * Copyright (c) 2023 LuminaChain Development Team
+ * Licensed under MIT License
+ */
+
+#include "contract/gas_estimator.h"
+#include <algorithm>
+#include <map>
+
+namespace lumina {
+
+// Analysis state of each function
+enum FunctionState : uint8_t {
+    FUNCTION_UNVISITED,
+    FUNCTION_IN_PROGRESS,
+    FUNCTION_BOUNDED,
+    FUNCTION_UNBOUNDED
+};
+
+const size_t NO_BLOCK = SIZE_MAX;
+
+/**
+ * Adds gas amounts, saturating instead of overflowing
+ */
+static uint64_t saturatingAdd(uint64_t a, uint64_t b) {
+    return a > UINT64_MAX - b ? UINT64_MAX : a + b;
+}
+
+/**
+ * Multiplies gas amounts, saturating instead of overflowing
+ */
+static uint64_t saturatingMul(uint64_t a, uint64_t b) {
+    return b != 0 && a > UINT64_MAX / b ? UINT64_MAX : a * b;
+}
+
+/**
+ * Checks whether an instruction writes a register of the current frame
+ */
+static bool writesRegister(const Instruction& ins, size_t reg) {
+    switch (ins.op) {
+        case Opcode::GAS:
+        case Opcode::JMP:
+        case Opcode::JMPIF:
+        case Opcode::JMPIFNOT:
+        case Opcode::FORPREP:
+        case Opcode::RET:
+        case Opcode::SSTORE:
+        case Opcode::SSTOREX:
+            return false;
+        case Opcode::CALL:
+            // The result register and the callee's frame above it
+            return reg >= ins.a;
+        default:
+            return ins.a == reg;
+    }
+}
+
+/**
+ * The control-flow graph of a function over the basic blocks delimited by
+ * its GAS instructions
+ */
+struct FlowGraph {
+    std::vector<size_t> starts;                     // First instruction of each block
+    std::vector<size_t> ends;                       // One past the last instruction of each block
+    std::vector<uint64_t> costs;                    // Gas of each block, including calls
+    std::vector<std::vector<size_t>> successors;
+    std::vector<std::vector<size_t>> predecessors;
+};
+
+/**
+ * The longest path search over a region of a graph whose loops are
+ * partly collapsed into their headers
+ */
+struct PathSearch {
+    const FlowGraph& graph;
+    const std::vector<size_t>& rep;                     // Collapsed node of each block
+    const std::vector<std::vector<size_t>>& members;    // Blocks of each collapsed node
+    const std::vector<uint64_t>& nodeCosts;             // Gas of each collapsed node
+    const std::vector<char>& region;                    // Blocks the path may use
+    size_t head;                                        // Loop header that ends an iteration, or NO_BLOCK
+    std::vector<uint64_t> memo;
+    std::vector<char> visiting;
+    bool cyclic = false;
+
+    // Gets the gas of the most expensive path starting at a node
+    uint64_t longestFrom(size_t node) {
+        if (visiting[node]) {
+            cyclic = true;
+            return 0;
+        }
+        if (memo[node] != UINT64_MAX) {
+            return memo[node];
+        }
+
+        visiting[node] = 1;
+        uint64_t best = 0;
+        for (size_t block : members[node]) {
+            for (size_t next : graph.successors[block]) {
+                if (!region[next] || next == head || rep[next] == node) {
+                    continue;
+                }
+                best = std::max(best, longestFrom(rep[next]));
+            }
+        }
+        visiting[node] = 0;
+
+        memo[node] = saturatingAdd(nodeCosts[node], best);
+        return memo[node];
+    }
+};
+
+/**
+ * Counts the iterations of a for loop with constant bounds
+ *
+ * The compiler sets the counter and limit in the block ending in FORPREP
+ * just before the loop body, and closes the body with FORLOOP.
+ */
+static bool constantIterations(const CompiledContract& contract, const CompiledFunction& function,
+                               const FlowGraph& graph, size_t head, size_t tail,
+                               const std::vector<char>& body, uint64_t& iterations) {
+    const std::vector<Instruction>& code = function.code;
+    const Instruction& loop = code[graph.ends[tail] - 1];
+    if (loop.op != Opcode::FORLOOP || head == 0) {
+        return false;
+    }
+    size_t counter = loop.a;
+
+    size_t prep = head - 1;
+    const Instruction& prepare = code[graph.ends[prep] - 1];
+    if (prepare.op != Opcode::FORPREP || prepare.a != counter) {
+        return false;
+    }
+
+    // Find the values last written to the counter and limit before FORPREP
+    bool known[2] = {false, false};
+    int64_t values[2] = {0, 0};
+    for (size_t pc = graph.starts[prep] + 1; pc + 1 < graph.ends[prep]; ++pc) {
+        const Instruction& ins = code[pc];
+        for (size_t i = 0; i < 2; ++i) {
+            if (!writesRegister(ins, counter + i)) {
+                continue;
+            }
+            known[i] = ins.op == Opcode::LOADI || ins.op == Opcode::LOADK;
+            values[i] = ins.op == Opcode::LOADI ? ins.sbx() : ins.op == Opcode::LOADK ? contract.constants[ins.bx()] : 0;
+        }
+    }
+    if (!known[0] || !known[1]) {
+        return false;
+    }
+
+    // The body must not change the counter or limit
+    for (size_t block = 0; block < body.size(); ++block) {
+        if (!body[block]) {
+            continue;
+        }
+        for (size_t pc = graph.starts[block] + 1; pc < graph.ends[block]; ++pc) {
+            if (block == tail && pc + 1 == graph.ends[block]) {
+                continue;
+            }
+            if (writesRegister(code[pc], counter) || writesRegister(code[pc], counter + 1)) {
+                return false;
+            }
+        }
+    }
+
+    int64_t start = values[0];
+    int64_t limit = values[1];
+    iterations = limit > start ? static_cast<uint64_t>(limit) - static_cast<uint64_t>(start) : 0;
+    return true;
+}
+
+/**
+ * Computes the bound of a function, bounding its callees first
+ */
+static bool functionBound(const CompiledContract& contract, size_t index,
+                          std::vector<uint8_t>& states, std::vector<uint64_t>& bounds) {
+    const CompiledFunction& function = contract.functions[index];
+    const std::vector<Instruction>& code = function.code;
+    states[index] = FUNCTION_IN_PROGRESS;
+
+    auto unbounded = [&]() {
+        states[index] = FUNCTION_UNBOUNDED;
+        return false;
+    };
+
+    // Split the code into blocks at its GAS instructions
+    FlowGraph graph;
+    std::vector<size_t> blockOf(code.size(), NO_BLOCK);
+    for (size_t pc = 0; pc < code.size(); ++pc) {
+        if (code[pc].op == Opcode::GAS) {
+            if (!graph.starts.empty()) {
+                graph.ends.push_back(pc);
+            }
+            graph.starts.push_back(pc);
+        }
+        blockOf[pc] = graph.starts.empty() ? NO_BLOCK : graph.starts.size() - 1;
+    }
+    if (graph.starts.empty() || graph.starts[0] != 0) {
+        return unbounded();
+    }
+    graph.ends.push_back(code.size());
+
+    size_t blockCount = graph.starts.size();
+    graph.costs.resize(blockCount);
+    graph.successors.resize(blockCount);
+    graph.predecessors.resize(blockCount);
+
+    for (size_t block = 0; block < blockCount; ++block) {
+        uint64_t cost = code[graph.starts[block]].bx();
+        for (size_t pc = graph.starts[block] + 1; pc < graph.ends[block]; ++pc) {
+            if (code[pc].op != Opcode::CALL) {
+                continue;
+            }
+            size_t callee = code[pc].b;
+            if (states[callee] == FUNCTION_UNVISITED) {
+                functionBound(contract, callee, states, bounds);
+            }
+            if (states[callee] != FUNCTION_BOUNDED) {
+                return unbounded();
+            }
+            cost = saturatingAdd(cost, bounds[callee]);
+        }
+        graph.costs[block] = cost;
+
+        const Instruction& last = code[graph.ends[block] - 1];
+        size_t fallthrough = block + 1 < blockCount ? block + 1 : NO_BLOCK;
+        size_t target = NO_BLOCK;
+        switch (last.op) {
+            case Opcode::RET:
+                fallthrough = NO_BLOCK;
+                break;
+            case Opcode::JMP:
+                fallthrough = NO_BLOCK;
+                target = blockOf[graph.ends[block] + last.sbx()];
+                break;
+            case Opcode::JMPIF:
+            case Opcode::JMPIFNOT:
+            case Opcode::FORPREP:
+            case Opcode::FORLOOP:
+                target = blockOf[graph.ends[block] + last.sbx()];
+                break;
+            default:
+                break;
+        }
+        for (size_t next : {target, fallthrough}) {
+            if (next != NO_BLOCK) {
+                graph.successors[block].push_back(next);
+                graph.predecessors[next].push_back(block);
+            }
+        }
+    }
+
+    // Find the back edges with a depth-first search from the entry
+    std::map<size_t, std::vector<size_t>> loopTails;    // Tails of the back edges to each header
+    std::vector<uint8_t> color(blockCount, 0);
+    std::vector<std::pair<size_t, size_t>> stack = {{0, 0}};
+    color[0] = 1;
+    while (!stack.empty()) {
+        size_t node = stack.back().first;
+        size_t& nextIndex = stack.back().second;
+        if (nextIndex == graph.successors[node].size()) {
+            color[node] = 2;
+            stack.pop_back();
+            continue;
+        }
+        size_t next = graph.successors[node][nextIndex++];
+        if (color[next] == 1) {
+            loopTails[next].push_back(node);
+        } else if (color[next] == 0) {
+            color[next] = 1;
+            stack.push_back({next, 0});
+        }
+    }
+
+    // Collect each loop body: the blocks that reach a tail without passing the header
+    struct Loop {
+        size_t head;
+        std::vector<size_t> tails;
+        std::vector<char> body;
+        size_t size;
+    };
+    std::vector<Loop> loops;
+    for (const auto& entry : loopTails) {
+        Loop loop{entry.first, entry.second, std::vector<char>(blockCount, 0), 1};
+        loop.body[loop.head] = 1;
+        std::vector<size_t> work(loop.tails.begin(), loop.tails.end());
+        while (!work.empty()) {
+            size_t block = work.back();
+            work.pop_back();
+            if (loop.body[block]) {
+                continue;
+            }
+            loop.body[block] = 1;
+            ++loop.size;
+            work.insert(work.end(), graph.predecessors[block].begin(), graph.predecessors[block].end());
+        }
+        loops.push_back(std::move(loop));
+    }
+
+    // Collapse loops into their headers, innermost first
+    std::sort(loops.begin(), loops.end(), [](const Loop& a, const Loop& b) { return a.size < b.size; });
+
+    std::vector<size_t> rep(blockCount);
+    std::vector<std::vector<size_t>> members(blockCount);
+    std::vector<uint64_t> nodeCosts = graph.costs;
+    for (size_t block = 0; block < blockCount; ++block) {
+        rep[block] = block;
+        members[block].push_back(block);
+    }
+
+    for (const Loop& loop : loops) {
+        uint64_t iterations;
+        if (loop.tails.size() != 1 ||
+            !constantIterations(contract, function, graph, loop.head, loop.tails[0], loop.body, iterations)) {
+            return unbounded();
+        }
+
+        PathSearch search{graph, rep, members, nodeCosts, loop.body, loop.head,
+                          std::vector<uint64_t>(blockCount, UINT64_MAX), std::vector<char>(blockCount, 0)};
+        uint64_t iterationCost = search.longestFrom(rep[loop.head]);
+        if (search.cyclic) {
+            return unbounded();
+        }
+
+        std::vector<size_t> merged;
+        for (size_t block = 0; block < blockCount; ++block) {
+            if (loop.body[block]) {
+                merged.push_back(block);
+                if (rep[block] != loop.head) {
+                    members[rep[block]].clear();
+                }
+                rep[block] = loop.head;
+            }
+        }
+        members[loop.head] = merged;
+        nodeCosts[loop.head] = saturatingMul(iterations, iterationCost);
+    }
+
+    // The most expensive path through what is left
+    std::vector<char> everything(blockCount, 1);
+    PathSearch search{graph, rep, members, nodeCosts, everything, NO_BLOCK,
+                      std::vector<uint64_t>(blockCount, UINT64_MAX), std::vector<char>(blockCount, 0)};
+    uint64_t bound = search.longestFrom(rep[0]);
+    if (search.cyclic || bound == UINT64_MAX) {
+        return unbounded();
+    }
+
+    bounds[index] = bound;
+    states[index] = FUNCTION_BOUNDED;
+    return true;
+}
+
+/**
+ * Computes a static upper bound on the gas of a function
+ */
+bool GasEstimator::computeBound(const CompiledContract& contract, size_t functionIndex, uint64_t& gas) {
+    if (functionIndex >= contract.functions.size()) {
+        return false;
+    }
+
+    std::vector<uint8_t> states(contract.functions.size(), FUNCTION_UNVISITED);
+    std::vector<uint64_t> bounds(contract.functions.size(), 0);
+    if (!functionBound(contract, functionIndex, states, bounds)) {
+        return false;
+    }
+
+    gas = bounds[functionIndex];
+    return true;
+}
+
+/**
+ * Estimates the gas of a function, dry-running it if it has no static bound
+ */
+GasEstimate GasEstimator::estimate(const CompiledContract& contract, size_t functionIndex,
+                                   const std::vector<int64_t>& args, uint64_t gasLimit, const ContractState& state) {
+    GasEstimate result;
+
+    uint64_t bound;
+    if (computeBound(contract, functionIndex, bound)) {
+        result.gas = bound;
+        result.isUpperBound = true;
+        return result;
+    }
+
+    // Without usable arguments the function cannot run, so assume it uses the whole limit
+    if (functionIndex >= contract.functions.size() || args.size() != contract.functions[functionIndex].paramCount) {
+        result.gas = gasLimit;
+        result.reachedLimit = true;
+        return result;
+    }
+
+    ContractState scratch = state.fork();
+    ExecutionResult run = m_vm.execute(contract, functionIndex, args, gasLimit, scratch);
+    result.gas = run.gasUsed;
+    result.reachedLimit = !run.success && run.gasUsed >= gasLimit;
+    return result;
+}
+
+} // namespace lumina
@@ -0,0 +1,158 @@
+/**
+ * LuminaChain Wallet - Parallel Contract Executor Implementation
+ *
+ * This file implements the ParallelExecutor class which runs batches of
+ * contract calls speculatively in parallel.
+ *
+ * Copyright (c) 2023 LuminaChain Development Team
+ * Licensed under MIT License
+ */
+
+#include "contract/parallel_executor.h"
+#include "utils/thread_pool.h"
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace lumina {
+
+/**
+ * Storage view of one call that records the keys it reads from the
+ * underlying storage and buffers its writes
+ */
+class RecordingStorage : public ContractStorage {
+public:
+    explicit RecordingStorage(ContractStorage& base)
+        : m_base(&base) {
+    }
+
+    int64_t load(const std::string& key) override {
+        auto it = m_writes.find(key);
+        if (it != m_writes.end()) {
+            return it->second;
+        }
+        m_reads.insert(key);
+        return m_base->load(key);
+    }
+
+    void store(const std::string& key, int64_t value) override {
+        m_writes[key] = value;
+    }
+
+    const std::unordered_set<std::string>& getReads() const { return m_reads; }
+    const std::unordered_map<std::string, int64_t>& getWrites() const { return m_writes; }
+
+private:
+    ContractStorage* m_base;
+    std::unordered_set<std::string> m_reads;
+    std::unordered_map<std::string, int64_t> m_writes;
+};
+
+/**
+ * Runs one call against a recording view of the storage
+ */
+static ExecutionResult runCall(ContractVM& vm, const ContractCall& call, uint64_t gasLimit, RecordingStorage& view) {
+    if (!call.contract) {
+        ExecutionResult result;
+        result.error = "No contract";
+        return result;
+    }
+    return vm.execute(*call.contract, call.functionIndex, call.args, gasLimit, view);
+}
+
+/**
+ * Runs a batch of calls, applying their writes to the storage in order
+ */
+std::vector<ExecutionResult> ParallelExecutor::execute(const std::vector<ContractCall>& calls, uint64_t gasLimit,
+                                                       ContractStorage& storage, size_t* reexecuted) {
+    std::vector<ExecutionResult> results(calls.size());
+    std::vector<RecordingStorage> views(calls.size(), RecordingStorage(storage));
+
+    // Number of calls committed when each call last ran
+    std::vector<size_t> snapshots(calls.size(), 0);
+
+    // Speculative phase: every call runs against the storage as it was before the batch
+    ThreadPool::getInstance().parallelFor(calls.size(), [&](size_t begin, size_t end) {
+        ContractVM vm;
+        for (size_t i = begin; i < end; ++i) {
+            results[i] = runCall(vm, calls[i], gasLimit, views[i]);
+        }
+    }, PARALLEL_EXECUTION_MIN_CHUNK);
+
+    // One plus the index of the last committed call that wrote each key
+    std::unordered_map<std::string, size_t> lastWriters;
+    auto isCurrent = [&](size_t i) {
+        for (const std::string& key : views[i].getReads()) {
+            auto it = lastWriters.find(key);
+            if (it != lastWriters.end() && it->second > snapshots[i]) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    // Commit phase: in batch order, running again the calls that read a key committed since they ran
+    std::vector<size_t> round;
+    size_t serialEnd = 0;
+    size_t serialLength = PARALLEL_EXECUTION_RERUN_WINDOW;
+    ContractVM vm;
+    size_t conflicts = 0;
+    for (size_t i = 0; i < calls.size(); ++i) {
+        if (!isCurrent(i)) {
+            // When most of the last round went stale again its calls depend on each other,
+            // so the next ones run serially, for longer each time in a row
+            if (!round.empty()) {
+                size_t committed = std::lower_bound(round.begin(), round.end(), i) - round.begin();
+                if (committed * 2 < round.size()) {
+                    serialEnd = i + serialLength;
+                    serialLength *= 2;
+                } else {
+                    serialLength = PARALLEL_EXECUTION_RERUN_WINDOW;
+                }
+            }
+
+            round.clear();
+            if (i >= serialEnd) {
+                size_t end = std::min(calls.size(), i + PARALLEL_EXECUTION_RERUN_WINDOW);
+                for (size_t j = i; j < end; ++j) {
+                    if (j == i || !isCurrent(j)) {
+                        round.push_back(j);
+                    }
+                }
+            }
+
+            if (round.size() >= PARALLEL_EXECUTION_MIN_RERUN) {
+                ThreadPool::getInstance().parallelFor(round.size(), [&](size_t begin, size_t end) {
+                    ContractVM roundVM;
+                    for (size_t k = begin; k < end; ++k) {
+                        size_t j = round[k];
+                        views[j] = RecordingStorage(storage);
+                        snapshots[j] = i;
+                        results[j] = runCall(roundVM, calls[j], gasLimit, views[j]);
+                    }
+                }, PARALLEL_EXECUTION_MIN_CHUNK);
+                conflicts += round.size();
+            } else {
+                round.clear();
+                views[i] = RecordingStorage(storage);
+                snapshots[i] = i;
+                results[i] = runCall(vm, calls[i], gasLimit, views[i]);
+                ++conflicts;
+            }
+        }
+
+        if (results[i].success) {
+            for (const auto& write : views[i].getWrites()) {
+                storage.store(write.first, write.second);
+                lastWriters[write.first] = i + 1;
+            }
+        }
+    }
+
+    if (reexecuted) {
+        *reexecuted = conflicts;
+    }
+    return results;
+}
+
+} // namespace lumina
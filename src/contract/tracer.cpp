@@ -0,0 +1,264 @@
+/**
+ * LuminaChain Wallet - Contract Tracer Implementation
+ *
+ * This file implements the ContractTracer class which profiles contract
+ * runs.
+ *
+ * Copyright (c) 2023 LuminaChain Development Team
+ * Licensed under MIT License
+ */
+
+#include "contract/tracer.h"
+#include "utils/logger.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace lumina {
+
+/**
+ * Reads the CPU cycle counter
+ */
+static uint64_t readCycles() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+/**
+ * Constructor
+ */
+ContractTracer::ContractTracer() {
+    clear();
+}
+
+/**
+ * Starts tracing a run
+ */
+void ContractTracer::beginRun(const CompiledContract& contract, size_t functionIndex) {
+    m_frames.clear();
+    m_frames.reserve(contract.functions.size());
+    for (const CompiledFunction& function : contract.functions) {
+        m_frames.push_back(contract.name + "." + function.name);
+    }
+
+    m_current = childStack(0, m_frames[functionIndex]);
+    ++m_stacks[m_current].profile.calls;
+    m_lastCycle = readCycles();
+}
+
+/**
+ * Finishes tracing a run, leaving every function it was in
+ */
+void ContractTracer::endRun() {
+    chargeCycles();
+    m_current = 0;
+}
+
+/**
+ * Records a call
+ */
+void ContractTracer::enterFunction(size_t functionIndex) {
+    chargeCycles();
+    m_current = childStack(m_current, m_frames[functionIndex]);
+    ++m_stacks[m_current].profile.calls;
+}
+
+/**
+ * Records a return
+ */
+void ContractTracer::exitFunction() {
+    chargeCycles();
+    m_current = m_stacks[m_current].parent;
+}
+
+/**
+ * Counts a storage load
+ */
+void ContractTracer::countLoad(const std::string& key) {
+    ++m_storage[key].loads;
+}
+
+/**
+ * Counts a storage store
+ */
+void ContractTracer::countStore(const std::string& key) {
+    ++m_storage[key].stores;
+}
+
+/**
+ * Gets the number of instructions executed with an opcode
+ */
+uint64_t ContractTracer::getOpcodeCount(Opcode opcode) const {
+    return m_opcodeCounts[static_cast<size_t>(opcode)];
+}
+
+/**
+ * Gets the profile of each call stack
+ */
+std::map<std::string, ContractTracer::StackProfile> ContractTracer::getStackProfiles() const {
+    std::map<std::string, StackProfile> profiles;
+    for (size_t i = 1; i < m_stacks.size(); ++i) {
+        profiles[stackName(i)] = m_stacks[i].profile;
+    }
+    return profiles;
+}
+
+/**
+ * Gets the accesses of each storage key
+ */
+const std::map<std::string, ContractTracer::StorageProfile>& ContractTracer::getStorageProfiles() const {
+    return m_storage;
+}
+
+/**
+ * Writes the profile as folded stacks
+ */
+bool ContractTracer::writeFoldedStacks(const std::string& path, TraceWeight weight) const {
+    std::ofstream file(path);
+    if (!file) {
+        Logger::getInstance().error("Failed to open trace file for writing: " + path);
+        return false;
+    }
+
+    for (size_t i = 1; i < m_stacks.size(); ++i) {
+        const StackProfile& profile = m_stacks[i].profile;
+        uint64_t value = weight == TraceWeight::GAS ? profile.gas : profile.cycles;
+        if (value > 0) {
+            file << stackName(i) << ' ' << value << '\n';
+        }
+    }
+
+    if (!file) {
+        Logger::getInstance().error("Failed to write trace file: " + path);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Writes a readable report of the profile
+ */
+bool ContractTracer::writeReport(const std::string& path) const {
+    std::ofstream file(path);
+    if (!file) {
+        Logger::getInstance().error("Failed to open trace report for writing: " + path);
+        return false;
+    }
+
+    // Opcodes, most executed first
+    uint64_t totalInstructions = 0;
+    std::vector<size_t> opcodes;
+    for (size_t i = 0; i < m_opcodeCounts.size(); ++i) {
+        totalInstructions += m_opcodeCounts[i];
+        if (m_opcodeCounts[i] > 0) {
+            opcodes.push_back(i);
+        }
+    }
+    std::stable_sort(opcodes.begin(), opcodes.end(), [this](size_t a, size_t b) {
+        return m_opcodeCounts[a] > m_opcodeCounts[b];
+    });
+
+    file << "Opcodes (" << totalInstructions << " instructions)\n";
+    for (size_t opcode : opcodes) {
+        double share = 100.0 * static_cast<double>(m_opcodeCounts[opcode]) / static_cast<double>(totalInstructions);
+        file << "  " << std::left << std::setw(10) << opcodeName(static_cast<Opcode>(opcode))
+             << std::right << std::setw(14) << m_opcodeCounts[opcode]
+             << std::setw(8) << std::fixed << std::setprecision(1) << share << "%\n";
+    }
+
+    // Functions, summed over the stacks they appear innermost in
+    std::map<std::string, StackProfile> functions;
+    for (size_t i = 1; i < m_stacks.size(); ++i) {
+        StackProfile& function = functions[m_stacks[i].frame];
+        function.gas += m_stacks[i].profile.gas;
+        function.cycles += m_stacks[i].profile.cycles;
+        function.calls += m_stacks[i].profile.calls;
+    }
+
+    file << "\nFunctions (self gas, self cycles, calls)\n";
+    for (const auto& function : functions) {
+        file << "  " << std::left << std::setw(32) << function.first << std::right
+             << std::setw(14) << function.second.gas
+             << std::setw(16) << function.second.cycles
+             << std::setw(10) << function.second.calls << '\n';
+    }
+
+    file << "\nStorage (loads, stores)\n";
+    for (const auto& key : m_storage) {
+        file << "  " << std::left << std::setw(32) << key.first << std::right
+             << std::setw(14) << key.second.loads
+             << std::setw(14) << key.second.stores << '\n';
+    }
+
+    if (!file) {
+        Logger::getInstance().error("Failed to write trace report: " + path);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Discards everything traced so far
+ */
+void ContractTracer::clear() {
+    m_opcodeCounts.assign(OPCODE_COUNT, 0);
+    m_stacks.assign(1, StackNode{"", 0, {}, {}});
+    m_storage.clear();
+    m_frames.clear();
+    m_current = 0;
+    m_lastCycle = 0;
+}
+
+/**
+ * Gets the node of a call from a stack, adding it if needed
+ */
+size_t ContractTracer::childStack(size_t parent, const std::string& frame) {
+    auto it = m_stacks[parent].children.find(frame);
+    if (it != m_stacks[parent].children.end()) {
+        return it->second;
+    }
+
+    size_t node = m_stacks.size();
+    m_stacks.push_back(StackNode{frame, parent, {}, {}});
+    m_stacks[parent].children.emplace(frame, node);
+    return node;
+}
+
+/**
+ * Gets the frames of a stack, outermost first, separated by ';'
+ */
+std::string ContractTracer::stackName(size_t node) const {
+    std::vector<size_t> path;
+    for (; node != 0; node = m_stacks[node].parent) {
+        path.push_back(node);
+    }
+
+    std::string name;
+    for (auto it = path.rbegin(); it != path.rend(); ++it) {
+        if (!name.empty()) {
+            name += ';';
+        }
+        name += m_stacks[*it].frame;
+    }
+    return name;
+}
+
+/**
+ * Charges the cycles since the last charge to the current stack
+ */
+void ContractTracer::chargeCycles() {
+    uint64_t now = readCycles();
+    m_stacks[m_current].profile.cycles += now - m_lastCycle;
+    m_lastCycle = now;
+}
+
+} // namespace lumina
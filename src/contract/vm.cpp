@@ -0,0 +1,334 @@
+/**
+ * LuminaChain Wallet - Contract Virtual Machine Implementation
+ *
+ * This file implements the ContractVM class which runs compiled Lumina
+ * smart contracts.
+ *
+ * Copyright (c) 2023 LuminaChain Development Team
+ * Licensed under MIT License
+ */
+
+#include "contract/vm.h"
+#include <algorithm>
+
+#if defined(__GNUC__) || defined(__clang__)
+#define LUMA_COMPUTED_GOTO 1
+#else
+#define LUMA_COMPUTED_GOTO 0
+#endif
+
+namespace lumina {
+
+/**
+ * Loads a value
+ */
+int64_t MemoryContractStorage::load(const std::string& key) {
+    auto it = m_values.find(key);
+    return it != m_values.end() ? it->second : 0;
+}
+
+/**
+ * Stores a value
+ */
+void MemoryContractStorage::store(const std::string& key, int64_t value) {
+    m_values[key] = value;
+}
+
+/**
+ * Builds the key of an indexed storage access
+ */
+static std::string indexedKey(const std::string& key, int64_t index) {
+    return key + "/" + std::to_string(index);
+}
+
+/**
+ * Runs a contract function
+ */
+ExecutionResult ContractVM::execute(const CompiledContract& contract, size_t functionIndex,
+                                    const std::vector<int64_t>& args, uint64_t gasLimit, ContractStorage& storage) {
+    return run<false>(contract, functionIndex, args, gasLimit, storage, nullptr);
+}
+
+/**
+ * Runs a contract function, profiling it
+ */
+ExecutionResult ContractVM::execute(const CompiledContract& contract, size_t functionIndex,
+                                    const std::vector<int64_t>& args, uint64_t gasLimit, ContractStorage& storage,
+                                    ContractTracer& tracer) {
+    return run<true>(contract, functionIndex, args, gasLimit, storage, &tracer);
+}
+
+/**
+ * Runs a contract function, with the tracing code compiled in only if Tracing is set
+ */
+template<bool Tracing>
+ExecutionResult ContractVM::run(const CompiledContract& contract, size_t functionIndex,
+                                const std::vector<int64_t>& args, uint64_t gasLimit, ContractStorage& storage,
+                                ContractTracer* tracer) {
+    ExecutionResult result;
+
+    if (functionIndex >= contract.functions.size()) {
+        result.error = "No such function";
+        return result;
+    }
+    const CompiledFunction* function = &contract.functions[functionIndex];
+    if (args.size() != function->paramCount) {
+        result.error = "Function '" + function->name + "' takes " + std::to_string(function->paramCount) +
+                       " arguments";
+        return result;
+    }
+
+    m_frames.clear();
+    m_registers.assign(std::max<size_t>(function->registerCount, 1), 0);
+    std::copy(args.begin(), args.end(), m_registers.begin());
+
+    const int64_t* constants = contract.constants.data();
+    const std::string* strings = contract.strings.data();
+    const Instruction* pc = function->code.data();
+    int64_t* R = m_registers.data();
+    uint64_t gasLeft = gasLimit;
+    uint64_t instructions = 0;
+    Instruction ins;
+
+    if constexpr (Tracing) {
+        tracer->beginRun(contract, functionIndex);
+    }
+
+#define VM_TRACE_INSTRUCTION() do { if constexpr (Tracing) { tracer->countInstruction(ins.op); } } while (0)
+#if LUMA_COMPUTED_GOTO
+    static const void* const dispatchTable[OPCODE_COUNT] = {
+#define LUMA_OPCODE_LABEL(name, cost) &&op_##name,
+        LUMA_OPCODES(LUMA_OPCODE_LABEL)
+#undef LUMA_OPCODE_LABEL
+    };
+#define VM_DISPATCH() do { ins = *pc++; VM_TRACE_INSTRUCTION(); goto *dispatchTable[static_cast<size_t>(ins.op)]; } while (0)
+#define VM_CASE(name) op_##name:
+    VM_DISPATCH();
+#else
+#define VM_DISPATCH() goto dispatch
+#define VM_CASE(name) case Opcode::name:
+dispatch:
+    ins = *pc++;
+    VM_TRACE_INSTRUCTION();
+    switch (ins.op) {
+#endif
+
+    VM_CASE(GAS) {
+        uint64_t cost = ins.bx();
+        if (cost > gasLeft) {
+            if constexpr (Tracing) {
+                tracer->chargeGas(gasLeft);
+            }
+            gasLeft = 0;
+            result.error = "Out of gas";
+            goto fail;
+        }
+        gasLeft -= cost;
+        instructions += ins.a;
+        if constexpr (Tracing) {
+            tracer->chargeGas(cost);
+        }
+        VM_DISPATCH();
+    }
+    VM_CASE(LOADI) {
+        R[ins.a] = ins.sbx();
+        VM_DISPATCH();
+    }
+    VM_CASE(LOADK) {
+        R[ins.a] = constants[ins.bx()];
+        VM_DISPATCH();
+    }
+    VM_CASE(MOVE) {
+        R[ins.a] = R[ins.b];
+        VM_DISPATCH();
+    }
+    VM_CASE(ADD) {
+        R[ins.a] = static_cast<int64_t>(static_cast<uint64_t>(R[ins.b]) + static_cast<uint64_t>(R[ins.c]));
+        VM_DISPATCH();
+    }
+    VM_CASE(SUB) {
+        R[ins.a] = static_cast<int64_t>(static_cast<uint64_t>(R[ins.b]) - static_cast<uint64_t>(R[ins.c]));
+        VM_DISPATCH();
+    }
+    VM_CASE(MUL) {
+        R[ins.a] = static_cast<int64_t>(static_cast<uint64_t>(R[ins.b]) * static_cast<uint64_t>(R[ins.c]));
+        VM_DISPATCH();
+    }
+    VM_CASE(DIV) {
+        int64_t divisor = R[ins.c];
+        if (divisor == 0) {
+            result.error = "Division by zero";
+            goto fail;
+        }
+        int64_t dividend = R[ins.b];
+        R[ins.a] = divisor == -1 ? static_cast<int64_t>(0 - static_cast<uint64_t>(dividend)) : dividend / divisor;
+        VM_DISPATCH();
+    }
+    VM_CASE(MOD) {
+        int64_t divisor = R[ins.c];
+        if (divisor == 0) {
+            result.error = "Division by zero";
+            goto fail;
+        }
+        R[ins.a] = divisor == -1 ? 0 : R[ins.b] % divisor;
+        VM_DISPATCH();
+    }
+    VM_CASE(NEG) {
+        R[ins.a] = static_cast<int64_t>(0 - static_cast<uint64_t>(R[ins.b]));
+        VM_DISPATCH();
+    }
+    VM_CASE(NOT) {
+        R[ins.a] = R[ins.b] == 0;
+        VM_DISPATCH();
+    }
+    VM_CASE(BOOL) {
+        R[ins.a] = R[ins.b] != 0;
+        VM_DISPATCH();
+    }
+    VM_CASE(EQ) {
+        R[ins.a] = R[ins.b] == R[ins.c];
+        VM_DISPATCH();
+    }
+    VM_CASE(NE) {
+        R[ins.a] = R[ins.b] != R[ins.c];
+        VM_DISPATCH();
+    }
+    VM_CASE(LT) {
+        R[ins.a] = R[ins.b] < R[ins.c];
+        VM_DISPATCH();
+    }
+    VM_CASE(LE) {
+        R[ins.a] = R[ins.b] <= R[ins.c];
+        VM_DISPATCH();
+    }
+    VM_CASE(JMP) {
+        pc += ins.sbx();
+        VM_DISPATCH();
+    }
+    VM_CASE(JMPIF) {
+        if (R[ins.a] != 0) {
+            pc += ins.sbx();
+        }
+        VM_DISPATCH();
+    }
+    VM_CASE(JMPIFNOT) {
+        if (R[ins.a] == 0) {
+            pc += ins.sbx();
+        }
+        VM_DISPATCH();
+    }
+    VM_CASE(FORPREP) {
+        if (!(R[ins.a] < R[ins.a + 1])) {
+            pc += ins.sbx();
+        }
+        VM_DISPATCH();
+    }
+    VM_CASE(FORLOOP) {
+        // The body may have set the counter to anything, so it wraps like ADD
+        R[ins.a] = static_cast<int64_t>(static_cast<uint64_t>(R[ins.a]) + 1);
+        if (R[ins.a] < R[ins.a + 1]) {
+            pc += ins.sbx();
+        }
+        VM_DISPATCH();
+    }
+    VM_CASE(CALL) {
+        const CompiledFunction* callee = &contract.functions[ins.b];
+        if (ins.c != callee->paramCount) {
+            result.error = "Wrong number of arguments to '" + callee->name + "'";
+            goto fail;
+        }
+        if (m_frames.size() >= MAX_CALL_DEPTH) {
+            result.error = "Call depth exceeded";
+            goto fail;
+        }
+
+        // The arguments in R[A+1] .. R[A+C] become the callee's parameters
+        size_t base = R - m_registers.data();
+        size_t calleeBase = base + ins.a + 1;
+        if (m_registers.size() < calleeBase + callee->registerCount) {
+            m_registers.resize(calleeBase + callee->registerCount);
+        }
+        m_frames.push_back({function, pc, base, ins.a});
+
+        function = callee;
+        R = m_registers.data() + calleeBase;
+        pc = callee->code.data();
+        if constexpr (Tracing) {
+            tracer->enterFunction(ins.b);
+        }
+        VM_DISPATCH();
+    }
+    VM_CASE(RET) {
+        int64_t value = R[ins.a];
+        if (m_frames.empty()) {
+            result.value = value;
+            goto done;
+        }
+
+        const Frame& frame = m_frames.back();
+        function = frame.function;
+        pc = frame.returnPc;
+        R = m_registers.data() + frame.base;
+        R[frame.resultRegister] = value;
+        m_frames.pop_back();
+        if constexpr (Tracing) {
+            tracer->exitFunction();
+        }
+        VM_DISPATCH();
+    }
+    VM_CASE(SLOAD) {
+        const std::string& key = strings[ins.bx()];
+        if constexpr (Tracing) {
+            tracer->countLoad(key);
+        }
+        R[ins.a] = storage.load(key);
+        VM_DISPATCH();
+    }
+    VM_CASE(SLOADX) {
+        std::string key = indexedKey(strings[ins.b], R[ins.c]);
+        if constexpr (Tracing) {
+            tracer->countLoad(key);
+        }
+        R[ins.a] = storage.load(key);
+        VM_DISPATCH();
+    }
+    VM_CASE(SSTORE) {
+        const std::string& key = strings[ins.bx()];
+        if constexpr (Tracing) {
+            tracer->countStore(key);
+        }
+        storage.store(key, R[ins.a]);
+        VM_DISPATCH();
+    }
+    VM_CASE(SSTOREX) {
+        std::string key = indexedKey(strings[ins.b], R[ins.c]);
+        if constexpr (Tracing) {
+            tracer->countStore(key);
+        }
+        storage.store(key, R[ins.a]);
+        VM_DISPATCH();
+    }
+
+#if !LUMA_COMPUTED_GOTO
+    default:
+        result.error = "Invalid opcode";
+        goto fail;
+    }
+#endif
+
+#undef VM_DISPATCH
+#undef VM_CASE
+#undef VM_TRACE_INSTRUCTION
+
+done:
+    result.success = true;
+fail:
+    if constexpr (Tracing) {
+        tracer->endRun();
+    }
+    result.gasUsed = gasLimit - gasLeft;
+    result.instructions = instructions;
+    return result;
+}
+
+} // namespace lumina
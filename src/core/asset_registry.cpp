@@ -0,0 +1,116 @@
+/**
+ * LuminaChain Wallet - Asset Registry Implementation
+ *
+ * This file implements the AssetRegistry class which interns token symbols
+ * into compact asset ids.
+ *
+ * Copyright (c) 2023 LuminaChain Development Team
+ * Licensed under MIT License
+ */
+
+#include "core/asset_registry.h"
+#include <functional>
+
+namespace lumina {
+
+/**
+ * Constructor
+ */
+AssetRegistry::AssetRegistry() : m_count(0) {
+    for (auto& slot : m_slots) {
+        slot.store(0, std::memory_order_relaxed);
+    }
+    intern("LMT");
+}
+
+/**
+ * Gets the singleton instance of the asset registry
+ */
+AssetRegistry& AssetRegistry::getInstance() {
+    static AssetRegistry instance;
+    return instance;
+}
+
+/**
+ * Gets the id of a symbol, registering it if needed
+ */
+AssetId AssetRegistry::intern(std::string_view symbol) {
+    AssetId id = find(symbol);
+    if (id != INVALID_ASSET_ID) {
+        return id;
+    }
+    if (symbol.empty() || symbol.size() > MAX_ASSET_SYMBOL_LENGTH) {
+        return INVALID_ASSET_ID;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    // Another thread may have registered the symbol in the meantime
+    id = find(symbol);
+    if (id != INVALID_ASSET_ID) {
+        return id;
+    }
+
+    size_t count = m_count.load(std::memory_order_relaxed);
+    if (count == MAX_ASSET_COUNT) {
+        return INVALID_ASSET_ID;
+    }
+
+    // The symbol is published before the slot that lets find reach it
+    id = static_cast<AssetId>(count);
+    m_symbols[id] = std::string(symbol);
+    m_count.store(count + 1, std::memory_order_release);
+
+    size_t slot = firstSlot(symbol);
+    while (m_slots[slot].load(std::memory_order_relaxed) != 0) {
+        slot = (slot + 1) & (SLOT_COUNT - 1);
+    }
+    m_slots[slot].store(id + 1, std::memory_order_release);
+
+    return id;
+}
+
+/**
+ * Looks up the id of a symbol without registering it
+ */
+AssetId AssetRegistry::find(std::string_view symbol) const {
+    size_t slot = firstSlot(symbol);
+    while (true) {
+        AssetId entry = m_slots[slot].load(std::memory_order_acquire);
+        if (entry == 0) {
+            return INVALID_ASSET_ID;
+        }
+        if (m_symbols[entry - 1] == symbol) {
+            return entry - 1;
+        }
+        slot = (slot + 1) & (SLOT_COUNT - 1);
+    }
+}
+
+/**
+ * Gets the symbol of an asset id
+ */
+const std::string& AssetRegistry::getSymbol(AssetId id) const {
+    static const std::string unknown;
+
+    if (id < m_count.load(std::memory_order_acquire)) {
+        return m_symbols[id];
+    }
+    return unknown;
+}
+
+/**
+ * Gets the number of registered assets
+ */
+size_t AssetRegistry::size() const {
+    return m_count.load(std::memory_order_acquire);
+}
+
+/**
+ * Gets the first hash table slot to probe for a symbol
+ */
+size_t AssetRegistry::firstSlot(std::string_view symbol) {
+    return std::hash<std::string_view>()(symbol) & (SLOT_COUNT - 1);
+}
+
+} // namespace lumina
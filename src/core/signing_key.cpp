@@ -0,0 +1,105 @@
+/**
+ * LuminaChain Wallet - Signing Key Implementation
+ *
+ * This file implements the SigningKey class which holds a wallet's
+ * transaction signing key together with the values precomputed from it.
+ *
+ * Copyright (c) 2023 LuminaChain Development Team
+ * Licensed under MIT License
+ */
+
+#include "core/signing_key.h"
+#include "memwipe.h"
+#include <cstring>
+
+namespace lumina {
+
+/**
+ * Gets the key that encrypts secret keys in memory, generated once per process
+ */
+static const crypto::chacha_key& memoryKey() {
+    static const crypto::chacha_key key = [] {
+        crypto::chacha_key generated;
+        crypto::rand(generated.size(), generated.data());
+        return generated;
+    }();
+    return key;
+}
+
+/**
+ * Constructor - Creates an unset key
+ */
+SigningKey::SigningKey()
+    : m_valid(false) {
+    clear();
+}
+
+/**
+ * Destructor - wipes the secret key
+ */
+SigningKey::~SigningKey() {
+    clear();
+}
+
+/**
+ * Sets the secret key and precomputes its public values
+ */
+bool SigningKey::setSecretKey(const crypto::secret_key& secretKey) {
+    const unsigned char* secret = reinterpret_cast<const unsigned char*>(&secretKey);
+    if (sc_check(secret) != 0 || sc_isnonzero(secret) == 0) {
+        clear();
+        return false;
+    }
+
+    ge_p3 point;
+    ge_scalarmult_base(&point, secret);
+    ge_p3_tobytes(reinterpret_cast<unsigned char*>(&m_publicKey), &point);
+    ge_dsm_precomp(m_publicKeyTable, &point);
+
+    m_iv = crypto::rand<crypto::chacha_iv>();
+    crypto::chacha20(&secretKey, sizeof(secretKey), memoryKey(), m_iv, reinterpret_cast<char*>(&m_encryptedSecretKey));
+    m_valid = true;
+    return true;
+}
+
+/**
+ * Wipes the key
+ */
+void SigningKey::clear() {
+    memwipe(&m_encryptedSecretKey, sizeof(m_encryptedSecretKey));
+    std::memset(&m_iv, 0, sizeof(m_iv));
+    std::memset(&m_publicKey, 0, sizeof(m_publicKey));
+    std::memset(&m_publicKeyTable, 0, sizeof(m_publicKeyTable));
+    m_valid = false;
+}
+
+/**
+ * Checks whether a key is set
+ */
+bool SigningKey::isValid() const {
+    return m_valid;
+}
+
+/**
+ * Decrypts the secret key
+ */
+void SigningKey::getSecretKey(crypto::secret_key& secretKey) const {
+    crypto::chacha20(&m_encryptedSecretKey, sizeof(m_encryptedSecretKey), memoryKey(), m_iv,
+                     reinterpret_cast<char*>(&secretKey));
+}
+
+/**
+ * Gets the public key
+ */
+const crypto::public_key& SigningKey::getPublicKey() const {
+    return m_publicKey;
+}
+
+/**
+ * Gets the double-scalar multiplication table of the public key
+ */
+const ge_dsmp& SigningKey::getPublicKeyTable() const {
+    return m_publicKeyTable;
+}
+
+} // namespace lumina
@@ -10,65 +10,281 @@
 
 #include "core/transaction.h"
 #include "utils/logger.h"
+#include "utils/thread_pool.h"
+#include "crypto/keccak.h"
+#include "ringct/multiexp.h"
+#include "memwipe.h"
 #include <sstream>
 #include <iomanip>
-#include <random>
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstring>
 
 namespace lumina {
 
+/**
+ * Prefix of transaction IDs
+ */
+static const char TRANSACTION_ID_PREFIX[] = "TX-";
+
+/**
+ * Number of hash bytes encoded in a transaction ID
+ */
+const size_t TRANSACTION_ID_HASH_BYTES = 20;
+
+static_assert(sizeof(TRANSACTION_ID_PREFIX) - 1 + 2 * TRANSACTION_ID_HASH_BYTES <= TRANSACTION_ID_LENGTH,
+              "Transaction IDs must fit in TRANSACTION_ID_LENGTH");
+
+/**
+ * Domain separators of the hashes over transaction contents
+ */
+static const char TRANSACTION_ID_DOMAIN[] = "lumina-transaction-id";
+static const char TRANSACTION_NONCE_DOMAIN[] = "lumina-transaction-nonce";
+static const char TRANSACTION_CHALLENGE_DOMAIN[] = "lumina-transaction-challenge";
+
+/**
+ * Minimum number of signatures combined into one multi-scalar multiplication
+ */
+const size_t SIGNATURE_BATCH_MIN_CHUNK = 64;
+
+/**
+ * Gets the hashing context of the calling thread, reused across transactions
+ */
+static KECCAK_CTX& hashContext() {
+    thread_local KECCAK_CTX ctx;
+    return ctx;
+}
+
+/**
+ * Feeds raw bytes to the hash
+ */
+static void hashBytes(KECCAK_CTX& ctx, const void* data, size_t size) {
+    keccak_update(&ctx, static_cast<const uint8_t*>(data), size);
+}
+
+/**
+ * Feeds an integer to the hash in little-endian byte order
+ */
+static void hashUint64(KECCAK_CTX& ctx, uint64_t value) {
+    uint8_t bytes[8];
+    for (size_t i = 0; i < sizeof(bytes); ++i) {
+        bytes[i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+    keccak_update(&ctx, bytes, sizeof(bytes));
+}
+
+/**
+ * Feeds a length-prefixed string to the hash
+ */
+static void hashString(KECCAK_CTX& ctx, std::string_view value) {
+    hashUint64(ctx, value.size());
+    keccak_update(&ctx, reinterpret_cast<const uint8_t*>(value.data()), value.size());
+}
+
+/**
+ * Feeds the canonical encoding of a transaction's contents to the hash
+ *
+ * The fields are length-prefixed, so equal transactions hash equally on
+ * every platform. The asset is hashed by symbol because asset ids are
+ * only meaningful within one process.
+ */
+static void hashContents(KECCAK_CTX& ctx, const Transaction& transaction) {
+    hashString(ctx, transaction.getFromAddress());
+    hashString(ctx, transaction.getToAddress());
+    hashUint64(ctx, transaction.getAmount().atomicUnits());
+    hashString(ctx, transaction.getTokenSymbol());
+    hashUint64(ctx, static_cast<uint64_t>(static_cast<int64_t>(transaction.getTimestamp())));
+}
+
+/**
+ * Finishes a hash and reduces it to a scalar
+ */
+static void finishScalar(KECCAK_CTX& ctx, unsigned char* scalar) {
+    keccak_finish(&ctx, scalar);
+    sc_reduce32(scalar);
+}
+
+/**
+ * Gets the double-scalar multiplication table of the base point G
+ */
+static const ge_dsmp& baseTable() {
+    static const struct BaseTable {
+        ge_dsmp table;
+        BaseTable() {
+            unsigned char one[32] = {1};
+            ge_p3 base;
+            ge_scalarmult_base(&base, one);
+            ge_dsm_precomp(table, &base);
+        }
+    } instance;
+    return instance.table;
+}
+
+/**
+ * Computes a multi-scalar multiplication with the algorithm suited to its size
+ */
+static rct::key multiexp(const std::vector<rct::MultiexpData>& terms) {
+    return terms.size() <= 95 ? rct::straus(terms) : rct::pippenger(terms, NULL, 0, rct::get_pippenger_c(terms.size()));
+}
+
+/**
+ * Decompresses a point of a signature to be batch verified
+ *
+ * Single verification compares R byte for byte, but the batch equation
+ * only sees the decompressed points, so non-canonical encodings and
+ * points of small order, which the cofactor would cancel, are refused.
+ */
+static bool decompressBatchPoint(const unsigned char* encoded, ge_p3& point) {
+    if (ge_frombytes_vartime(&point, encoded) != 0) {
+        return false;
+    }
+    
+    unsigned char canonical[32];
+    ge_p3_tobytes(canonical, &point);
+    if (std::memcmp(canonical, encoded, sizeof(canonical)) != 0) {
+        return false;
+    }
+    
+    rct::key key;
+    std::memcpy(key.bytes, encoded, sizeof(key.bytes));
+    return !(rct::scalarmult8(key) == rct::identity());
+}
+
+/**
+ * Gets the display name of a transaction status
+ */
+const char* transactionStatusToString(TransactionStatus status) {
+    switch (status) {
+        case TransactionStatus::PENDING:
+            return "PENDING";
+        case TransactionStatus::CONFIRMED:
+            return "CONFIRMED";
+        case TransactionStatus::FAILED:
+            return "FAILED";
+    }
+    return "UNKNOWN";
+}
+
+/**
+ * Parses a transaction status name, ignoring case
+ */
+bool parseTransactionStatus(const std::string& text, TransactionStatus& status) {
+    std::string upper(text);
+    std::transform(upper.begin(), upper.end(), upper.begin(), ::toupper);
+    
+    for (TransactionStatus candidate : {TransactionStatus::PENDING, TransactionStatus::CONFIRMED, TransactionStatus::FAILED}) {
+        if (upper == transactionStatusToString(candidate)) {
+            status = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Converts a stored status value back to a status
+ */
+bool transactionStatusFromValue(uint32_t value, TransactionStatus& status) {
+    if (value > static_cast<uint32_t>(TransactionStatus::FAILED)) {
+        return false;
+    }
+    status = static_cast<TransactionStatus>(value);
+    return true;
+}
+
+/**
+ * Constructor - Creates an empty transaction
+ */
+Transaction::Transaction()
+    : m_assetId(LMT_ASSET_ID),
+      m_timestamp(0),
+      m_status(TransactionStatus::PENDING),
+      m_signerKey() {
+}
+
 /**
  * Constructor - Creates a new transaction
  */
 Transaction::Transaction(const std::string& fromAddress, 
                          const std::string& toAddress, 
-                         double amount, 
-                         const std::string& tokenSymbol)
+                         Amount amount, 
+                         AssetId assetId,
+                         uint64_t nonce)
     : m_fromAddress(fromAddress),
       m_toAddress(toAddress),
       m_amount(amount),
-      m_tokenSymbol(tokenSymbol),
+      m_assetId(assetId),
       m_timestamp(std::time(nullptr)),
-      m_status(TransactionStatus::PENDING) {
+      m_status(TransactionStatus::PENDING),
+      m_signerKey() {
     
-    // Generate a unique transaction ID
-    m_id = generateId();
+    // Derive the transaction ID from the contents
+    generateId(nonce);
     
-    Logger::getInstance().info("Created new transaction: " + m_id);
+    LUMINA_LOG_DEBUG("Created new transaction: ", m_id.view());
+}
+
+/**
+ * Constructor - Restores a previously created transaction
+ */
+Transaction::Transaction(std::string_view id,
+                         std::string_view fromAddress, 
+                         std::string_view toAddress, 
+                         Amount amount, 
+                         AssetId assetId,
+                         time_t timestamp,
+                         TransactionStatus status)
+    : m_id(id),
+      m_fromAddress(fromAddress),
+      m_toAddress(toAddress),
+      m_amount(amount),
+      m_assetId(assetId),
+      m_timestamp(timestamp),
+      m_status(status),
+      m_signerKey() {
 }
 
 /**
  * Gets the transaction ID
  */
-std::string Transaction::getId() const {
-    return m_id;
+std::string_view Transaction::getId() const {
+    return m_id.view();
 }
 
 /**
  * Gets the sender address
  */
-std::string Transaction::getFromAddress() const {
-    return m_fromAddress;
+std::string_view Transaction::getFromAddress() const {
+    return m_fromAddress.view();
 }
 
 /**
  * Gets the recipient address
  */
-std::string Transaction::getToAddress() const {
-    return m_toAddress;
+std::string_view Transaction::getToAddress() const {
+    return m_toAddress.view();
 }
 
 /**
  * Gets the transaction amount
  */
-double Transaction::getAmount() const {
+Amount Transaction::getAmount() const {
     return m_amount;
 }
 
+/**
+ * Gets the asset id
+ */
+AssetId Transaction::getAssetId() const {
+    return m_assetId;
+}
+
 /**
  * Gets the token symbol
  */
-std::string Transaction::getTokenSymbol() const {
-    return m_tokenSymbol;
+const std::string& Transaction::getTokenSymbol() const {
+    return AssetRegistry::getInstance().getSymbol(m_assetId);
 }
 
 /**
@@ -91,44 +307,206 @@ TransactionStatus Transaction::getStatus() const {
 void Transaction::setStatus(TransactionStatus status) {
     m_status = status;
     
-    std::string statusStr;
-    switch (status) {
-        case TransactionStatus::PENDING:
-            statusStr = "PENDING";
-            break;
-        case TransactionStatus::CONFIRMED:
-            statusStr = "CONFIRMED";
-            break;
-        case TransactionStatus::FAILED:
-            statusStr = "FAILED";
-            break;
-    }
-    
-    Logger::getInstance().info("Transaction " + m_id + " status changed to " + statusStr);
+    LUMINA_LOG_INFO("Transaction ", m_id.view(), " status changed to ", transactionStatusToString(status));
 }
 
 /**
- * Signs the transaction with the sender's private key
+ * Signs the transaction with the sender's key
  */
-bool Transaction::sign(const std::string& privateKey) {
-    // TODO: Implement proper transaction signing
+bool Transaction::sign(const SigningKey& key) {
+    if (!key.isValid()) {
+        Logger::getInstance().error("Cannot sign transaction " + m_id.str() + " without a signing key");
+        return false;
+    }
+    
+    crypto::secret_key secretKey;
+    key.getSecretKey(secretKey);
+    const unsigned char* secret = reinterpret_cast<const unsigned char*>(&secretKey);
+    m_signerKey = key.getPublicKey();
     
-    // For now, just simulate a successful signing
-    m_signature = "SIGNATURE_" + m_id;
+    // The nonce is derived from the secret key and the message, so it never repeats across messages
+    unsigned char nonce[32];
+    KECCAK_CTX& ctx = hashContext();
+    keccak_init(&ctx);
+    hashBytes(ctx, TRANSACTION_NONCE_DOMAIN, sizeof(TRANSACTION_NONCE_DOMAIN) - 1);
+    hashBytes(ctx, secret, 32);
+    hashString(ctx, m_id.view());
+    hashContents(ctx, *this);
+    finishScalar(ctx, nonce);
     
-    Logger::getInstance().info("Transaction " + m_id + " signed successfully");
+    // R = k*G
+    unsigned char signature[TRANSACTION_SIGNATURE_LENGTH];
+    ge_p3 commitment;
+    ge_scalarmult_base(&commitment, nonce);
+    ge_p3_tobytes(signature, &commitment);
+    
+    // s = k + e*x
+    unsigned char challenge[32];
+    computeChallenge(signature, challenge);
+    sc_muladd(signature + 32, challenge, secret, nonce);
+    
+    memwipe(nonce, sizeof(nonce));
+    memwipe(&secretKey, sizeof(secretKey));
+    memwipe(&ctx, sizeof(ctx));
+    
+    m_signature.assign(std::string_view(reinterpret_cast<const char*>(signature), sizeof(signature)));
+    
+    LUMINA_LOG_DEBUG("Transaction ", m_id.view(), " signed successfully");
     
     return true;
 }
 
+/**
+ * Gets the public key that signed the transaction
+ */
+const crypto::public_key& Transaction::getSignerKey() const {
+    return m_signerKey;
+}
+
+/**
+ * Gets the signature
+ */
+std::string_view Transaction::getSignature() const {
+    return m_signature.view();
+}
+
+/**
+ * Restores a signature saved with a previously created transaction
+ */
+bool Transaction::restoreSignature(const crypto::public_key& signerKey, std::string_view signature) {
+    if (signature.size() != TRANSACTION_SIGNATURE_LENGTH) {
+        return false;
+    }
+    
+    m_signerKey = signerKey;
+    m_signature.assign(signature);
+    return true;
+}
+
+/**
+ * Checks whether the transaction has been signed
+ */
+bool Transaction::isSigned() const {
+    return !m_signature.empty();
+}
+
 /**
  * Verifies the transaction signature
  */
 bool Transaction::verifySignature() const {
-    // TODO: Implement proper signature verification
+    unsigned char challenge[32];
+    const unsigned char* commitment;
+    const unsigned char* response;
+    if (!parseSignature(challenge, commitment, response)) {
+        return false;
+    }
+    
+    ge_p3 signer;
+    if (ge_frombytes_vartime(&signer, reinterpret_cast<const unsigned char*>(&m_signerKey)) != 0) {
+        return false;
+    }
+    
+    // The signature is valid if s*G - e*P reproduces R
+    unsigned char zero[32];
+    unsigned char negChallenge[32];
+    sc_0(zero);
+    sc_sub(negChallenge, zero, challenge);
+    
+    ge_p2 expected;
+    unsigned char expectedBytes[32];
+    ge_double_scalarmult_base_vartime(&expected, negChallenge, &signer, response);
+    ge_tobytes(expectedBytes, &expected);
     
-    // For now, just check if signature exists and has the expected format
-    return !m_signature.empty() && m_signature.substr(0, 10) == "SIGNATURE_";
+    return std::memcmp(expectedBytes, commitment, sizeof(expectedBytes)) == 0;
+}
+
+/**
+ * Verifies the transaction signature against a known key
+ */
+bool Transaction::verifySignature(const SigningKey& key) const {
+    if (!key.isValid() || m_signerKey != key.getPublicKey()) {
+        return false;
+    }
+    
+    unsigned char challenge[32];
+    const unsigned char* commitment;
+    const unsigned char* response;
+    if (!parseSignature(challenge, commitment, response)) {
+        return false;
+    }
+    
+    unsigned char zero[32];
+    unsigned char negChallenge[32];
+    sc_0(zero);
+    sc_sub(negChallenge, zero, challenge);
+    
+    // Both points come with precomputed tables, so no decompression is needed
+    ge_p2 expected;
+    unsigned char expectedBytes[32];
+    ge_double_scalarmult_precomp_vartime2(&expected, response, baseTable(), negChallenge, key.getPublicKeyTable());
+    ge_tobytes(expectedBytes, &expected);
+    
+    return std::memcmp(expectedBytes, commitment, sizeof(expectedBytes)) == 0;
+}
+
+/**
+ * Verifies the signatures of many transactions at once
+ *
+ * Each chunk checks 8*(sum(z*s)*G - sum(z*R) - sum(z*e*P)) = 0 with a
+ * random weight z per signature, so invalid signatures cannot cancel each
+ * other. Multiplying by the cofactor keeps small-order components of R
+ * and P from deciding the outcome through the random weights.
+ */
+bool Transaction::verifySignatures(const Transaction* transactions, size_t count) {
+    std::atomic<bool> valid(true);
+    
+    ParallelTask task = [&](size_t begin, size_t end) {
+        unsigned char zero[32];
+        unsigned char weightedChallenge[32];
+        sc_0(zero);
+        
+        std::vector<rct::MultiexpData> terms;
+        terms.reserve(2 * (end - begin) + 1);
+        rct::key baseScalar;
+        sc_0(baseScalar.bytes);
+        
+        for (size_t i = begin; i < end; ++i) {
+            if (!valid.load(std::memory_order_relaxed)) {
+                return;
+            }
+            
+            const Transaction& transaction = transactions[i];
+            unsigned char challenge[32];
+            const unsigned char* commitment;
+            const unsigned char* response;
+            rct::MultiexpData commitmentTerm;
+            rct::MultiexpData signerTerm;
+            if (!transaction.parseSignature(challenge, commitment, response) ||
+                !decompressBatchPoint(commitment, commitmentTerm.point) ||
+                !decompressBatchPoint(reinterpret_cast<const unsigned char*>(&transaction.m_signerKey), signerTerm.point)) {
+                valid.store(false, std::memory_order_relaxed);
+                return;
+            }
+            
+            rct::key weight = rct::skGen();
+            sc_muladd(baseScalar.bytes, weight.bytes, response, baseScalar.bytes);
+            sc_sub(commitmentTerm.scalar.bytes, zero, weight.bytes);
+            sc_mul(weightedChallenge, weight.bytes, challenge);
+            sc_sub(signerTerm.scalar.bytes, zero, weightedChallenge);
+            
+            terms.push_back(commitmentTerm);
+            terms.push_back(signerTerm);
+        }
+        
+        terms.emplace_back(baseScalar, rct::G);
+        if (!(rct::scalarmult8(multiexp(terms)) == rct::identity())) {
+            valid.store(false, std::memory_order_relaxed);
+        }
+    };
+    
+    ThreadPool::getInstance().parallelFor(count, task, SIGNATURE_BATCH_MIN_CHUNK);
+    
+    return valid.load();
 }
 
 /**
@@ -142,53 +520,74 @@ std::string Transaction::toString() const {
     struct tm* timeInfo = localtime(&m_timestamp);
     strftime(timeBuffer, sizeof(timeBuffer), "%Y-%m-%d %H:%M:%S", timeInfo);
     
-    // Format status as a string
-    std::string statusStr;
-    switch (m_status) {
-        case TransactionStatus::PENDING:
-            statusStr = "PENDING";
-            break;
-        case TransactionStatus::CONFIRMED:
-            statusStr = "CONFIRMED";
-            break;
-        case TransactionStatus::FAILED:
-            statusStr = "FAILED";
-            break;
-    }
-    
     // Build the string representation
-    oss << "Transaction ID: " << m_id << "\n"
-        << "From: " << m_fromAddress << "\n"
-        << "To: " << m_toAddress << "\n"
-        << "Amount: " << std::fixed << std::setprecision(8) << m_amount << " " << m_tokenSymbol << "\n"
+    oss << "Transaction ID: " << m_id.view() << "\n"
+        << "From: " << m_fromAddress.view() << "\n"
+        << "To: " << m_toAddress.view() << "\n"
+        << "Amount: " << m_amount.toString() << " " << getTokenSymbol() << "\n"
         << "Timestamp: " << timeBuffer << "\n"
-        << "Status: " << statusStr << "\n";
+        << "Status: " << transactionStatusToString(m_status) << "\n";
     
     return oss.str();
 }
 
 /**
- * Generates a unique transaction ID
+ * Generates the transaction ID from a hash of the transaction contents
  */
-std::string Transaction::generateId() const {
-    // Generate a random transaction ID
-    // In a real implementation, this would be a hash of the transaction data
+void Transaction::generateId(uint64_t nonce) {
+    static const char hexChars[] = "0123456789abcdef";
     
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<> dis(0, 15);
+    KECCAK_CTX& ctx = hashContext();
+    keccak_init(&ctx);
+    hashBytes(ctx, TRANSACTION_ID_DOMAIN, sizeof(TRANSACTION_ID_DOMAIN) - 1);
+    hashContents(ctx, *this);
+    hashUint64(ctx, nonce);
     
-    const char* hexChars = "0123456789abcdef";
-    std::string uuid;
+    uint8_t digest[KECCAK_DIGESTSIZE];
+    keccak_finish(&ctx, digest);
     
-    for (int i = 0; i < 32; ++i) {
-        uuid += hexChars[dis(gen)];
-        if (i == 7 || i == 11 || i == 15 || i == 19) {
-            uuid += '-';
-        }
+    char id[TRANSACTION_ID_LENGTH];
+    size_t size = sizeof(TRANSACTION_ID_PREFIX) - 1;
+    std::memcpy(id, TRANSACTION_ID_PREFIX, size);
+    for (size_t i = 0; i < TRANSACTION_ID_HASH_BYTES; ++i) {
+        id[size++] = hexChars[digest[i] >> 4];
+        id[size++] = hexChars[digest[i] & 0x0f];
+    }
+    
+    m_id.assign(std::string_view(id, size));
+}
+
+/**
+ * Computes the challenge e = H(R || P || message) of a signature
+ */
+void Transaction::computeChallenge(const unsigned char* commitment, unsigned char* challenge) const {
+    KECCAK_CTX& ctx = hashContext();
+    keccak_init(&ctx);
+    hashBytes(ctx, TRANSACTION_CHALLENGE_DOMAIN, sizeof(TRANSACTION_CHALLENGE_DOMAIN) - 1);
+    hashBytes(ctx, commitment, 32);
+    hashBytes(ctx, &m_signerKey, sizeof(m_signerKey));
+    hashString(ctx, m_id.view());
+    hashContents(ctx, *this);
+    finishScalar(ctx, challenge);
+}
+
+/**
+ * Splits the signature into R and s and computes its challenge
+ */
+bool Transaction::parseSignature(unsigned char* challenge, const unsigned char*& commitment,
+                                 const unsigned char*& response) const {
+    if (m_signature.size() != TRANSACTION_SIGNATURE_LENGTH) {
+        return false;
     }
     
-    return "TX-" + uuid;
+    commitment = reinterpret_cast<const unsigned char*>(m_signature.data());
+    response = commitment + 32;
+    if (sc_check(response) != 0) {
+        return false;
+    }
+    
+    computeChallenge(commitment, challenge);
+    return true;
 }
 
-} // namespace lumina
\ No newline at end of file
+} // namespace lumina
@@ -10,59 +10,220 @@
 
 #include "core/wallet.h"
 #include "core/transaction.h"
+#include "network/scanner.h"
 #include "utils/logger.h"
 #include "utils/config.h"
+#include "memwipe.h"
 #include <iostream>
-#include <fstream>
-#include <sstream>
-#include <random>
 #include <algorithm>
 #include <ctime>
+#include <cstring>
 
 namespace lumina {
 
-// List of words for seed phrase generation
-const std::vector<std::string> SEED_WORDS = {
-    "abandon", "ability", "able", "about", "above", "absent", "absorb", "abstract", "absurd", "abuse",
-    "access", "accident", "account", "accuse", "achieve", "acid", "acoustic", "acquire", "across", "act",
-    "action", "actor", "actress", "actual", "adapt", "add", "addict", "address", "adjust", "admit",
-    "adult", "advance", "advice", "aerobic", "affair", "afford", "afraid", "again", "age", "agent",
-    "agree", "ahead", "aim", "air", "airport", "aisle", "alarm", "album", "alcohol", "alert",
-    "alien", "all", "alley", "allow", "almost", "alone", "alpha", "already", "also", "alter",
-    "always", "amateur", "amazing", "among", "amount", "amused", "analyst", "anchor", "ancient", "anger",
-    "angle", "angry", "animal", "ankle", "announce", "annual", "another", "answer", "antenna", "antique",
-    "anxiety", "any", "apart", "apology", "appear", "apple", "approve", "april", "arch", "arctic",
-    "area", "arena", "argue", "arm", "armed", "armor", "army", "around", "arrange", "arrest",
-    "arrive", "arrow", "art", "artefact", "artist", "artwork", "ask", "aspect", "assault", "asset",
-    "assist", "assume", "asthma", "athlete", "atom", "attack", "attend", "attitude", "attract", "auction"
-};
+// Number of journal records after which the wallet file is rewritten in the background
+const uint64_t JOURNAL_SNAPSHOT_INTERVAL = 1000;
+
+// Size of a seed packed as two little-endian bytes per word
+const size_t SEED_BYTES = 2 * SEED_PHRASE_WORDS;
+
+/**
+ * Appends a little-endian 64-bit integer to a buffer
+ */
+static void writeUint64(std::string& out, uint64_t value) {
+    for (int i = 0; i < 8; ++i) {
+        out.push_back(static_cast<char>(value >> (8 * i)));
+    }
+}
+
+/**
+ * Appends a length-prefixed string to a buffer
+ */
+static void writeString(std::string& out, std::string_view value) {
+    writeUint64(out, value.size());
+    out.append(value.data(), value.size());
+}
+
+/**
+ * Reads a little-endian 64-bit integer from a buffer
+ */
+static bool readUint64(const std::string& in, size_t& pos, uint64_t& value) {
+    if (in.size() - pos < 8) {
+        return false;
+    }
+    value = 0;
+    for (int i = 0; i < 8; ++i) {
+        value |= static_cast<uint64_t>(static_cast<uint8_t>(in[pos + i])) << (8 * i);
+    }
+    pos += 8;
+    return true;
+}
+
+/**
+ * Reads a length-prefixed string from a buffer
+ */
+static bool readString(const std::string& in, size_t& pos, std::string& value) {
+    uint64_t size = 0;
+    if (!readUint64(in, pos, size) || in.size() - pos < size) {
+        return false;
+    }
+    value.assign(in, pos, size);
+    pos += size;
+    return true;
+}
+
+/**
+ * Copies a string into a zero-padded fixed-size record field
+ *
+ * Returns false, leaving the field untouched, if the string does not fit.
+ */
+static bool copyField(char* field, size_t fieldSize, std::string_view value) {
+    if (value.size() > fieldSize) {
+        return false;
+    }
+    std::memcpy(field, value.data(), value.size());
+    return true;
+}
+
+/**
+ * Reads a zero-padded fixed-size record field
+ */
+static std::string_view readField(const char* field, size_t fieldSize) {
+    return std::string_view(field, strnlen(field, fieldSize));
+}
+
+/**
+ * Copies a transaction's signature into the signature fields of a record
+ */
+template <typename Record>
+static void copySignature(Record& record, const Transaction& transaction) {
+    std::string_view signature = transaction.getSignature();
+    if (signature.size() != sizeof(record.signature)) {
+        return;
+    }
+    std::memcpy(record.signerKey, &transaction.getSignerKey(), sizeof(record.signerKey));
+    std::memcpy(record.signature, signature.data(), sizeof(record.signature));
+    record.signatureSize = sizeof(record.signature);
+}
+
+/**
+ * Restores the signature stored in the signature fields of a record
+ *
+ * Returns false if the record holds a signature of the wrong size.
+ */
+template <typename Record>
+static bool restoreSignature(const Record& record, Transaction& transaction) {
+    if (record.signatureSize == 0) {
+        return true;
+    }
+    if (record.signatureSize != sizeof(record.signature)) {
+        return false;
+    }
+    
+    crypto::public_key signerKey;
+    std::memcpy(&signerKey, record.signerKey, sizeof(signerKey));
+    return transaction.restoreSignature(signerKey, std::string_view(reinterpret_cast<const char*>(record.signature),
+                                                                    sizeof(record.signature)));
+}
+
+/**
+ * Packs the word indices of a seed into bytes
+ */
+static void packSeed(const SeedWordIndices& seed, uint8_t* bytes) {
+    for (size_t i = 0; i < seed.size(); ++i) {
+        bytes[2 * i] = static_cast<uint8_t>(seed[i]);
+        bytes[2 * i + 1] = static_cast<uint8_t>(seed[i] >> 8);
+    }
+}
+
+/**
+ * Unpacks the word indices of a seed from bytes
+ */
+static void unpackSeed(const uint8_t* bytes, SeedWordIndices& seed) {
+    for (size_t i = 0; i < seed.size(); ++i) {
+        seed[i] = static_cast<uint16_t>(bytes[2 * i] | (bytes[2 * i + 1] << 8));
+    }
+}
+
+/**
+ * Splits a seed phrase into words and looks each one up in the wordlist
+ */
+static bool parseSeedPhrase(std::string_view phrase, SeedWordIndices& seed) {
+    static const char whitespace[] = " \t\r\n";
+    size_t count = 0;
+    size_t pos = phrase.find_first_not_of(whitespace);
+    
+    while (pos != std::string_view::npos) {
+        size_t end = phrase.find_first_of(whitespace, pos);
+        if (count == SEED_PHRASE_WORDS) {
+            ++count;
+            break;
+        }
+        
+        int index = findSeedWord(phrase.substr(pos, end == std::string_view::npos ? end : end - pos));
+        if (index < 0) {
+            Logger::getInstance().error("Invalid seed phrase: word " + std::to_string(count + 1) + " is not a seed word");
+            return false;
+        }
+        seed[count++] = static_cast<uint16_t>(index);
+        
+        pos = phrase.find_first_not_of(whitespace, end == std::string_view::npos ? phrase.size() : end);
+    }
+    
+    if (count != SEED_PHRASE_WORDS) {
+        Logger::getInstance().error("Invalid seed phrase: must contain exactly " + std::to_string(SEED_PHRASE_WORDS) + " words");
+        return false;
+    }
+    
+    return true;
+}
 
 /**
  * Constructor - Creates a new wallet or loads an existing one
  */
 Wallet::Wallet(const std::string& walletPath, const std::string& password)
     : m_walletPath(walletPath),
+      m_walletFile(walletPath, password),
+      m_savedTransactionCount(0),
+      m_historyIndexed(false),
+      m_snapshotSequence(0),
+      m_transfersInFlight(0),
       m_isInitialized(false),
-      m_isSynchronized(false) {
+      m_isSynchronized(false),
+      m_snapshotPending(false),
+      m_stopSnapshots(false) {
     
     // Try to load existing wallet
-    if (!loadWallet()) {
-        // If loading fails, wallet doesn't exist yet
+    if (!m_walletFile.exists()) {
         Logger::getInstance().info("No existing wallet found at " + walletPath);
+    } else if (!loadWallet()) {
+        // The file stays untouched: create and recover refuse to replace it
+        Logger::getInstance().error("Failed to open the wallet at " + walletPath + ", check the password");
     } else {
         m_isInitialized = true;
         Logger::getInstance().info("Wallet loaded successfully from " + walletPath);
     }
+    
+    m_snapshotThread = std::thread(&Wallet::snapshotLoop, this);
 }
 
 /**
  * Destructor
  */
 Wallet::~Wallet() {
+    {
+        std::lock_guard<std::mutex> lock(m_snapshotMutex);
+        m_stopSnapshots = true;
+    }
+    m_snapshotRequested.notify_one();
+    m_snapshotThread.join();
+    
     // Save wallet data before destruction
     if (m_isInitialized) {
         saveWallet();
     }
+    
+    m_journal.close();
 }
 
 /**
@@ -74,21 +235,36 @@ bool Wallet::create() {
         return false;
     }
     
-    // Generate a new seed phrase
-    std::string seedPhrase = generateSeed();
+    // A wallet that failed to open, e.g. with a wrong password, must not be overwritten
+    if (m_walletFile.exists()) {
+        Logger::getInstance().error("A wallet already exists at " + m_walletPath);
+        return false;
+    }
+    
+    // Generate a new seed and derive the keys from it
+    SeedWordIndices seed = generateSeed();
+    bool derived = deriveSigningKey(seed);
+    if (derived) {
+        m_encryptedSeed = encryptSeed(seed);
+    }
+    memwipe(seed.data(), sizeof(seed));
+    if (!derived) {
+        Logger::getInstance().error("Failed to derive the signing key from the seed");
+        return false;
+    }
     
     // TODO: Generate wallet address from seed
     m_mainAddress = "LMT1234567890ABCDEFGHIJKLMNOPQRSTUVWXYZ";
     
     // Initialize balances
-    m_balances["LMT"] = 0.0;
+    m_balances.assign(1, Amount());
     
     // Set wallet as initialized
     m_isInitialized = true;
     m_isSynchronized = false;
     
     // Save wallet to file
-    return saveWallet();
+    return saveWallet() && openJournal(true);
 }
 
 /**
@@ -100,34 +276,40 @@ bool Wallet::recoverFromSeed(const std::string& seedPhrase) {
         return false;
     }
     
-    // Validate seed phrase
-    std::istringstream iss(seedPhrase);
-    std::string word;
-    std::vector<std::string> words;
-    
-    while (iss >> word) {
-        words.push_back(word);
+    // A wallet that failed to open, e.g. with a wrong password, must not be overwritten
+    if (m_walletFile.exists()) {
+        Logger::getInstance().error("A wallet already exists at " + m_walletPath);
+        return false;
     }
     
-    if (words.size() != 12) {
-        Logger::getInstance().error("Invalid seed phrase: must contain exactly 12 words");
+    // Validate seed phrase
+    SeedWordIndices seed;
+    if (!parseSeedPhrase(seedPhrase, seed)) {
         return false;
     }
     
-    // TODO: Validate each word against the dictionary
+    bool derived = deriveSigningKey(seed);
+    if (derived) {
+        m_encryptedSeed = encryptSeed(seed);
+    }
+    memwipe(seed.data(), sizeof(seed));
+    if (!derived) {
+        Logger::getInstance().error("Failed to derive the signing key from the seed phrase");
+        return false;
+    }
     
     // TODO: Generate wallet address from seed
     m_mainAddress = "LMT1234567890ABCDEFGHIJKLMNOPQRSTUVWXYZ";
     
     // Initialize balances
-    m_balances["LMT"] = 0.0;
+    m_balances.assign(1, Amount());
     
     // Set wallet as initialized
     m_isInitialized = true;
     m_isSynchronized = false;
     
     // Save wallet to file
-    return saveWallet();
+    return saveWallet() && openJournal(true);
 }
 
 /**
@@ -140,18 +322,26 @@ std::string Wallet::getMainAddress() const {
 /**
  * Gets the balance of the wallet
  */
-double Wallet::getBalance(const std::string& tokenSymbol) const {
-    auto it = m_balances.find(tokenSymbol);
-    if (it != m_balances.end()) {
-        return it->second;
+Amount Wallet::getBalance(AssetId assetId) const {
+    std::lock_guard<std::mutex> lock(m_stateMutex);
+    
+    if (assetId < m_balances.size()) {
+        return m_balances[assetId];
     }
-    return 0.0;
+    return Amount();
+}
+
+/**
+ * Gets the balance of the wallet by token symbol
+ */
+Amount Wallet::getBalance(const std::string& tokenSymbol) const {
+    return getBalance(AssetRegistry::getInstance().find(tokenSymbol));
 }
 
 /**
  * Transfers funds to another address
  */
-bool Wallet::transfer(const std::string& toAddress, double amount, const std::string& tokenSymbol) {
+bool Wallet::transfer(const std::string& toAddress, Amount amount, AssetId assetId) {
     if (!m_isInitialized) {
         Logger::getInstance().error("Wallet is not initialized");
         return false;
@@ -161,30 +351,275 @@ bool Wallet::transfer(const std::string& toAddress, double amount, const std::st
         Logger::getInstance().warning("Wallet is not synchronized with the network");
     }
     
+    if (toAddress.empty() || toAddress.size() > TRANSACTION_ADDRESS_LENGTH) {
+        Logger::getInstance().error("Invalid recipient address: must be 1 to " +
+                                    std::to_string(TRANSACTION_ADDRESS_LENGTH) + " characters");
+        return false;
+    }
+    
+    std::unique_lock<std::mutex> lock(m_stateMutex);
+    
     // Check if we have enough balance
-    double balance = getBalance(tokenSymbol);
-    if (balance < amount) {
+    Amount balance = assetId < m_balances.size() ? m_balances[assetId] : Amount();
+    if (amount > balance) {
         Logger::getInstance().error("Insufficient balance for transfer");
         return false;
     }
     
-    // Create a new transaction
-    auto transaction = std::make_shared<Transaction>(m_mainAddress, toAddress, amount, tokenSymbol);
+    Transaction transaction;
+    JournalRecord record;
+    if (!prepareTransfer(toAddress, amount, assetId, m_savedTransactionCount + m_transactions.size(),
+                         transaction, record)) {
+        return false;
+    }
     
-    // TODO: Sign the transaction with the wallet's private key
+    // Record the transfer in the journal before applying it
+    uint64_t sequence = m_journal.append(record);
+    if (sequence == 0) {
+        Logger::getInstance().error("Wallet journal is not writable");
+        return false;
+    }
+    applyTransfer(transaction);
+    std::string txId(transaction.getId());
+    ++m_transfersInFlight;
     
-    // TODO: Submit the transaction to the network
+    bool snapshotDue = sequence - m_snapshotSequence >= JOURNAL_SNAPSHOT_INTERVAL;
+    lock.unlock();
     
-    // For now, just simulate a successful transaction
-    m_balances[tokenSymbol] -= amount;
-    m_transactions.push_back(transaction);
+    if (snapshotDue) {
+        requestSnapshot();
+    }
+    
+    // Transfers made by other threads meanwhile are committed with the same sync
+    bool committed = m_journal.waitForCommit(sequence);
+    
+    lock.lock();
+    if (!committed) {
+        rollbackTransfer(txId, assetId, amount);
+    }
+    if (--m_transfersInFlight == 0) {
+        m_transfersSettled.notify_all();
+    }
+    lock.unlock();
+    
+    if (!committed) {
+        Logger::getInstance().error("Failed to record transfer in the wallet journal");
+        return false;
+    }
     
-    Logger::getInstance().info("Transfer initiated: " + std::to_string(amount) + " " + 
-                              tokenSymbol + " to " + toAddress);
+    LUMINA_LOG_INFO("Transfer initiated: ", amount, " ", AssetRegistry::getInstance().getSymbol(assetId),
+                    " to ", toAddress);
     
     return true;
 }
 
+/**
+ * Transfers funds to another address by token symbol
+ */
+bool Wallet::transfer(const std::string& toAddress, Amount amount, const std::string& tokenSymbol) {
+    AssetId assetId = AssetRegistry::getInstance().find(tokenSymbol);
+    if (assetId == INVALID_ASSET_ID) {
+        Logger::getInstance().error("Unknown token: " + tokenSymbol);
+        return false;
+    }
+    
+    return transfer(toAddress, amount, assetId);
+}
+
+/**
+ * Transfers funds to many addresses at once
+ */
+bool Wallet::transferBatch(const std::vector<TransferDestination>& destinations) {
+    if (!m_isInitialized) {
+        Logger::getInstance().error("Wallet is not initialized");
+        return false;
+    }
+    
+    if (destinations.empty()) {
+        Logger::getInstance().error("Batch transfer has no destinations");
+        return false;
+    }
+    
+    if (!m_isSynchronized) {
+        Logger::getInstance().warning("Wallet is not synchronized with the network");
+    }
+    
+    size_t assetCount = AssetRegistry::getInstance().size();
+    
+    std::unique_lock<std::mutex> lock(m_stateMutex);
+    
+    // Validate every destination and total the amounts per asset
+    std::vector<Amount> totals;
+    for (size_t i = 0; i < destinations.size(); ++i) {
+        const TransferDestination& destination = destinations[i];
+        std::string position = "Batch destination " + std::to_string(i + 1);
+        
+        if (destination.address.empty()) {
+            Logger::getInstance().error(position + " has no address");
+            return false;
+        }
+        if (destination.address.size() > TRANSACTION_ADDRESS_LENGTH) {
+            Logger::getInstance().error(position + " has an address longer than " +
+                                        std::to_string(TRANSACTION_ADDRESS_LENGTH) + " characters");
+            return false;
+        }
+        if (destination.amount.isZero()) {
+            Logger::getInstance().error(position + " has a zero amount");
+            return false;
+        }
+        if (destination.assetId >= assetCount) {
+            Logger::getInstance().error(position + " has an unknown asset");
+            return false;
+        }
+        
+        if (destination.assetId >= totals.size()) {
+            totals.resize(destination.assetId + 1);
+        }
+        if (!totals[destination.assetId].checkedAdd(destination.amount, totals[destination.assetId])) {
+            Logger::getInstance().error("Batch transfer total overflows");
+            return false;
+        }
+    }
+    
+    for (AssetId assetId = 0; assetId < totals.size(); ++assetId) {
+        Amount balance = assetId < m_balances.size() ? m_balances[assetId] : Amount();
+        if (totals[assetId] > balance) {
+            Logger::getInstance().error("Insufficient " + AssetRegistry::getInstance().getSymbol(assetId) +
+                                        " balance for batch transfer");
+            return false;
+        }
+    }
+    
+    // Every transfer is prepared before any is journaled, so a failure leaves nothing behind
+    size_t firstNonce = m_savedTransactionCount + m_transactions.size();
+    std::vector<Transaction> transactions(destinations.size());
+    std::vector<JournalRecord> records(destinations.size());
+    for (size_t i = 0; i < destinations.size(); ++i) {
+        const TransferDestination& destination = destinations[i];
+        if (!prepareTransfer(destination.address, destination.amount, destination.assetId, firstNonce + i,
+                             transactions[i], records[i])) {
+            return false;
+        }
+    }
+    
+    // The journal takes the whole batch or none of it
+    uint64_t lastSequence = m_journal.appendBatch(records);
+    if (lastSequence == 0) {
+        Logger::getInstance().error("Wallet journal is not writable");
+        return false;
+    }
+    
+    // Balances were checked above, so each subtraction succeeds
+    m_transactions.reserve(m_transactions.size() + transactions.size());
+    for (const Transaction& transaction : transactions) {
+        applyTransfer(transaction);
+    }
+    ++m_transfersInFlight;
+    
+    bool snapshotDue = lastSequence - m_snapshotSequence >= JOURNAL_SNAPSHOT_INTERVAL;
+    lock.unlock();
+    
+    if (snapshotDue) {
+        requestSnapshot();
+    }
+    
+    // One sync commits the whole batch
+    bool committed = m_journal.waitForCommit(lastSequence);
+    
+    lock.lock();
+    if (!committed) {
+        for (const Transaction& transaction : transactions) {
+            rollbackTransfer(transaction.getId(), transaction.getAssetId(), transaction.getAmount());
+        }
+    }
+    if (--m_transfersInFlight == 0) {
+        m_transfersSettled.notify_all();
+    }
+    lock.unlock();
+    
+    if (!committed) {
+        Logger::getInstance().error("Failed to record batch transfer in the wallet journal");
+        return false;
+    }
+    
+    LUMINA_LOG_INFO("Batch transfer initiated: ", destinations.size(), " destinations");
+    
+    return true;
+}
+
+/**
+ * Gets the number of transactions in the wallet history
+ */
+size_t Wallet::getTransactionCount() const {
+    std::lock_guard<std::mutex> lock(m_stateMutex);
+    return m_savedTransactionCount + m_transactions.size();
+}
+
+/**
+ * Finds a transaction in the wallet history by ID
+ */
+bool Wallet::findTransaction(const std::string& id, Transaction& transaction) {
+    std::lock_guard<std::mutex> saveLock(m_saveMutex);
+    std::lock_guard<std::mutex> lock(m_stateMutex);
+    
+    ensureHistoryIndex();
+    
+    HistoryPosition position;
+    if (!m_history.find(id, position)) {
+        return false;
+    }
+    
+    transaction = getHistoryTransaction(position);
+    return true;
+}
+
+/**
+ * Updates the status of a transaction in the wallet history
+ */
+bool Wallet::setTransactionStatus(const std::string& id, TransactionStatus status) {
+    std::lock_guard<std::mutex> saveLock(m_saveMutex);
+    std::lock_guard<std::mutex> lock(m_stateMutex);
+    
+    ensureHistoryIndex();
+    
+    HistoryPosition position;
+    if (!m_history.find(id, position)) {
+        return false;
+    }
+    
+    m_history.setStatus(position, status);
+    
+    // Unsaved transactions carry their status into the file; saved ones are patched on the next save
+    if (position >= m_savedTransactionCount) {
+        m_transactions[position - m_savedTransactionCount].setStatus(status);
+    } else {
+        m_statusUpdates.emplace_back(position, static_cast<uint32_t>(status));
+    }
+    
+    return true;
+}
+
+/**
+ * Gets one page of the wallet history
+ */
+HistoryPage Wallet::queryHistory(const HistoryQuery& query, std::vector<Transaction>& transactions) {
+    // Saved transactions are read from the wallet file, which a save replaces
+    std::lock_guard<std::mutex> saveLock(m_saveMutex);
+    std::lock_guard<std::mutex> lock(m_stateMutex);
+    
+    ensureHistoryIndex();
+    
+    HistoryPage page = m_history.query(query);
+    
+    transactions.clear();
+    transactions.reserve(page.positions.size());
+    for (HistoryPosition position : page.positions) {
+        transactions.push_back(getHistoryTransaction(position));
+    }
+    
+    return page;
+}
+
 /**
  * Gets the seed phrase for backup purposes
  */
@@ -194,10 +629,26 @@ std::string Wallet::getSeedPhrase(const std::string& password) const {
         return "";
     }
     
-    // TODO: Implement proper password verification
+    if (!m_walletFile.checkPassword(password)) {
+        Logger::getInstance().error("Invalid password");
+        return "";
+    }
     
-    // TODO: Implement proper seed phrase decryption
-    return "abandon ability able about above absent absorb abstract absurd abuse access accident";
+    SeedWordIndices seed;
+    if (!decryptSeed(m_encryptedSeed, seed)) {
+        Logger::getInstance().error("The wallet file holds no valid seed");
+        return "";
+    }
+    
+    std::string phrase;
+    for (uint16_t index : seed) {
+        if (!phrase.empty()) {
+            phrase += ' ';
+        }
+        phrase += SEED_WORDS[index];
+    }
+    memwipe(seed.data(), sizeof(seed));
+    return phrase;
 }
 
 /**
@@ -219,6 +670,111 @@ bool Wallet::synchronize() {
     return true;
 }
 
+/**
+ * Gets the last saved synchronization checkpoint
+ */
+SyncCheckpoint Wallet::getSyncCheckpoint() const {
+    return m_syncCheckpoint;
+}
+
+/**
+ * Stores a new synchronization checkpoint and persists it
+ */
+bool Wallet::setSyncCheckpoint(const SyncCheckpoint& checkpoint) {
+    {
+        std::lock_guard<std::mutex> lock(m_stateMutex);
+        m_syncCheckpoint = checkpoint;
+    }
+    
+    if (!m_isInitialized) {
+        return true;
+    }
+    
+    return saveWallet();
+}
+
+/**
+ * Records an output found by the output scanner and credits its amount
+ */
+bool Wallet::addScannedOutput(const ScannedOutput& output) {
+    std::lock_guard<std::mutex> lock(m_stateMutex);
+    
+    // Outputs can be reported again when a range of blocks is rescanned
+    auto key = std::make_pair(output.txHash, output.outputIndex);
+    if (m_receivedOutputKeys.count(key) != 0) {
+        return false;
+    }
+    
+    AssetId assetId = AssetRegistry::getInstance().intern(output.assetType);
+    if (assetId == INVALID_ASSET_ID) {
+        Logger::getInstance().error("Unsupported asset type in transaction " + output.txHash);
+        return false;
+    }
+    Amount& balance = balanceOf(assetId);
+    if (!balance.checkedAdd(Amount(output.amount), balance)) {
+        Logger::getInstance().error("Balance overflow while crediting transaction " + output.txHash);
+        return false;
+    }
+    m_receivedOutputs.push_back({output.height, output.txHash, output.outputIndex, output.amount, assetId});
+    m_receivedOutputKeys.insert(std::move(key));
+    
+    LUMINA_LOG_INFO("Received ", Amount(output.amount), " ", output.assetType, " in transaction ", output.txHash);
+    
+    return true;
+}
+
+/**
+ * Creates a scanner for the wallet's outputs
+ */
+std::shared_ptr<OutputScanner> Wallet::createOutputScanner() {
+    if (!m_isInitialized) {
+        Logger::getInstance().error("Wallet is not initialized");
+        return nullptr;
+    }
+    
+    // The view key is the hash of the signing key, so it needs no storage of its own
+    crypto::secret_key secretKey;
+    crypto::secret_key viewKey;
+    m_signingKey.getSecretKey(secretKey);
+    crypto::hash_to_scalar(&secretKey, sizeof(secretKey), viewKey);
+    memwipe(&secretKey, sizeof(secretKey));
+    
+    auto scanner = std::make_shared<OutputScanner>(viewKey, m_signingKey.getPublicKey());
+    memwipe(&viewKey, sizeof(viewKey));
+    
+    scanner->setMatchCallback([this](const ScannedOutput& output) {
+        addScannedOutput(output);
+    });
+    
+    return scanner;
+}
+
+/**
+ * Removes outputs received at or above a height after a chain reorganization
+ */
+void Wallet::rollbackToHeight(uint64_t height) {
+    std::lock_guard<std::mutex> lock(m_stateMutex);
+    
+    auto firstRemoved = std::stable_partition(m_receivedOutputs.begin(), m_receivedOutputs.end(),
+                                              [height](const ReceivedOutput& output) { return output.height < height; });
+    
+    for (auto it = firstRemoved; it != m_receivedOutputs.end(); ++it) {
+        // Funds from the removed outputs may already have been spent
+        Amount& balance = balanceOf(it->assetId);
+        if (!balance.checkedSub(Amount(it->amount), balance)) {
+            balance = Amount();
+        }
+        m_receivedOutputKeys.erase(std::make_pair(it->txHash, it->outputIndex));
+    }
+    
+    size_t removed = m_receivedOutputs.end() - firstRemoved;
+    m_receivedOutputs.erase(firstRemoved, m_receivedOutputs.end());
+    
+    if (removed > 0) {
+        Logger::getInstance().warning("Rolled back " + std::to_string(removed) + " outputs above height " + std::to_string(height));
+    }
+}
+
 /**
  * Gets the current status of the wallet
  */
@@ -237,7 +793,7 @@ std::string Wallet::getStatus() const {
 /**
  * Makes a donation to the development team
  */
-bool Wallet::donate(double amount) {
+bool Wallet::donate(Amount amount) {
     // Development team address
     const std::string DEV_TEAM_ADDRESS = "LMTDEVTEAM123456789ABCDEFGHIJKLMNOPQRSTUVW";
     
@@ -245,122 +801,561 @@ bool Wallet::donate(double amount) {
     return transfer(DEV_TEAM_ADDRESS, amount);
 }
 
+/**
+ * Gets a mutable balance slot, growing the table for newly seen assets
+ */
+Amount& Wallet::balanceOf(AssetId assetId) {
+    if (assetId >= m_balances.size()) {
+        m_balances.resize(static_cast<size_t>(assetId) + 1);
+    }
+    return m_balances[assetId];
+}
+
 /**
  * Saves the wallet data to a file
  */
-bool Wallet::saveWallet() const {
-    try {
-        // TODO: Implement proper wallet data serialization and encryption
-        
-        std::ofstream file(m_walletPath, std::ios::binary);
-        if (!file) {
-            Logger::getInstance().error("Failed to open wallet file for writing: " + m_walletPath);
-            return false;
-        }
+bool Wallet::saveWallet() {
+    std::lock_guard<std::mutex> saveLock(m_saveMutex);
+    
+    std::vector<WalletHistoryRecord> records;
+    std::vector<WalletStatusUpdate> statusUpdates;
+    std::string keySection;
+    uint64_t sequence = 0;
+    
+    // Take a consistent copy of the state; the file is written without the lock
+    {
+        // A transfer still waiting for its journal commit may yet be rolled back
+        std::unique_lock<std::mutex> lock(m_stateMutex);
+        m_transfersSettled.wait(lock, [this] { return m_transfersInFlight == 0; });
         
-        // For now, just write some placeholder data
-        file << "LUMINA_WALLET_DATA\n";
-        file << "ADDRESS:" << m_mainAddress << "\n";
+        // Transfers are journaled under the state lock, so the state reflects every appended record
+        sequence = m_journal.getLastSequence();
         
-        for (const auto& balance : m_balances) {
-            file << "BALANCE:" << balance.first << ":" << balance.second << "\n";
+        records.resize(m_transactions.size());
+        for (size_t i = 0; i < m_transactions.size(); ++i) {
+            const Transaction& tx = m_transactions[i];
+            WalletHistoryRecord& record = records[i];
+            std::memset(&record, 0, sizeof(record));
+            if (!copyField(record.id, sizeof(record.id), tx.getId()) ||
+                !copyField(record.fromAddress, sizeof(record.fromAddress), tx.getFromAddress()) ||
+                !copyField(record.toAddress, sizeof(record.toAddress), tx.getToAddress()) ||
+                !copyField(record.assetSymbol, sizeof(record.assetSymbol), tx.getTokenSymbol())) {
+                Logger::getInstance().error("Transaction " + std::string(tx.getId()) + " does not fit in a history record");
+                return false;
+            }
+            record.amount = tx.getAmount().atomicUnits();
+            record.timestamp = static_cast<int64_t>(tx.getTimestamp());
+            record.status = static_cast<uint32_t>(tx.getStatus());
+            copySignature(record, tx);
         }
         
-        file.close();
-        
-        Logger::getInstance().info("Wallet saved to " + m_walletPath);
-        
-        return true;
-    } catch (const std::exception& e) {
-        Logger::getInstance().error("Failed to save wallet: " + std::string(e.what()));
+        keySection = serializeKeys(sequence);
+        statusUpdates.swap(m_statusUpdates);
+    }
+    
+    bool saved = m_walletFile.save(keySection, records, statusUpdates);
+    memwipe(&keySection[0], keySection.size());
+    
+    if (!saved) {
+        // Keep the status changes for the next save
+        std::lock_guard<std::mutex> lock(m_stateMutex);
+        m_statusUpdates.insert(m_statusUpdates.begin(), statusUpdates.begin(), statusUpdates.end());
         return false;
     }
+    
+    // The saved transactions are now part of the mapped history
+    {
+        std::lock_guard<std::mutex> lock(m_stateMutex);
+        m_transactions.erase(m_transactions.begin(), m_transactions.begin() + records.size());
+        m_savedTransactionCount += records.size();
+        m_snapshotSequence = sequence;
+    }
+    
+    // The journal may not be open yet while a new wallet is created
+    if (sequence > 0) {
+        m_journal.truncateThrough(sequence);
+    }
+    
+    LUMINA_LOG_INFO("Wallet saved to ", m_walletPath);
+    
+    return true;
 }
 
 /**
  * Loads the wallet data from a file
  */
 bool Wallet::loadWallet() {
-    try {
-        std::ifstream file(m_walletPath, std::ios::binary);
-        if (!file) {
-            Logger::getInstance().error("Failed to open wallet file for reading: " + m_walletPath);
+    if (!m_walletFile.exists()) {
+        return false;
+    }
+    
+    std::string keySection;
+    if (!m_walletFile.load(keySection)) {
+        return false;
+    }
+    
+    bool loaded = deserializeKeys(keySection);
+    memwipe(&keySection[0], keySection.size());
+    
+    if (!loaded) {
+        Logger::getInstance().error("Corrupted key section in wallet file: " + m_walletPath);
+        return false;
+    }
+    
+    m_savedTransactionCount = m_walletFile.getHistoryCount();
+    
+    if (!openJournal(false)) {
+        return false;
+    }
+    
+    Logger::getInstance().info("Wallet loaded from " + m_walletPath + " with " +
+                               std::to_string(getTransactionCount()) + " transactions");
+    
+    return true;
+}
+
+/**
+ * Creates and signs a transfer and builds its journal record
+ *
+ * Called with the state lock held. Nothing is changed if it fails.
+ */
+bool Wallet::prepareTransfer(const std::string& toAddress, Amount amount, AssetId assetId, size_t nonce,
+                             Transaction& transaction, JournalRecord& record) {
+    // The transaction would silently truncate a longer address
+    if (toAddress.size() > TRANSACTION_ADDRESS_LENGTH) {
+        Logger::getInstance().error("Recipient address is longer than " + std::to_string(TRANSACTION_ADDRESS_LENGTH) +
+                                    " characters");
+        return false;
+    }
+    
+    // Create a new transaction; its position in the history keeps the ID unique
+    transaction = Transaction(m_mainAddress, toAddress, amount, assetId, nonce);
+    
+    if (!transaction.sign(m_signingKey)) {
+        return false;
+    }
+    
+    // TODO: Submit the transaction to the network
+    
+    std::memset(&record, 0, sizeof(record));
+    if (!copyField(record.txId, sizeof(record.txId), transaction.getId()) ||
+        !copyField(record.toAddress, sizeof(record.toAddress), transaction.getToAddress()) ||
+        !copyField(record.assetSymbol, sizeof(record.assetSymbol), transaction.getTokenSymbol())) {
+        Logger::getInstance().error("Transaction " + std::string(transaction.getId()) + " does not fit in a journal record");
+        return false;
+    }
+    record.amount = amount.atomicUnits();
+    record.timestamp = static_cast<int64_t>(transaction.getTimestamp());
+    record.status = static_cast<uint32_t>(transaction.getStatus());
+    copySignature(record, transaction);
+    
+    return true;
+}
+
+/**
+ * Applies a journaled transfer to the wallet state
+ *
+ * Called with the state lock held, after the balance has been checked.
+ */
+void Wallet::applyTransfer(const Transaction& transaction) {
+    // For now, just simulate a successful transaction
+    Amount& balance = balanceOf(transaction.getAssetId());
+    balance.checkedSub(transaction.getAmount(), balance);
+    
+    m_transactions.push_back(transaction);
+    if (m_historyIndexed) {
+        m_history.add(transaction.getId(), transaction.getToAddress(), transaction.getTimestamp(), transaction.getStatus());
+    }
+}
+
+/**
+ * Undoes a transfer whose journal record failed to commit
+ *
+ * Called with the state lock held. No save contains the transfer yet, as
+ * saves wait for the transfers in flight.
+ */
+void Wallet::rollbackTransfer(std::string_view txId, AssetId assetId, Amount amount) {
+    Amount& balance = balanceOf(assetId);
+    balance.checkedAdd(amount, balance);
+    
+    auto it = std::find_if(m_transactions.begin(), m_transactions.end(),
+                           [txId](const Transaction& transaction) { return transaction.getId() == txId; });
+    if (it != m_transactions.end()) {
+        m_transactions.erase(it);
+    }
+    
+    // Later transactions moved down a position, so the index is rebuilt on next use
+    m_history.clear();
+    m_historyIndexed = false;
+}
+
+/**
+ * Opens the journal and replays the transfers made since the last save
+ */
+bool Wallet::openJournal(bool discardExisting) {
+    std::string journalPath = m_walletPath + ".journal";
+    
+    // A journal left next to a newly created wallet belongs to an older wallet
+    if (discardExisting) {
+        std::remove(journalPath.c_str());
+    }
+    
+    std::vector<JournalRecord> replay;
+    if (!m_journal.open(journalPath, m_snapshotSequence, replay)) {
+        return false;
+    }
+    
+    // Records pass their checksum, so invalid fields mean the journal was written wrongly
+    for (const auto& record : replay) {
+        TransactionStatus status;
+        if (!transactionStatusFromValue(record.status, status)) {
+            Logger::getInstance().error("Corrupted wallet journal record " + std::to_string(record.sequence) +
+                                        ": invalid status " + std::to_string(record.status));
+            m_journal.close();
             return false;
         }
-        
-        // TODO: Implement proper wallet data deserialization and decryption
-        
-        std::string line;
-        if (!std::getline(file, line) || line != "LUMINA_WALLET_DATA") {
-            Logger::getInstance().error("Invalid wallet file format");
+        if (record.signatureSize != 0 && record.signatureSize != sizeof(record.signature)) {
+            Logger::getInstance().error("Corrupted wallet journal record " + std::to_string(record.sequence) +
+                                        ": invalid signature size " + std::to_string(record.signatureSize));
+            m_journal.close();
             return false;
         }
+    }
+    
+    m_transactions.reserve(m_transactions.size() + replay.size());
+    for (const auto& record : replay) {
+        applyJournalRecord(record);
+    }
+    
+    if (!replay.empty()) {
+        Logger::getInstance().info("Replayed " + std::to_string(replay.size()) + " transfers from the wallet journal");
+    }
+    
+    return true;
+}
+
+/**
+ * Applies a journaled transfer to the wallet state
+ */
+void Wallet::applyJournalRecord(const JournalRecord& record) {
+    std::string_view txId = readField(record.txId, sizeof(record.txId));
+    AssetId assetId = AssetRegistry::getInstance().intern(readField(record.assetSymbol, sizeof(record.assetSymbol)));
+    if (assetId == INVALID_ASSET_ID) {
+        Logger::getInstance().warning("Journaled transfer " + std::string(txId) + " has an unsupported asset type");
+        return;
+    }
+    Amount amount(record.amount);
+    
+    std::lock_guard<std::mutex> lock(m_stateMutex);
+    
+    Amount& balance = balanceOf(assetId);
+    if (!balance.checkedSub(amount, balance)) {
+        Logger::getInstance().warning("Journaled transfer " + std::string(txId) + " exceeds the saved balance");
+        balance = Amount();
+    }
+    
+    m_transactions.emplace_back(txId, m_mainAddress, readField(record.toAddress, sizeof(record.toAddress)),
+                                amount, assetId, static_cast<time_t>(record.timestamp),
+                                static_cast<TransactionStatus>(record.status));
+    restoreSignature(record, m_transactions.back());
+    if (m_historyIndexed) {
+        const Transaction& transaction = m_transactions.back();
+        m_history.add(txId, transaction.getToAddress(), record.timestamp, transaction.getStatus());
+    }
+}
+
+/**
+ * Builds the history index over saved and unsaved transactions
+ */
+void Wallet::ensureHistoryIndex() {
+    if (m_historyIndexed) {
+        return;
+    }
+    
+    m_history.clear();
+    
+    for (size_t i = 0; i < m_savedTransactionCount; ++i) {
+        const WalletHistoryRecord& record = m_walletFile.getHistoryRecord(i);
         
-        while (std::getline(file, line)) {
-            if (line.substr(0, 8) == "ADDRESS:") {
-                m_mainAddress = line.substr(8);
-            } else if (line.substr(0, 8) == "BALANCE:") {
-                size_t pos = line.find(':', 8);
-                if (pos != std::string::npos) {
-                    std::string token = line.substr(8, pos - 8);
-                    double amount = std::stod(line.substr(pos + 1));
-                    m_balances[token] = amount;
-                }
-            }
+        // A damaged record is reported and marked failed, keeping the positions of the others
+        TransactionStatus status;
+        if (!m_walletFile.isHistoryRecordValid(i)) {
+            Logger::getInstance().error("Corrupted wallet history record " + std::to_string(i) + ": checksum mismatch");
+            status = TransactionStatus::FAILED;
+        } else if (!transactionStatusFromValue(record.status, status)) {
+            Logger::getInstance().error("Corrupted wallet history record " + std::to_string(i) +
+                                        ": invalid status " + std::to_string(record.status));
+            status = TransactionStatus::FAILED;
         }
         
-        file.close();
-        
-        Logger::getInstance().info("Wallet loaded from " + m_walletPath);
+        m_history.add(readField(record.id, sizeof(record.id)), readField(record.toAddress, sizeof(record.toAddress)),
+                      record.timestamp, status);
+    }
+    
+    for (const auto& transaction : m_transactions) {
+        m_history.add(transaction.getId(), transaction.getToAddress(), transaction.getTimestamp(),
+                      transaction.getStatus());
+    }
+    
+    // Status changes not yet saved are newer than the file
+    for (const auto& update : m_statusUpdates) {
+        m_history.setStatus(update.first, static_cast<TransactionStatus>(update.second));
+    }
+    
+    m_historyIndexed = true;
+}
+
+/**
+ * Resolves a history position to a saved or unsaved transaction
+ */
+Transaction Wallet::getHistoryTransaction(HistoryPosition position) const {
+    // Unsaved transactions are kept up to date by setTransactionStatus
+    if (position >= m_savedTransactionCount) {
+        return m_transactions[position - m_savedTransactionCount];
+    }
+    
+    // Saved records may have unsaved status changes, which the index holds
+    const WalletHistoryRecord& record = m_walletFile.getHistoryRecord(position);
+    AssetId assetId = AssetRegistry::getInstance().intern(readField(record.assetSymbol, sizeof(record.assetSymbol)));
+    Transaction transaction(readField(record.id, sizeof(record.id)),
+                            readField(record.fromAddress, sizeof(record.fromAddress)),
+                            readField(record.toAddress, sizeof(record.toAddress)),
+                            Amount(record.amount), assetId, static_cast<time_t>(record.timestamp),
+                            m_history.getStatus(position));
+    
+    // A damaged record or a corrupt signature leaves the transaction unsigned
+    if (!m_walletFile.isHistoryRecordValid(position)) {
+        return transaction;
+    }
+    if (!restoreSignature(record, transaction)) {
+        Logger::getInstance().error("Corrupted wallet history record " + std::to_string(position) +
+                                    ": invalid signature size " + std::to_string(record.signatureSize));
+    }
+    
+    return transaction;
+}
+
+/**
+ * Asks the snapshot thread to save the wallet
+ */
+void Wallet::requestSnapshot() {
+    {
+        std::lock_guard<std::mutex> lock(m_snapshotMutex);
+        m_snapshotPending = true;
+    }
+    m_snapshotRequested.notify_one();
+}
+
+/**
+ * Main loop of the snapshot thread
+ */
+void Wallet::snapshotLoop() {
+    std::unique_lock<std::mutex> lock(m_snapshotMutex);
+    
+    while (true) {
+        m_snapshotRequested.wait(lock, [this] { return m_snapshotPending || m_stopSnapshots; });
+        if (m_stopSnapshots) {
+            return;
+        }
+        m_snapshotPending = false;
         
-        return true;
-    } catch (const std::exception& e) {
-        Logger::getInstance().error("Failed to load wallet: " + std::string(e.what()));
-        return false;
+        lock.unlock();
+        saveWallet();
+        lock.lock();
+    }
+}
+
+/**
+ * Serializes the wallet's keys and state into the key section
+ */
+std::string Wallet::serializeKeys(uint64_t snapshotSequence) const {
+    const AssetRegistry& registry = AssetRegistry::getInstance();
+    std::string out;
+    
+    writeString(out, m_mainAddress);
+    writeString(out, m_encryptedSeed);
+    crypto::secret_key secretKey;
+    m_signingKey.getSecretKey(secretKey);
+    writeString(out, std::string_view(reinterpret_cast<const char*>(&secretKey), sizeof(secretKey)));
+    memwipe(&secretKey, sizeof(secretKey));
+    
+    writeUint64(out, m_balances.size());
+    for (size_t assetId = 0; assetId < m_balances.size(); ++assetId) {
+        writeString(out, registry.getSymbol(static_cast<AssetId>(assetId)));
+        writeUint64(out, m_balances[assetId].atomicUnits());
+    }
+    
+    writeUint64(out, m_syncCheckpoint.height);
+    writeUint64(out, m_syncCheckpoint.recentBlocks.size());
+    for (const auto& block : m_syncCheckpoint.recentBlocks) {
+        writeUint64(out, block.height);
+        writeString(out, block.hash);
+    }
+    
+    writeUint64(out, m_receivedOutputs.size());
+    for (const auto& output : m_receivedOutputs) {
+        writeUint64(out, output.height);
+        writeString(out, output.txHash);
+        writeUint64(out, output.outputIndex);
+        writeUint64(out, output.amount);
+        writeString(out, registry.getSymbol(output.assetId));
     }
+    
+    writeUint64(out, snapshotSequence);
+    
+    return out;
 }
 
 /**
- * Generates a random 12-word seed phrase
+ * Restores the wallet's keys and state from the key section
  */
-std::string Wallet::generateSeed() const {
-    // Initialize random number generator
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<> dis(0, SEED_WORDS.size() - 1);
+bool Wallet::deserializeKeys(const std::string& keySection) {
+    AssetRegistry& registry = AssetRegistry::getInstance();
+    size_t pos = 0;
+    uint64_t count = 0;
+    
+    std::string secretKeyBytes;
+    if (!readString(keySection, pos, m_mainAddress) || !readString(keySection, pos, m_encryptedSeed) ||
+        !readString(keySection, pos, secretKeyBytes) || !readUint64(keySection, pos, count)) {
+        return false;
+    }
     
-    // Generate 12 random words
-    std::vector<std::string> seedWords;
-    for (int i = 0; i < 12; ++i) {
-        seedWords.push_back(SEED_WORDS[dis(gen)]);
+    crypto::secret_key secretKey;
+    bool keyValid = secretKeyBytes.size() == sizeof(secretKey);
+    if (keyValid) {
+        std::memcpy(&secretKey, secretKeyBytes.data(), sizeof(secretKey));
+        keyValid = m_signingKey.setSecretKey(secretKey);
+    }
+    memwipe(&secretKeyBytes[0], secretKeyBytes.size());
+    if (!keyValid) {
+        return false;
     }
     
-    // Combine words into a seed phrase
-    std::string seedPhrase;
-    for (const auto& word : seedWords) {
-        if (!seedPhrase.empty()) {
-            seedPhrase += " ";
+    m_balances.clear();
+    for (uint64_t i = 0; i < count; ++i) {
+        std::string symbol;
+        uint64_t atomicUnits = 0;
+        if (!readString(keySection, pos, symbol) || !readUint64(keySection, pos, atomicUnits)) {
+            return false;
         }
-        seedPhrase += word;
+        AssetId assetId = registry.intern(symbol);
+        if (assetId == INVALID_ASSET_ID) {
+            return false;
+        }
+        balanceOf(assetId) = Amount(atomicUnits);
     }
     
-    return seedPhrase;
+    m_syncCheckpoint = SyncCheckpoint();
+    if (!readUint64(keySection, pos, m_syncCheckpoint.height) || !readUint64(keySection, pos, count)) {
+        return false;
+    }
+    for (uint64_t i = 0; i < count; ++i) {
+        BlockId block;
+        if (!readUint64(keySection, pos, block.height) || !readString(keySection, pos, block.hash)) {
+            return false;
+        }
+        m_syncCheckpoint.recentBlocks.push_back(block);
+    }
+    
+    m_receivedOutputs.clear();
+    m_receivedOutputKeys.clear();
+    if (!readUint64(keySection, pos, count)) {
+        return false;
+    }
+    for (uint64_t i = 0; i < count; ++i) {
+        ReceivedOutput output;
+        uint64_t outputIndex = 0;
+        std::string symbol;
+        if (!readUint64(keySection, pos, output.height) || !readString(keySection, pos, output.txHash) ||
+            !readUint64(keySection, pos, outputIndex) || !readUint64(keySection, pos, output.amount) ||
+            !readString(keySection, pos, symbol)) {
+            return false;
+        }
+        output.outputIndex = static_cast<uint32_t>(outputIndex);
+        output.assetId = registry.intern(symbol);
+        if (output.assetId == INVALID_ASSET_ID) {
+            return false;
+        }
+        m_receivedOutputKeys.emplace(output.txHash, output.outputIndex);
+        m_receivedOutputs.push_back(output);
+    }
+    
+    return readUint64(keySection, pos, m_snapshotSequence) && pos == keySection.size();
 }
 
 /**
- * Encrypts a seed phrase with a password
+ * Generates a random seed
  */
-std::string Wallet::encryptSeed(const std::string& seed, const std::string& password) const {
-    // TODO: Implement proper encryption
-    return seed; // Placeholder
+SeedWordIndices Wallet::generateSeed() const {
+    // Words are drawn from the shared CSPRNG, so no generator is set up per call
+    SeedWordIndices seed;
+    for (auto& index : seed) {
+        index = static_cast<uint16_t>(crypto::rand_idx<size_t>(SEED_WORDS.size()));
+    }
+    return seed;
 }
 
 /**
- * Decrypts a seed phrase with a password
+ * Derives the signing key from a seed
+ *
+ * The slow hash makes guessing seeds expensive. It only runs when a wallet
+ * is created or recovered: the derived key is saved in the wallet file and
+ * kept encrypted in memory, so opening a wallet skips it.
  */
-std::string Wallet::decryptSeed(const std::string& encryptedSeed, const std::string& password) const {
-    // TODO: Implement proper decryption
-    return encryptedSeed; // Placeholder
+bool Wallet::deriveSigningKey(const SeedWordIndices& seed) {
+    uint8_t bytes[SEED_BYTES];
+    packSeed(seed, bytes);
+    crypto::hash hash;
+    crypto::cn_slow_hash(bytes, sizeof(bytes), hash);
+    memwipe(bytes, sizeof(bytes));
+    
+    crypto::secret_key secretKey;
+    crypto::hash_to_scalar(&hash, sizeof(hash), secretKey);
+    memwipe(&hash, sizeof(hash));
+    
+    bool valid = m_signingKey.setSecretKey(secretKey);
+    memwipe(&secretKey, sizeof(secretKey));
+    return valid;
+}
+
+/**
+ * Encrypts a seed under the seed key of the wallet file, as IV || cipher
+ */
+std::string Wallet::encryptSeed(const SeedWordIndices& seed) const {
+    uint8_t bytes[SEED_BYTES];
+    packSeed(seed, bytes);
+    
+    crypto::chacha_iv iv = crypto::rand<crypto::chacha_iv>();
+    std::string encryptedSeed(sizeof(iv) + sizeof(bytes), '\0');
+    std::memcpy(&encryptedSeed[0], &iv, sizeof(iv));
+    crypto::chacha20(bytes, sizeof(bytes), m_walletFile.getSeedKey(), iv, &encryptedSeed[sizeof(iv)]);
+    memwipe(bytes, sizeof(bytes));
+    return encryptedSeed;
+}
+
+/**
+ * Decrypts a seed encrypted by encryptSeed
+ */
+bool Wallet::decryptSeed(const std::string& encryptedSeed, SeedWordIndices& seed) const {
+    crypto::chacha_iv iv;
+    uint8_t bytes[SEED_BYTES];
+    if (encryptedSeed.size() != sizeof(iv) + sizeof(bytes)) {
+        return false;
+    }
+    
+    std::memcpy(&iv, encryptedSeed.data(), sizeof(iv));
+    crypto::chacha20(encryptedSeed.data() + sizeof(iv), sizeof(bytes), m_walletFile.getSeedKey(), iv,
+                     reinterpret_cast<char*>(bytes));
+    unpackSeed(bytes, seed);
+    memwipe(bytes, sizeof(bytes));
+    
+    for (uint16_t index : seed) {
+        if (index >= SEED_WORDS.size()) {
+            memwipe(seed.data(), sizeof(seed));
+            return false;
+        }
+    }
+    return true;
 }
 
 } // namespace lumina
\ No newline at end of file
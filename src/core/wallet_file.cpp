@@ -0,0 +1,458 @@
+/**
+ * LuminaChain Wallet - Wallet File Format Implementation
+ *
+ * This file implements the WalletFile class which reads and writes the
+ * binary wallet file.
+ *
+ * Copyright (c) 2023 LuminaChain Development Team
+ * Licensed under MIT License
+ */
+
+#include "core/wallet_file.h"
+#include "core/transaction.h"
+#include "utils/file_utils.h"
+#include "utils/logger.h"
+#include "crypto/crypto.h"
+#include "memwipe.h"
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+
+extern "C" {
+#include "crypto/hmac-keccak.h"
+}
+
+namespace lumina {
+
+// Magic bytes at the start of a wallet file
+const char WALLET_FILE_MAGIC[8] = {'L', 'U', 'M', 'W', 'A', 'L', 'L', 'T'};
+
+// Domain separator for deriving the MAC key from the encryption key
+const char WALLET_MAC_KEY_DOMAIN[] = "lumina-wallet-mac";
+
+// Domain separator for deriving the seed key from the encryption key
+const char WALLET_SEED_KEY_DOMAIN[] = "lumina-wallet-seed";
+
+/**
+ * Constructor - derives the encryption key from the password
+ */
+WalletFile::WalletFile(const std::string& path, const std::string& password)
+    : m_path(path),
+      m_historyPath(path + ".history"),
+      m_history(nullptr),
+      m_historyCount(0) {
+
+    // The key derivation is deliberately slow, so it runs once per wallet
+    crypto::generate_chacha_key(password.data(), password.size(), m_encryptionKey, 1);
+
+    std::string macKeyInput(reinterpret_cast<const char*>(m_encryptionKey.data()), m_encryptionKey.size());
+    macKeyInput += WALLET_MAC_KEY_DOMAIN;
+    crypto::cn_fast_hash(macKeyInput.data(), macKeyInput.size(), m_macKey);
+    memwipe(&macKeyInput[0], macKeyInput.size());
+
+    std::string seedKeyInput(reinterpret_cast<const char*>(m_encryptionKey.data()), m_encryptionKey.size());
+    seedKeyInput += WALLET_SEED_KEY_DOMAIN;
+    crypto::hash seedKey;
+    crypto::cn_fast_hash(seedKeyInput.data(), seedKeyInput.size(), seedKey);
+    std::memcpy(m_seedKey.data(), &seedKey, m_seedKey.size());
+    memwipe(&seedKey, sizeof(seedKey));
+    memwipe(&seedKeyInput[0], seedKeyInput.size());
+}
+
+/**
+ * Checks whether the wallet file exists
+ */
+bool WalletFile::exists() const {
+    std::error_code ec;
+    return std::filesystem::exists(m_path, ec);
+}
+
+/**
+ * Checks a password against the one the wallet file was opened with
+ */
+bool WalletFile::checkPassword(const std::string& password) const {
+    crypto::chacha_key key;
+    crypto::generate_chacha_key(password.data(), password.size(), key, 1);
+
+    uint8_t difference = 0;
+    for (size_t i = 0; i < key.size(); ++i) {
+        difference |= key[i] ^ m_encryptionKey[i];
+    }
+    memwipe(key.data(), key.size());
+    return difference == 0;
+}
+
+/**
+ * Gets the key that encrypts the seed inside the key section
+ */
+const crypto::chacha_key& WalletFile::getSeedKey() const {
+    return m_seedKey;
+}
+
+/**
+ * Loads the wallet file and maps its history segment
+ */
+bool WalletFile::load(std::string& keySection) {
+    m_historyMapping.reset();
+    m_history = nullptr;
+    m_historyCount = 0;
+
+    MappedFile mapping;
+    if (!mapping.open(m_path)) {
+        return false;
+    }
+
+    const uint8_t* data = mapping.data();
+    size_t size = mapping.size();
+
+    WalletFileHeader header;
+    if (size < sizeof(header)) {
+        Logger::getInstance().error("Invalid wallet file format");
+        return false;
+    }
+    std::memcpy(&header, data, sizeof(header));
+
+    if (std::memcmp(header.magic, WALLET_FILE_MAGIC, sizeof(header.magic)) != 0) {
+        Logger::getInstance().error("Invalid wallet file format");
+        return false;
+    }
+
+    if (header.version != WALLET_FILE_VERSION || header.historyRecordSize != sizeof(WalletHistoryRecord)) {
+        Logger::getInstance().error("Unsupported wallet file version: " + std::to_string(header.version));
+        return false;
+    }
+
+    size_t bodySize = size - sizeof(header);
+    if (header.keySectionSize > bodySize ||
+        header.statusUpdateCount != (bodySize - header.keySectionSize) / sizeof(WalletStatusRecord) ||
+        (bodySize - header.keySectionSize) % sizeof(WalletStatusRecord) != 0) {
+        Logger::getInstance().error("Corrupted wallet file: " + m_path);
+        return false;
+    }
+
+    const char* cipher = reinterpret_cast<const char*>(data + sizeof(header));
+    std::vector<WalletStatusRecord> statusRecords(header.statusUpdateCount);
+    if (!statusRecords.empty()) {
+        std::memcpy(statusRecords.data(), cipher + header.keySectionSize,
+                    statusRecords.size() * sizeof(WalletStatusRecord));
+    }
+
+    uint8_t mac[sizeof(header.mac)];
+    computeMac(header, cipher, statusRecords.data(), mac);
+
+    uint8_t difference = 0;
+    for (size_t i = 0; i < sizeof(mac); ++i) {
+        difference |= mac[i] ^ header.mac[i];
+    }
+    if (difference != 0) {
+        Logger::getInstance().error("Invalid password or corrupted wallet file");
+        return false;
+    }
+
+    // The status updates are authenticated with the record count, which bounds their indices
+    for (const WalletStatusRecord& update : statusRecords) {
+        if (update.index >= header.historyCount) {
+            Logger::getInstance().error("Corrupted wallet file: " + m_path);
+            return false;
+        }
+    }
+
+    // A save may have been interrupted before all of its status updates were patched
+    if (!statusRecords.empty() && !patchStatuses(statusRecords)) {
+        Logger::getInstance().error("Failed to apply status updates to wallet history: " + m_historyPath);
+        return false;
+    }
+    m_unpatchedStatuses.clear();
+
+    std::unique_ptr<MappedFile> history;
+    if (header.historyCount > 0) {
+        history = mapHistory(header.historyCount);
+        if (!history) {
+            Logger::getInstance().error("Corrupted wallet history: " + m_historyPath);
+            return false;
+        }
+    }
+
+    crypto::chacha_iv iv;
+    std::memcpy(&iv, header.iv, sizeof(iv));
+
+    keySection.resize(header.keySectionSize);
+    if (!keySection.empty()) {
+        crypto::chacha20(cipher, keySection.size(), m_encryptionKey, iv, &keySection[0]);
+    }
+
+    m_historyMapping = std::move(history);
+    m_history = m_historyMapping ? reinterpret_cast<const WalletHistoryRecord*>(m_historyMapping->data()) : nullptr;
+    m_historyCount = header.historyCount;
+
+    return true;
+}
+
+/**
+ * Saves the wallet atomically
+ */
+bool WalletFile::save(const std::string& keySection, const std::vector<WalletHistoryRecord>& newRecords,
+                      const std::vector<WalletStatusUpdate>& statusUpdates) {
+    // Updates a previous save could not patch are carried until they are
+    std::vector<WalletStatusRecord> statusRecords = m_unpatchedStatuses;
+    for (const auto& update : statusUpdates) {
+        if (update.first < m_historyCount) {
+            statusRecords.push_back({update.first, update.second, 0});
+        }
+    }
+
+    WalletFileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, WALLET_FILE_MAGIC, sizeof(header.magic));
+    header.version = WALLET_FILE_VERSION;
+    header.historyRecordSize = sizeof(WalletHistoryRecord);
+    header.keySectionSize = keySection.size();
+    header.historyCount = m_historyCount + newRecords.size();
+    header.statusUpdateCount = statusRecords.size();
+
+    // The new records are written first; the wallet file only refers to them once they are on disk
+    if (!newRecords.empty() && !appendHistory(newRecords)) {
+        return false;
+    }
+
+    // A fresh IV for every save, as the key stays the same
+    crypto::chacha_iv iv = crypto::rand<crypto::chacha_iv>();
+    std::memcpy(header.iv, &iv, sizeof(header.iv));
+
+    std::string cipher(keySection.size(), '\0');
+    if (!cipher.empty()) {
+        crypto::chacha20(keySection.data(), keySection.size(), m_encryptionKey, iv, &cipher[0]);
+    }
+    computeMac(header, cipher.data(), statusRecords.data(), header.mac);
+
+    if (!writeKeyFile(header, cipher, statusRecords)) {
+        return false;
+    }
+
+    // The wallet file now holds the status updates, so patching them can fail without losing them
+    size_t savedCount = m_historyCount;
+    m_historyCount = header.historyCount;
+    if (!statusRecords.empty()) {
+        if (patchStatuses(statusRecords)) {
+            m_unpatchedStatuses.clear();
+        } else {
+            Logger::getInstance().warning("Failed to patch wallet history, retrying on the next save: " + m_historyPath);
+            m_unpatchedStatuses = statusRecords;
+        }
+    }
+
+    // Remap to see the new and patched records
+    if (!newRecords.empty() || !statusRecords.empty()) {
+        std::unique_ptr<MappedFile> history = mapHistory(header.historyCount);
+        if (!history) {
+            // The caller keeps its records and status updates, and the next save writes them again
+            m_historyCount = savedCount;
+            Logger::getInstance().error("Failed to map wallet history: " + m_historyPath);
+            return false;
+        }
+        m_historyMapping = std::move(history);
+        m_history = reinterpret_cast<const WalletHistoryRecord*>(m_historyMapping->data());
+    }
+
+    return true;
+}
+
+/**
+ * Gets the number of history records in the file
+ */
+size_t WalletFile::getHistoryCount() const {
+    return m_historyCount;
+}
+
+/**
+ * Gets a history record
+ */
+const WalletHistoryRecord& WalletFile::getHistoryRecord(size_t index) const {
+    return m_history[index];
+}
+
+/**
+ * Checks the checksum of a history record
+ */
+bool WalletFile::isHistoryRecordValid(size_t index) const {
+    const WalletHistoryRecord& record = m_history[index];
+    uint8_t checksum[sizeof(record.checksum)];
+    computeChecksum(index, record, checksum);
+    return std::memcmp(checksum, record.checksum, sizeof(checksum)) == 0;
+}
+
+/**
+ * Computes the MAC of a header, its encrypted key section and its status updates
+ */
+void WalletFile::computeMac(const WalletFileHeader& header, const char* keySection,
+                            const WalletStatusRecord* statusRecords, uint8_t* mac) const {
+    WalletFileHeader unsignedHeader = header;
+    std::memset(unsignedHeader.mac, 0, sizeof(unsignedHeader.mac));
+
+    hmac_keccak_state state;
+    hmac_keccak_init(&state, reinterpret_cast<const uint8_t*>(&m_macKey), sizeof(m_macKey));
+    hmac_keccak_update(&state, reinterpret_cast<const uint8_t*>(&unsignedHeader), sizeof(unsignedHeader));
+    hmac_keccak_update(&state, reinterpret_cast<const uint8_t*>(keySection), header.keySectionSize);
+    hmac_keccak_update(&state, reinterpret_cast<const uint8_t*>(statusRecords),
+                       header.statusUpdateCount * sizeof(WalletStatusRecord));
+    hmac_keccak_finish(&state, mac);
+}
+
+/**
+ * Computes the checksum of a history record at an index
+ */
+void WalletFile::computeChecksum(uint64_t index, const WalletHistoryRecord& record, uint8_t* checksum) const {
+    uint8_t digest[HASH_SIZE];
+    hmac_keccak_state state;
+    hmac_keccak_init(&state, reinterpret_cast<const uint8_t*>(&m_macKey), sizeof(m_macKey));
+    hmac_keccak_update(&state, reinterpret_cast<const uint8_t*>(&index), sizeof(index));
+    hmac_keccak_update(&state, reinterpret_cast<const uint8_t*>(&record), offsetof(WalletHistoryRecord, checksum));
+    hmac_keccak_finish(&state, digest);
+    std::memcpy(checksum, digest, sizeof(record.checksum));
+}
+
+/**
+ * Appends records to the history file after the saved ones
+ */
+bool WalletFile::appendHistory(const std::vector<WalletHistoryRecord>& newRecords) {
+    std::vector<WalletHistoryRecord> records = newRecords;
+    for (size_t i = 0; i < records.size(); ++i) {
+        computeChecksum(m_historyCount + i, records[i], records[i].checksum);
+    }
+
+    // A wallet without history starts a new file, discarding whatever an older wallet left there
+    bool create = m_historyCount == 0;
+    FILE* file = std::fopen(m_historyPath.c_str(), create ? "wb" : "r+b");
+    if (!file) {
+        Logger::getInstance().error("Failed to open wallet history for writing: " + m_historyPath);
+        return false;
+    }
+
+    // Records past the saved count were left by an interrupted save and are overwritten
+    uint64_t end = static_cast<uint64_t>(m_historyCount) * sizeof(WalletHistoryRecord);
+    bool written = std::fseek(file, static_cast<long>(end), SEEK_SET) == 0 &&
+                   writeAll(file, records.data(), records.size() * sizeof(WalletHistoryRecord)) &&
+                   syncFile(file);
+
+    if (std::fclose(file) != 0) {
+        written = false;
+    }
+
+    if (!written) {
+        Logger::getInstance().error("Failed to write wallet history: " + m_historyPath);
+        return false;
+    }
+
+    if (create) {
+        syncDirectory(m_historyPath);
+    }
+
+    return true;
+}
+
+/**
+ * Patches status updates into saved history records, renewing their checksums
+ *
+ * The caller makes sure every update refers to a record in the file.
+ */
+bool WalletFile::patchStatuses(const std::vector<WalletStatusRecord>& statusRecords) {
+    FILE* file = std::fopen(m_historyPath.c_str(), "r+b");
+    if (!file) {
+        return false;
+    }
+
+    // Records are rewritten whole; one torn by a crash is repaired when the wallet file's updates are patched again
+    bool written = true;
+    for (const WalletStatusRecord& update : statusRecords) {
+        WalletHistoryRecord record;
+        long offset = static_cast<long>(update.index * sizeof(WalletHistoryRecord));
+        written = std::fseek(file, offset, SEEK_SET) == 0 && std::fread(&record, sizeof(record), 1, file) == 1;
+        if (!written) {
+            break;
+        }
+
+        // A damaged record must not gain a valid checksum; only its status may be torn
+        bool intact = false;
+        TransactionStatus status;
+        for (uint32_t value = 0; !intact && transactionStatusFromValue(value, status); ++value) {
+            WalletHistoryRecord candidate = record;
+            candidate.status = value;
+            uint8_t checksum[sizeof(record.checksum)];
+            computeChecksum(update.index, candidate, checksum);
+            intact = std::memcmp(checksum, record.checksum, sizeof(checksum)) == 0;
+        }
+        if (!intact) {
+            Logger::getInstance().error("Corrupted wallet history record " + std::to_string(update.index) +
+                                        ", its status is not updated");
+            continue;
+        }
+
+        record.status = update.status;
+        computeChecksum(update.index, record, record.checksum);
+        written = std::fseek(file, offset, SEEK_SET) == 0 && writeAll(file, &record, sizeof(record));
+        if (!written) {
+            break;
+        }
+    }
+
+    written = written && syncFile(file);
+
+    if (std::fclose(file) != 0) {
+        written = false;
+    }
+
+    return written;
+}
+
+/**
+ * Maps the history file, which must hold at least a number of records
+ */
+std::unique_ptr<MappedFile> WalletFile::mapHistory(size_t historyCount) const {
+    auto mapping = std::make_unique<MappedFile>();
+    if (!mapping->open(m_historyPath) || mapping->size() / sizeof(WalletHistoryRecord) < historyCount) {
+        return nullptr;
+    }
+    return mapping;
+}
+
+/**
+ * Writes the wallet file through a temporary file renamed over it
+ */
+bool WalletFile::writeKeyFile(const WalletFileHeader& header, const std::string& cipher,
+                              const std::vector<WalletStatusRecord>& statusRecords) {
+    std::string tempPath = m_path + ".tmp";
+    FILE* file = std::fopen(tempPath.c_str(), "wb");
+    if (!file) {
+        Logger::getInstance().error("Failed to open wallet file for writing: " + tempPath);
+        return false;
+    }
+
+    bool written = writeAll(file, &header, sizeof(header)) &&
+                   writeAll(file, cipher.data(), cipher.size()) &&
+                   writeAll(file, statusRecords.data(), statusRecords.size() * sizeof(WalletStatusRecord)) &&
+                   syncFile(file);
+
+    if (std::fclose(file) != 0) {
+        written = false;
+    }
+
+    if (!written) {
+        Logger::getInstance().error("Failed to write wallet file: " + tempPath);
+        std::remove(tempPath.c_str());
+        return false;
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tempPath, m_path, ec);
+    if (ec) {
+        Logger::getInstance().error("Failed to replace wallet file: " + ec.message());
+        std::remove(tempPath.c_str());
+        return false;
+    }
+    syncDirectory(m_path);
+
+    return true;
+}
+
+} // namespace lumina
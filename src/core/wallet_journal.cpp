@@ -0,0 +1,376 @@
+/**
+ * LuminaChain Wallet - Wallet Journal Implementation
+ *
+ * This file implements the WalletJournal class which durably records wallet
+ * operations between full wallet saves.
+ *
+ * Copyright (c) 2023 LuminaChain Development Team
+ * Licensed under MIT License
+ */
+
+#include "core/wallet_journal.h"
+#include "utils/file_utils.h"
+#include "utils/logger.h"
+#include "crypto/hash.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+namespace lumina {
+
+/**
+ * Computes the checksum of a record over every field before the checksum
+ */
+static uint64_t computeChecksum(const JournalRecord& record) {
+    crypto::hash hash;
+    crypto::cn_fast_hash(&record, offsetof(JournalRecord, checksum), hash);
+
+    uint64_t checksum;
+    std::memcpy(&checksum, &hash, sizeof(checksum));
+    return checksum;
+}
+
+/**
+ * Reads the valid records at the start of a journal file
+ *
+ * Reading stops at the first record that is incomplete, fails its checksum
+ * or does not follow the previous one, which is where a crash interrupted a
+ * write. Sequence numbers dropped by a failed write leave gaps.
+ */
+static bool readRecords(const std::string& path, std::vector<JournalRecord>& records, uint64_t& fileSize) {
+    records.clear();
+    fileSize = 0;
+
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) {
+        // A missing journal is an empty journal
+        return !std::filesystem::exists(path);
+    }
+
+    fileSize = static_cast<uint64_t>(file.tellg());
+    file.seekg(0);
+
+    JournalRecord record;
+    while (file.read(reinterpret_cast<char*>(&record), sizeof(record))) {
+        if (record.checksum != computeChecksum(record)) {
+            break;
+        }
+        if (!records.empty() && record.sequence <= records.back().sequence) {
+            break;
+        }
+        records.push_back(record);
+    }
+
+    return true;
+}
+
+/**
+ * Constructor
+ */
+WalletJournal::WalletJournal()
+    : m_file(nullptr),
+      m_lastSequence(0),
+      m_committedSequence(0),
+      m_failed(false),
+      m_stopping(false) {
+}
+
+/**
+ * Destructor - flushes pending records and closes the journal
+ */
+WalletJournal::~WalletJournal() {
+    close();
+}
+
+/**
+ * Opens a journal file, creating it if needed
+ */
+bool WalletJournal::open(const std::string& path, uint64_t afterSequence, std::vector<JournalRecord>& replay) {
+    close();
+
+    std::vector<JournalRecord> records;
+    uint64_t fileSize = 0;
+    if (!readRecords(path, records, fileSize)) {
+        Logger::getInstance().error("Failed to read wallet journal: " + path);
+        return false;
+    }
+
+    uint64_t validSize = records.size() * sizeof(JournalRecord);
+    if (fileSize > validSize) {
+        Logger::getInstance().warning("Discarding " + std::to_string(fileSize - validSize) +
+                                      " bytes of incomplete records at the end of " + path);
+        std::error_code ec;
+        std::filesystem::resize_file(path, validSize, ec);
+        if (ec) {
+            Logger::getInstance().error("Failed to truncate wallet journal: " + ec.message());
+            return false;
+        }
+    }
+
+    replay.clear();
+    for (const auto& record : records) {
+        if (record.sequence > afterSequence) {
+            replay.push_back(record);
+        }
+    }
+
+    m_file = std::fopen(path.c_str(), "ab");
+    if (!m_file) {
+        Logger::getInstance().error("Failed to open wallet journal for writing: " + path);
+        return false;
+    }
+    syncDirectory(path);
+
+    m_path = path;
+    m_lastSequence = records.empty() ? afterSequence : std::max(afterSequence, records.back().sequence);
+    m_committedSequence = m_lastSequence;
+    m_discarded.clear();
+    m_failed = false;
+    m_stopping = false;
+    m_flusher = std::thread(&WalletJournal::flushLoop, this);
+
+    return true;
+}
+
+/**
+ * Flushes pending records and closes the journal
+ */
+void WalletJournal::close() {
+    stopFlusher();
+
+    if (m_file) {
+        std::fclose(m_file);
+        m_file = nullptr;
+    }
+}
+
+/**
+ * Queues a record for writing
+ */
+uint64_t WalletJournal::append(JournalRecord record) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    if (!recover(lock) || !m_file || m_failed || m_stopping) {
+        return 0;
+    }
+
+    record.sequence = ++m_lastSequence;
+    record.checksum = computeChecksum(record);
+    m_pending.push_back(record);
+    m_pendingAvailable.notify_one();
+
+    return record.sequence;
+}
+
+/**
+ * Queues records for writing, all or none of them
+ */
+uint64_t WalletJournal::appendBatch(std::vector<JournalRecord>& records) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    if (records.empty() || !recover(lock) || !m_file || m_failed || m_stopping) {
+        return 0;
+    }
+
+    // The records are queued together, so the flusher writes them in one batch
+    for (JournalRecord& record : records) {
+        record.sequence = ++m_lastSequence;
+        record.checksum = computeChecksum(record);
+    }
+    m_pending.insert(m_pending.end(), records.begin(), records.end());
+    m_pendingAvailable.notify_one();
+
+    return m_lastSequence;
+}
+
+/**
+ * Waits until a record is durably written
+ */
+bool WalletJournal::waitForCommit(uint64_t sequence) {
+    if (sequence == 0) {
+        return false;
+    }
+
+    auto discarded = [this, sequence] {
+        return std::any_of(m_discarded.begin(), m_discarded.end(), [sequence](const auto& range) {
+            return sequence >= range.first && sequence <= range.second;
+        });
+    };
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_committed.wait(lock, [&] { return m_committedSequence >= sequence || discarded(); });
+    return !discarded();
+}
+
+/**
+ * Drops the records up to a sequence number
+ */
+bool WalletJournal::truncateThrough(uint64_t sequence) {
+    // Keeps the flusher away from the file while it is replaced
+    std::lock_guard<std::mutex> fileLock(m_fileMutex);
+    return rewrite(sequence);
+}
+
+/**
+ * Rewrites the journal after a failed write, so appending can resume
+ *
+ * Called with m_mutex held through lock, which is released while the file is
+ * rewritten.
+ */
+bool WalletJournal::recover(std::unique_lock<std::mutex>& lock) {
+    if (!m_failed) {
+        return true;
+    }
+    lock.unlock();
+
+    bool failed;
+    bool recovered;
+    {
+        std::lock_guard<std::mutex> fileLock(m_fileMutex);
+        lock.lock();
+        failed = m_failed;
+        lock.unlock();
+
+        // Another thread may have recovered it meanwhile
+        recovered = !failed || rewrite(0);
+    }
+
+    if (failed && recovered) {
+        Logger::getInstance().info("Recovered wallet journal: " + m_path);
+    }
+    lock.lock();
+    return recovered;
+}
+
+/**
+ * Replaces the journal with its records after a sequence number, called with m_fileMutex held
+ */
+bool WalletJournal::rewrite(uint64_t sequence) {
+    if (!m_file) {
+        return false;
+    }
+
+    // After a failed write the file and its buffers may hold part of the dropped records
+    bool failed;
+    uint64_t committedSequence;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        failed = m_failed;
+        committedSequence = m_committedSequence;
+    }
+
+    std::vector<JournalRecord> records;
+    uint64_t fileSize = 0;
+    if ((!failed && !syncFile(m_file)) || !readRecords(m_path, records, fileSize)) {
+        Logger::getInstance().error("Failed to read wallet journal: " + m_path);
+        return false;
+    }
+
+    auto firstKept = std::find_if(records.begin(), records.end(),
+                                  [sequence](const JournalRecord& record) { return record.sequence > sequence; });
+    auto lastKept = records.end();
+    if (failed) {
+        lastKept = std::find_if(firstKept, records.end(), [committedSequence](const JournalRecord& record) {
+            return record.sequence > committedSequence;
+        });
+    }
+
+    std::string tempPath = m_path + ".tmp";
+    FILE* file = std::fopen(tempPath.c_str(), "wb");
+    if (!file) {
+        Logger::getInstance().error("Failed to open wallet journal for writing: " + tempPath);
+        return false;
+    }
+
+    // The new file stays open for appending, so no reopen can fail after the rename
+    bool written = writeAll(file, records.data() + (firstKept - records.begin()),
+                            (lastKept - firstKept) * sizeof(JournalRecord)) &&
+                   syncFile(file);
+
+    std::error_code ec;
+    if (written) {
+        std::filesystem::rename(tempPath, m_path, ec);
+    }
+    if (!written || ec) {
+        Logger::getInstance().error("Failed to rewrite wallet journal: " + m_path);
+        std::fclose(file);
+        std::remove(tempPath.c_str());
+        return false;
+    }
+    syncDirectory(m_path);
+
+    // Anything still buffered for the old file belonged to the dropped records
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::fclose(m_file);
+    m_file = file;
+    m_failed = false;
+
+    return true;
+}
+
+/**
+ * Gets the sequence number of the last appended record
+ */
+uint64_t WalletJournal::getLastSequence() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_lastSequence;
+}
+
+/**
+ * Main loop of the flusher thread
+ */
+void WalletJournal::flushLoop() {
+    std::vector<JournalRecord> batch;
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    while (true) {
+        m_pendingAvailable.wait(lock, [this] { return m_stopping || !m_pending.empty(); });
+        if (m_pending.empty()) {
+            return;
+        }
+
+        // Everything queued during the previous flush goes out in one write and one sync
+        batch.swap(m_pending);
+        lock.unlock();
+
+        bool written;
+        {
+            std::lock_guard<std::mutex> fileLock(m_fileMutex);
+            written = m_file && writeAll(m_file, batch.data(), batch.size() * sizeof(JournalRecord)) &&
+                      syncFile(m_file);
+        }
+
+        lock.lock();
+        if (written) {
+            m_committedSequence = batch.back().sequence;
+        } else {
+            // The batch and the records queued behind it are dropped until the journal is recovered
+            Logger::getInstance().error("Failed to write wallet journal: " + m_path);
+            m_discarded.emplace_back(batch.front().sequence, m_lastSequence);
+            m_pending.clear();
+            m_failed = true;
+        }
+        batch.clear();
+        m_committed.notify_all();
+    }
+}
+
+/**
+ * Stops the flusher thread after it has written all pending records
+ */
+void WalletJournal::stopFlusher() {
+    if (!m_flusher.joinable()) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_pendingAvailable.notify_one();
+    m_flusher.join();
+}
+
+} // namespace lumina
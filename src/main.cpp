@@ -55,6 +55,8 @@ int main(int argc, char* argv[]) {
     
     lumina::Config::getInstance().loadFromFile(configPath);
     lumina::Logger::getInstance().info("Configuration loaded from " + configPath);
+    lumina::Logger::getInstance().setMonotonicTimestamps(
+        lumina::Config::getInstance().getBool("log_monotonic_timestamps"));
     
     // Initialize wallet components
     auto wallet = std::make_shared<lumina::Wallet>();
@@ -66,6 +68,7 @@ int main(int argc, char* argv[]) {
     
     // Display welcome message on startup
     lumina::CommandResult welcomeResult = commandHandler.executeCommand("welcome", {});
+    lumina::Logger::getInstance().flush();
     std::cout << welcomeResult.message << std::endl;
     
     // Main command processing loop
@@ -75,6 +78,8 @@ int main(int argc, char* argv[]) {
     bool running = true;
     
     while (running) {
+        // Log lines are written asynchronously; let them all out before the prompt
+        lumina::Logger::getInstance().flush();
         std::cout << "lumina> ";
         std::getline(std::cin, input);
         
@@ -85,6 +90,7 @@ int main(int argc, char* argv[]) {
                 lumina::Logger::getInstance().info("Application exit requested by user");
             } else {
                 lumina::CommandResult result = commandHandler.executeCommand(command, args);
+                lumina::Logger::getInstance().flush();
                 std::cout << result.message << std::endl;
                 
                 if (!result.success) {
@@ -9,13 +9,30 @@
  */
 
 #include "network/sync.h"
+#include "network/scanner.h"
 #include "utils/logger.h"
 #include "utils/config.h"
+#include "blocks/checkpoint_index.h"
+#include "crypto/hash.h"
+#include "string_tools.h"
 #include <thread>
 #include <chrono>
+#include <algorithm>
 
 namespace lumina {
 
+// Number of recent block hashes kept for reorg detection
+const size_t SYNC_CHECKPOINT_DEPTH = 10;
+
+// Number of blocks processed per batch above the trusted checkpoint height
+const uint64_t SYNC_BATCH_SIZE = 100;
+
+// Whether block data comes from the simulated chain rather than the network
+const bool SYNC_SIMULATED_BLOCKS = true;
+
+// Checkpoint index without checkpoints, used when none apply
+static const blocks::CheckpointIndex NO_CHECKPOINTS;
+
 /**
  * Constructor
  */
@@ -27,7 +44,9 @@ NetworkSync::NetworkSync(const std::string& walletAddress)
       m_latestBlockHeight(0),
       m_currentBlockHeight(0),
       m_isSyncing(false),
-      m_callback(nullptr) {
+      m_callback(nullptr),
+      m_reorgCallback(nullptr),
+      m_checkpoints(nullptr) {
     
     Logger::getInstance().info("Network synchronizer initialized for wallet: " + walletAddress);
     
@@ -37,6 +56,9 @@ NetworkSync::NetworkSync(const std::string& walletAddress)
         m_networkEndpoint = configEndpoint;
         Logger::getInstance().info("Using network endpoint from config: " + m_networkEndpoint);
     }
+    
+    // Index the embedded checkpoints so the initial sync can skip full validation
+    loadCheckpoints();
 }
 
 /**
@@ -82,9 +104,7 @@ bool NetworkSync::startSync(SyncProgressCallback callback) {
     // TODO: Start a separate thread for synchronization
     
     // For now, just simulate synchronization
-    simulateSync();
-    
-    return true;
+    return simulateSync();
 }
 
 /**
@@ -158,6 +178,47 @@ std::string NetworkSync::getNetworkEndpoint() const {
     return m_networkEndpoint;
 }
 
+/**
+ * Sets the checkpoint to resume synchronization from
+ */
+void NetworkSync::setSyncCheckpoint(const SyncCheckpoint& checkpoint) {
+    m_currentBlockHeight = checkpoint.height;
+    m_recentBlocks.assign(checkpoint.recentBlocks.begin(), checkpoint.recentBlocks.end());
+    
+    Logger::getInstance().info("Resuming synchronization from height " + std::to_string(m_currentBlockHeight));
+}
+
+/**
+ * Gets the current synchronization checkpoint
+ */
+SyncCheckpoint NetworkSync::getSyncCheckpoint() const {
+    SyncCheckpoint checkpoint;
+    checkpoint.height = m_currentBlockHeight;
+    checkpoint.recentBlocks.assign(m_recentBlocks.begin(), m_recentBlocks.end());
+    return checkpoint;
+}
+
+/**
+ * Sets the callback invoked when a chain reorganization is detected
+ */
+void NetworkSync::setReorgCallback(SyncReorgCallback callback) {
+    m_reorgCallback = callback;
+}
+
+/**
+ * Sets the scanner used to find the wallet's outputs in processed blocks
+ */
+void NetworkSync::setOutputScanner(std::shared_ptr<OutputScanner> scanner) {
+    m_scanner = scanner;
+}
+
+/**
+ * Sets the checkpoints that blocks below their trusted height are checked against
+ */
+void NetworkSync::setCheckpoints(const blocks::CheckpointIndex* checkpoints) {
+    m_checkpoints = checkpoints ? checkpoints : &NO_CHECKPOINTS;
+}
+
 /**
  * Connects to the network
  */
@@ -170,6 +231,39 @@ bool NetworkSync::connectToNetwork() {
     return true;
 }
 
+/**
+ * Loads the embedded checkpoint index for the configured network
+ */
+bool NetworkSync::loadCheckpoints() {
+    // The simulated chain's hashes can never match the real checkpoints
+    if (SYNC_SIMULATED_BLOCKS) {
+        m_checkpoints = &NO_CHECKPOINTS;
+        Logger::getInstance().info("Block data is simulated, checkpoint verification disabled");
+        return true;
+    }
+    
+    std::string network = Config::getInstance().getString("network", "mainnet");
+    cryptonote::network_type networkType = cryptonote::MAINNET;
+    if (network == "testnet") {
+        networkType = cryptonote::TESTNET;
+    } else if (network == "stagenet") {
+        networkType = cryptonote::STAGENET;
+    }
+    
+    blocks::CheckpointLoadStatus status;
+    m_checkpoints = &blocks::GetCheckpointIndex(networkType, &status);
+    
+    if (status != blocks::CheckpointLoadStatus::Ok) {
+        Logger::getInstance().error("Embedded checkpoint data for " + network + " failed to load, fast sync disabled");
+        return false;
+    }
+    
+    Logger::getInstance().info("Loaded " + std::to_string(m_checkpoints->Size()) + " checkpoints, trusted up to height " +
+                               std::to_string(m_checkpoints->TrustedHeight()));
+    
+    return true;
+}
+
 /**
  * Fetches the latest block height from the network
  */
@@ -184,12 +278,152 @@ bool NetworkSync::fetchLatestBlockHeight() {
     return true;
 }
 
+/**
+ * Fetches the hash of the block at the given height from the network
+ */
+bool NetworkSync::fetchBlockHash(uint64_t height, std::string& hash) {
+    // TODO: Implement proper fetching of block hashes
+    
+    if (height >= m_latestBlockHeight) {
+        return false;
+    }
+    
+    // For now, just simulate a deterministic hash per endpoint and height
+    std::string seed = m_networkEndpoint + ":" + std::to_string(height);
+    hash = epee::string_tools::pod_to_hex(crypto::cn_fast_hash(seed.data(), seed.size()));
+    
+    return true;
+}
+
+/**
+ * Fetches the decoded blocks in [fromHeight, toHeight) from the network
+ */
+bool NetworkSync::fetchBlocks(uint64_t fromHeight, uint64_t toHeight, std::vector<ScanBlock>& blocks) {
+    // TODO: Implement fetching through getblocks.bin with output indices
+    
+    // For now, just simulate empty blocks
+    blocks.clear();
+    blocks.reserve(toHeight - fromHeight);
+    for (uint64_t height = fromHeight; height < toHeight; ++height) {
+        blocks.push_back({height, {}});
+    }
+    
+    return true;
+}
+
+/**
+ * Checks a whole checkpoint group of block hashes against the embedded checkpoints
+ */
+bool NetworkSync::verifyCheckpoint(uint64_t fromHeight, const std::vector<std::string>& hashes) const {
+    auto checkpoint = m_checkpoints->Find(fromHeight);
+    if (checkpoint == m_checkpoints->end() || (*checkpoint).height != fromHeight ||
+        hashes.size() != m_checkpoints->GroupSize()) {
+        return false;
+    }
+    
+    std::vector<crypto::hash> blockHashes(hashes.size());
+    for (size_t i = 0; i < hashes.size(); ++i) {
+        if (!epee::string_tools::hex_to_pod(hashes[i], blockHashes[i])) {
+            return false;
+        }
+    }
+    
+    crypto::hash groupHash;
+    crypto::cn_fast_hash(blockHashes.data(), blockHashes.size() * sizeof(crypto::hash), groupHash);
+    
+    return groupHash == (*checkpoint).hash;
+}
+
+/**
+ * Performs full validation of a single block
+ */
+bool NetworkSync::validateBlock(uint64_t height, const std::string& hash) {
+    // TODO: Implement proper block validation (PoW, header and transaction checks)
+    
+    // For now, only check that the block exists and its hash is well-formed
+    crypto::hash blockHash;
+    return height < m_latestBlockHeight && epee::string_tools::hex_to_pod(hash, blockHash);
+}
+
+/**
+ * Fetches the hashes of the blocks in [fromHeight, toHeight) from the network
+ */
+bool NetworkSync::fetchBlockHashes(uint64_t fromHeight, uint64_t toHeight, std::vector<std::string>& hashes) {
+    hashes.clear();
+    hashes.reserve(toHeight - fromHeight);
+    for (uint64_t height = fromHeight; height < toHeight; ++height) {
+        std::string hash;
+        if (!fetchBlockHash(height, hash)) {
+            Logger::getInstance().error("Failed to fetch hash of block " + std::to_string(height));
+            return false;
+        }
+        hashes.push_back(hash);
+    }
+    
+    return true;
+}
+
 /**
  * Processes blocks from the network
  */
 bool NetworkSync::processBlocks(uint64_t fromHeight, uint64_t toHeight) {
     // TODO: Implement proper block processing
     
+    std::vector<std::string> hashes;
+    auto checkpoint = m_checkpoints->Find(fromHeight);
+    if (checkpoint != m_checkpoints->end()) {
+        // Blocks covered by a trusted checkpoint only need their hashes checked,
+        // but always against the whole group, so a sync resumed mid-group fetches its start
+        uint64_t groupStart = (*checkpoint).height;
+        uint64_t groupEnd = groupStart + m_checkpoints->GroupSize();
+        if (toHeight > groupEnd) {
+            Logger::getInstance().error("Blocks " + std::to_string(fromHeight) + " to " + std::to_string(toHeight) +
+                                        " cross a checkpoint group boundary");
+            return false;
+        }
+        
+        std::vector<std::string> groupHashes;
+        if (!fetchBlockHashes(groupStart, groupEnd, groupHashes)) {
+            return false;
+        }
+        if (!verifyCheckpoint(groupStart, groupHashes)) {
+            Logger::getInstance().error("Blocks " + std::to_string(groupStart) + " to " + std::to_string(groupEnd) +
+                                        " do not match the embedded checkpoint");
+            return false;
+        }
+        hashes.assign(groupHashes.begin() + (fromHeight - groupStart), groupHashes.begin() + (toHeight - groupStart));
+    } else {
+        // Anything above the trusted height goes through full per-block validation
+        if (!fetchBlockHashes(fromHeight, toHeight, hashes)) {
+            return false;
+        }
+        for (uint64_t height = fromHeight; height < toHeight; ++height) {
+            if (!validateBlock(height, hashes[height - fromHeight])) {
+                Logger::getInstance().error("Block " + std::to_string(height) + " failed validation");
+                return false;
+            }
+        }
+    }
+    
+    // Look for the wallet's outputs in the batch
+    if (m_scanner) {
+        std::vector<ScanBlock> blocks;
+        if (!fetchBlocks(fromHeight, toHeight, blocks)) {
+            Logger::getInstance().error("Failed to fetch blocks " + std::to_string(fromHeight) + " to " + std::to_string(toHeight));
+            return false;
+        }
+        m_scanner->scanBlocks(blocks);
+    }
+    
+    // Remember the hashes of the newest blocks so the next refresh can detect reorgs
+    uint64_t firstRecorded = std::max(fromHeight, toHeight > SYNC_CHECKPOINT_DEPTH ? toHeight - SYNC_CHECKPOINT_DEPTH : 0);
+    for (uint64_t height = firstRecorded; height < toHeight; ++height) {
+        m_recentBlocks.push_back({height, hashes[height - fromHeight]});
+    }
+    while (m_recentBlocks.size() > SYNC_CHECKPOINT_DEPTH) {
+        m_recentBlocks.pop_front();
+    }
+    
     // For now, just update the current block height
     m_currentBlockHeight = toHeight;
     
@@ -207,6 +441,46 @@ bool NetworkSync::processBlocks(uint64_t fromHeight, uint64_t toHeight) {
     return true;
 }
 
+/**
+ * Checks the saved block hashes against the network and rolls back past any reorg
+ * 
+ * @return The height to resume scanning from
+ */
+uint64_t NetworkSync::detectReorg() {
+    if (m_recentBlocks.empty()) {
+        return m_currentBlockHeight;
+    }
+    
+    // Walk back from the newest saved block until one still matches the chain
+    while (!m_recentBlocks.empty()) {
+        const BlockId& block = m_recentBlocks.back();
+        std::string hash;
+        if (fetchBlockHash(block.height, hash) && hash == block.hash) {
+            break;
+        }
+        m_recentBlocks.pop_back();
+    }
+    
+    uint64_t forkHeight;
+    if (!m_recentBlocks.empty()) {
+        forkHeight = m_recentBlocks.back().height + 1;
+    } else {
+        // The reorg is deeper than the saved window, rescan from scratch
+        Logger::getInstance().warning("Chain reorganization deeper than the saved checkpoint, rescanning from genesis");
+        forkHeight = 0;
+    }
+    
+    if (forkHeight < m_currentBlockHeight) {
+        Logger::getInstance().warning("Chain reorganization detected, rolling back to height " + std::to_string(forkHeight));
+        
+        if (m_reorgCallback) {
+            m_reorgCallback(forkHeight);
+        }
+    }
+    
+    return std::min(forkHeight, m_currentBlockHeight);
+}
+
 /**
  * Updates the synchronization progress
  */
@@ -229,22 +503,41 @@ void NetworkSync::updateProgress(float progress, const std::string& message) {
 
 /**
  * Simulates the synchronization process
+ * 
+ * @return false if a batch of blocks failed verification
  */
-void NetworkSync::simulateSync() {
+bool NetworkSync::simulateSync() {
     // This is a placeholder for the actual synchronization process
     // In a real implementation, this would be done in a separate thread
     
     Logger::getInstance().info("Starting synchronization simulation");
     
-    // Simulate processing blocks in batches
-    uint64_t batchSize = 100;
-    m_currentBlockHeight = 0;
+    // Resume from the saved checkpoint, rolling back any reorganized blocks
+    m_currentBlockHeight = detectReorg();
     
-    for (uint64_t height = 0; height < m_latestBlockHeight; height += batchSize) {
+    // Simulate processing blocks in batches, aligned to checkpoint groups below the trusted height
+    uint64_t height = m_currentBlockHeight;
+    
+    while (height < m_latestBlockHeight) {
+        uint64_t batchSize = SYNC_BATCH_SIZE;
+        auto checkpoint = m_checkpoints->Find(height);
+        if (checkpoint != m_checkpoints->end()) {
+            batchSize = (*checkpoint).height + m_checkpoints->GroupSize() - height;
+        } else {
+            // Stop short of the next group, so it is verified as a whole
+            auto next = m_checkpoints->Between(height + 1, height + batchSize);
+            if (next.begin() != next.end()) {
+                batchSize = (*next.begin()).height - height;
+            }
+        }
         uint64_t toHeight = std::min(height + batchSize, m_latestBlockHeight);
         
         // Process this batch of blocks
-        processBlocks(height, toHeight);
+        if (!processBlocks(height, toHeight)) {
+            stopSync();
+            return false;
+        }
+        height = toHeight;
         
         // Simulate some delay
         std::this_thread::sleep_for(std::chrono::milliseconds(100));
@@ -259,6 +552,8 @@ void NetworkSync::simulateSync() {
     if (m_isSyncing && m_currentBlockHeight >= m_latestBlockHeight) {
         updateProgress(1.0f, "Synchronization completed");
     }
+    
+    return true;
 }
 
 } // namespace lumina
\ No newline at end of file
@@ -0,0 +1,59 @@
+/**
+ * LuminaChain Wallet - File Utilities Implementation
+ *
+ * This file implements helpers for writing files durably.
+ *
+ * Copyright (c) 2023 LuminaChain Development Team
+ * Licensed under MIT License
+ */
+
+#include "utils/file_utils.h"
+#include <filesystem>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace lumina {
+
+/**
+ * Writes a whole buffer to a file
+ */
+bool writeAll(FILE* file, const void* data, size_t size) {
+    return size == 0 || std::fwrite(data, 1, size, file) == size;
+}
+
+/**
+ * Flushes a file's buffers and contents to disk
+ */
+bool syncFile(FILE* file) {
+    if (std::fflush(file) != 0) {
+        return false;
+    }
+#ifndef _WIN32
+    return fsync(fileno(file)) == 0;
+#else
+    return true;
+#endif
+}
+
+/**
+ * Flushes the directory containing a file so a create or rename survives a crash
+ */
+void syncDirectory(const std::string& path) {
+#ifndef _WIN32
+    std::string directory = std::filesystem::path(path).parent_path().string();
+    if (directory.empty()) {
+        directory = ".";
+    }
+
+    int fd = ::open(directory.c_str(), O_RDONLY);
+    if (fd >= 0) {
+        fsync(fd);
+        ::close(fd);
+    }
+#endif
+}
+
+} // namespace lumina
@@ -9,9 +9,10 @@
  */
 
 #include "utils/logger.h"
+#include <algorithm>
+#include <cstdio>
 #include <ctime>
-#include <iomanip>
-#include <sstream>
+#include <limits>
 
 namespace lumina {
 
@@ -21,7 +22,35 @@ namespace lumina {
 Logger::Logger()
     : m_logFilePath(""),
       m_consoleOutput(true),
-      m_logLevel(LogLevel::INFO) {
+      m_logLevel(LogLevel::INFO),
+      m_queue(LOG_QUEUE_CAPACITY),
+      m_writtenCount(0),
+      m_stopping(false),
+      m_writerRunning(true),
+      m_monotonicTimestamps(false),
+      m_startTime(std::chrono::steady_clock::now()) {
+    m_writer = std::thread(&Logger::writerLoop, this);
+}
+
+/**
+ * Destructor - writes the queued messages and stops the writer thread
+ */
+Logger::~Logger() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_writeRequested.notify_one();
+    m_writer.join();
+    
+    // Write anything queued by threads that raced with the shutdown
+    std::lock_guard<std::mutex> lock(m_mutex);
+    LogRecord record;
+    while (m_queue.tryPop(record)) {
+        std::string text;
+        formatRecord(record, text);
+        writeText(text);
+    }
 }
 
 /**
@@ -36,18 +65,23 @@ Logger& Logger::getInstance() {
  * Initializes the logger
  */
 bool Logger::initialize(const std::string& logFilePath, bool consoleOutput) {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    
-    m_logFilePath = logFilePath;
-    m_consoleOutput = consoleOutput;
+    // Messages logged before go to the previous outputs
+    flush();
     
-    // Open the log file
-    if (!m_logFilePath.empty()) {
-        m_logFile.open(m_logFilePath, std::ios::app);
-        if (!m_logFile) {
-            // If we can't open the log file, fall back to console output
-            m_consoleOutput = true;
-            return false;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        
+        m_logFilePath = logFilePath;
+        m_consoleOutput = consoleOutput;
+        
+        // Open the log file
+        if (!m_logFilePath.empty()) {
+            m_logFile.open(m_logFilePath, std::ios::app);
+            if (!m_logFile) {
+                // If we can't open the log file, fall back to console output
+                m_consoleOutput = true;
+                return false;
+            }
         }
     }
     
@@ -62,27 +96,15 @@ bool Logger::initialize(const std::string& logFilePath, bool consoleOutput) {
  */
 void Logger::log(LogLevel level, const std::string& message) {
     // Skip if the message level is below the current log level
-    if (level < m_logLevel) {
+    if (!isEnabled(level)) {
         return;
     }
     
-    std::lock_guard<std::mutex> lock(m_mutex);
-    
-    // Format the log message
-    std::string timestamp = getTimestamp();
-    std::string levelStr = logLevelToString(level);
-    std::string formattedMessage = timestamp + " [" + levelStr + "] " + message;
-    
-    // Write to console if enabled
-    if (m_consoleOutput) {
-        std::cout << formattedMessage << std::endl;
-    }
-    
-    // Write to log file if open
-    if (m_logFile.is_open()) {
-        m_logFile << formattedMessage << std::endl;
-        m_logFile.flush();
-    }
+    LogRecord record;
+    record.level = level;
+    stampRecord(record);
+    record.payload = message;
+    enqueue(std::move(record));
 }
 
 /**
@@ -120,40 +142,302 @@ void Logger::critical(const std::string& message) {
     log(LogLevel::CRITICAL, message);
 }
 
+/**
+ * Waits until every message logged so far has been written and flushed
+ */
+void Logger::flush() {
+    size_t target = m_queue.getPushCount();
+    
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_writeRequested.notify_one();
+    m_written.wait(lock, [this, target] {
+        return m_writtenCount >= target || !m_writerRunning.load(std::memory_order_acquire);
+    });
+}
+
 /**
  * Sets the minimum log level to output
  */
 void Logger::setLogLevel(LogLevel level) {
-    m_logLevel = level;
+    m_logLevel.store(level, std::memory_order_relaxed);
 }
 
 /**
  * Gets the current minimum log level
  */
 LogLevel Logger::getLogLevel() const {
-    return m_logLevel;
+    return m_logLevel.load(std::memory_order_relaxed);
 }
 
 /**
  * Enables or disables console output
  */
 void Logger::setConsoleOutput(bool enabled) {
+    std::lock_guard<std::mutex> lock(m_mutex);
     m_consoleOutput = enabled;
 }
 
 /**
- * Gets a timestamp string for the current time
+ * Enables or disables monotonic timestamps
+ */
+void Logger::setMonotonicTimestamps(bool enabled) {
+    m_monotonicTimestamps.store(enabled, std::memory_order_relaxed);
+}
+
+/**
+ * Gets a timestamp string for the current local time
  */
 std::string Logger::getTimestamp() const {
-    auto now = std::chrono::system_clock::now();
-    auto time = std::chrono::system_clock::to_time_t(now);
-    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()) % 1000;
+    std::string text;
+    appendLocalTime(std::chrono::system_clock::now(), text);
+    return text;
+}
+
+/**
+ * Writes a number as fixed-width decimal digits
+ */
+static void writeDigits(char* out, unsigned value, int width) {
+    for (int i = width - 1; i >= 0; --i) {
+        out[i] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    }
+}
+
+/**
+ * Divides, rounding towards negative infinity
+ */
+static int64_t floorDivide(int64_t value, int64_t divisor) {
+    int64_t quotient = value / divisor;
+    return quotient * divisor > value ? quotient - 1 : quotient;
+}
+
+/**
+ * Records the times of a message
+ */
+void Logger::stampRecord(LogRecord& record) const {
+    record.time = std::chrono::system_clock::now();
+    if (m_monotonicTimestamps.load(std::memory_order_relaxed)) {
+        record.monotonicTime = std::chrono::steady_clock::now();
+    }
+}
+
+/**
+ * Appends the timestamps of a record
+ */
+void Logger::appendTimestamp(const LogRecord& record, std::string& text) const {
+    appendLocalTime(record.time, text);
+    if (record.monotonicTime == std::chrono::steady_clock::time_point()) {
+        return;
+    }
+    
+    // " +seconds.microseconds" since the logger started
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(record.monotonicTime - m_startTime);
+    uint64_t micros = static_cast<uint64_t>(std::max<int64_t>(elapsed.count(), 0));
+    char buffer[32];
+    int length = std::snprintf(buffer, sizeof(buffer), " +%llu.%06u",
+                               static_cast<unsigned long long>(micros / 1000000),
+                               static_cast<unsigned>(micros % 1000000));
+    text.append(buffer, static_cast<size_t>(length));
+}
+
+/**
+ * Appends a time as "YYYY-MM-DD HH:MM:SS.mmm" in local time
+ *
+ * Time zone offsets are whole minutes, so the date, hour and minute only
+ * change when the minute does. Each thread keeps the text of the last
+ * minute it converted and, within that minute, writes just the seconds
+ * and milliseconds.
+ */
+void Logger::appendLocalTime(std::chrono::system_clock::time_point time, std::string& text) {
+    const size_t TIMESTAMP_LENGTH = 23;
+    struct MinuteCache {
+        int64_t minute = std::numeric_limits<int64_t>::min();
+        char text[TIMESTAMP_LENGTH];
+    };
+    thread_local MinuteCache cache;
+    
+    int64_t ms = std::chrono::duration_cast<std::chrono::milliseconds>(time.time_since_epoch()).count();
+    int64_t second = floorDivide(ms, 1000);
+    int64_t minute = floorDivide(second, 60);
+    
+    if (minute != cache.minute) {
+        std::time_t minuteStart = static_cast<std::time_t>(minute * 60);
+        std::tm localTime;
+#ifndef _WIN32
+        localtime_r(&minuteStart, &localTime);
+#else
+        localtime_s(&localTime, &minuteStart);
+#endif
+        
+        char* out = cache.text;
+        writeDigits(out, static_cast<unsigned>(localTime.tm_year + 1900), 4);
+        out[4] = '-';
+        writeDigits(out + 5, static_cast<unsigned>(localTime.tm_mon + 1), 2);
+        out[7] = '-';
+        writeDigits(out + 8, static_cast<unsigned>(localTime.tm_mday), 2);
+        out[10] = ' ';
+        writeDigits(out + 11, static_cast<unsigned>(localTime.tm_hour), 2);
+        out[13] = ':';
+        writeDigits(out + 14, static_cast<unsigned>(localTime.tm_min), 2);
+        out[16] = ':';
+        out[19] = '.';
+        cache.minute = minute;
+    }
+    
+    writeDigits(cache.text + 17, static_cast<unsigned>(second - minute * 60), 2);
+    writeDigits(cache.text + 20, static_cast<unsigned>(ms - second * 1000), 3);
+    text.append(cache.text, TIMESTAMP_LENGTH);
+}
+
+/**
+ * Queues a record for the writer thread
+ */
+void Logger::enqueue(LogRecord&& record) {
+    LogLevel level = record.level;
+    
+    // Without a writer thread, during shutdown, write directly
+    if (!m_writerRunning.load(std::memory_order_acquire)) {
+        std::string text;
+        formatRecord(record, text);
+        std::lock_guard<std::mutex> lock(m_mutex);
+        writeText(text);
+        return;
+    }
+    
+    // Queue the record, waking the writer if the queue is filling up
+    while (!m_queue.tryPush(std::move(record))) {
+        m_writeRequested.notify_one();
+        std::this_thread::yield();
+    }
+    if (m_queue.sizeApprox() >= LOG_BATCH_SIZE) {
+        m_writeRequested.notify_one();
+    }
+    
+    // Critical messages must not be lost if the process dies next
+    if (level == LogLevel::CRITICAL) {
+        flush();
+    }
+}
+
+/**
+ * Appends the line of a record to a text
+ */
+void Logger::formatRecord(const LogRecord& record, std::string& text) const {
+    appendTimestamp(record, text);
+    text += " [";
+    text += logLevelToString(record.level);
+    text += "] ";
+    if (record.encoded) {
+        decodeArguments(record.payload, text);
+    } else {
+        text += record.payload;
+    }
+    text += '\n';
+}
+
+/**
+ * Writes queued records until the logger is destroyed
+ */
+void Logger::writerLoop() {
+    std::string text;
+    LogRecord record;
+    
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        // Format a batch without holding the lock
+        lock.unlock();
+        size_t count = 0;
+        text.clear();
+        while (count < LOG_BATCH_SIZE && m_queue.tryPop(record)) {
+            formatRecord(record, text);
+            ++count;
+        }
+        lock.lock();
+        
+        if (count > 0) {
+            writeText(text);
+            m_writtenCount += count;
+            m_written.notify_all();
+            continue;
+        }
+        
+        // Stop once every claimed slot has been published and written
+        if (m_stopping && m_writtenCount == m_queue.getPushCount()) {
+            break;
+        }
+        m_writeRequested.wait_for(lock, LOG_FLUSH_INTERVAL);
+    }
+    
+    m_writerRunning.store(false, std::memory_order_release);
+    m_written.notify_all();
+}
+
+/**
+ * Writes and flushes formatted lines, with m_mutex held
+ */
+void Logger::writeText(const std::string& text) {
+    // Write to console if enabled
+    if (m_consoleOutput) {
+        std::cout << text;
+        std::cout.flush();
+    }
     
-    std::stringstream ss;
-    ss << std::put_time(std::localtime(&time), "%Y-%m-%d %H:%M:%S");
-    ss << '.' << std::setfill('0') << std::setw(3) << ms.count();
+    // Write to log file if open
+    if (m_logFile.is_open()) {
+        m_logFile << text;
+        m_logFile.flush();
+    }
+}
+
+/**
+ * Appends the text of encoded arguments
+ */
+void Logger::decodeArguments(const std::string& payload, std::string& text) {
+    const char* data = payload.data();
+    const char* end = data + payload.size();
     
-    return ss.str();
+    while (data < end) {
+        ArgumentType type = static_cast<ArgumentType>(*data++);
+        switch (type) {
+            case ArgumentType::STRING: {
+                uint32_t length;
+                std::memcpy(&length, data, sizeof(length));
+                data += sizeof(length);
+                text.append(data, length);
+                data += length;
+                break;
+            }
+            case ArgumentType::INT: {
+                int64_t value;
+                std::memcpy(&value, data, sizeof(value));
+                data += sizeof(value);
+                text += std::to_string(value);
+                break;
+            }
+            case ArgumentType::UINT: {
+                uint64_t value;
+                std::memcpy(&value, data, sizeof(value));
+                data += sizeof(value);
+                text += std::to_string(value);
+                break;
+            }
+            case ArgumentType::DOUBLE: {
+                double value;
+                std::memcpy(&value, data, sizeof(value));
+                data += sizeof(value);
+                char buffer[32];
+                int length = std::snprintf(buffer, sizeof(buffer), "%g", value);
+                text.append(buffer, static_cast<size_t>(length));
+                break;
+            }
+            case ArgumentType::CHAR:
+                text += *data++;
+                break;
+            case ArgumentType::BOOL:
+                text += *data++ ? "true" : "false";
+                break;
+        }
+    }
 }
 
 /**
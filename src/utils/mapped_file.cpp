@@ -0,0 +1,136 @@
+/**
+ * LuminaChain Wallet - Mapped File Utility Implementation
+ *
+ * This file implements the MappedFile class which maps a file read-only
+ * into memory.
+ *
+ * Copyright (c) 2023 LuminaChain Development Team
+ * Licensed under MIT License
+ */
+
+#include "utils/mapped_file.h"
+#include "utils/logger.h"
+#include <fstream>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace lumina {
+
+/**
+ * Constructor
+ */
+MappedFile::MappedFile()
+    : m_data(nullptr),
+      m_size(0),
+      m_isOpen(false) {
+}
+
+/**
+ * Destructor - unmaps the file
+ */
+MappedFile::~MappedFile() {
+    close();
+}
+
+/**
+ * Maps a file, closing any previously mapped file
+ */
+bool MappedFile::open(const std::string& path) {
+    close();
+
+#ifndef _WIN32
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        Logger::getInstance().error("Failed to open file for mapping: " + path);
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        ::close(fd);
+        Logger::getInstance().error("Failed to read file size: " + path);
+        return false;
+    }
+
+    m_size = static_cast<size_t>(st.st_size);
+    if (m_size > 0) {
+        void* mapping = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping == MAP_FAILED) {
+            ::close(fd);
+            m_size = 0;
+            Logger::getInstance().error("Failed to map file: " + path);
+            return false;
+        }
+        m_data = static_cast<const uint8_t*>(mapping);
+    }
+
+    // The mapping keeps its own reference to the file
+    ::close(fd);
+#else
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) {
+        Logger::getInstance().error("Failed to open file for mapping: " + path);
+        return false;
+    }
+
+    m_buffer.resize(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    if (!file.read(reinterpret_cast<char*>(m_buffer.data()), m_buffer.size())) {
+        m_buffer.clear();
+        Logger::getInstance().error("Failed to read file: " + path);
+        return false;
+    }
+
+    m_data = m_buffer.data();
+    m_size = m_buffer.size();
+#endif
+
+    m_isOpen = true;
+    return true;
+}
+
+/**
+ * Unmaps the file
+ */
+void MappedFile::close() {
+#ifndef _WIN32
+    if (m_data != nullptr) {
+        munmap(const_cast<uint8_t*>(m_data), m_size);
+    }
+#else
+    m_buffer.clear();
+    m_buffer.shrink_to_fit();
+#endif
+
+    m_data = nullptr;
+    m_size = 0;
+    m_isOpen = false;
+}
+
+/**
+ * Checks whether a file is mapped
+ */
+bool MappedFile::isOpen() const {
+    return m_isOpen;
+}
+
+/**
+ * Gets the mapped file contents
+ */
+const uint8_t* MappedFile::data() const {
+    return m_data;
+}
+
+/**
+ * Gets the size of the mapped file
+ */
+size_t MappedFile::size() const {
+    return m_size;
+}
+
+} // namespace lumina
@@ -0,0 +1,150 @@
+/**
+ * LuminaChain Wallet - Thread Pool Utility Implementation
+ *
+ * This file implements the ThreadPool class which runs data-parallel work
+ * on a fixed set of worker threads.
+ *
+ * Copyright (c) 2023 LuminaChain Development Team
+ * Licensed under MIT License
+ */
+
+#include "utils/thread_pool.h"
+#include <algorithm>
+
+namespace lumina {
+
+// Set while a thread runs chunks of a loop so nested loops run inline
+static thread_local bool t_inParallelLoop = false;
+
+/**
+ * Gets the shared thread pool sized to the hardware concurrency
+ */
+ThreadPool& ThreadPool::getInstance() {
+    static ThreadPool instance;
+    return instance;
+}
+
+/**
+ * Constructor
+ */
+ThreadPool::ThreadPool(size_t threadCount)
+    : m_task(nullptr),
+      m_count(0),
+      m_chunk(1),
+      m_nextIndex(0),
+      m_activeWorkers(0),
+      m_generation(0),
+      m_stopping(false) {
+
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    // The calling thread also works, so one fewer worker is needed
+    for (size_t i = 1; i < threadCount; ++i) {
+        m_workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+/**
+ * Destructor - stops and joins all worker threads
+ */
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_workAvailable.notify_all();
+
+    for (auto& worker : m_workers) {
+        worker.join();
+    }
+}
+
+/**
+ * Runs a task over [0, count) split into chunks and waits for completion
+ */
+void ThreadPool::parallelFor(size_t count, const ParallelTask& task, size_t minChunk) {
+    if (count == 0) {
+        return;
+    }
+
+    size_t concurrency = getConcurrency();
+    if (t_inParallelLoop || concurrency == 1 || count <= minChunk) {
+        task(0, count);
+        return;
+    }
+
+    // Only one loop runs on the pool at a time
+    std::lock_guard<std::mutex> submitLock(m_submitMutex);
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_task = &task;
+        m_count = count;
+        // A few chunks per thread keeps the load balanced without much contention
+        m_chunk = std::max(minChunk, count / (concurrency * 4) + 1);
+        m_nextIndex.store(0, std::memory_order_relaxed);
+        m_activeWorkers = m_workers.size();
+        ++m_generation;
+    }
+    m_workAvailable.notify_all();
+
+    t_inParallelLoop = true;
+    runChunks();
+    t_inParallelLoop = false;
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_workDone.wait(lock, [this] { return m_activeWorkers == 0; });
+    m_task = nullptr;
+}
+
+/**
+ * Gets the number of threads taking part in parallel loops
+ */
+size_t ThreadPool::getConcurrency() const {
+    return m_workers.size() + 1;
+}
+
+/**
+ * Main loop of a worker thread
+ */
+void ThreadPool::workerLoop() {
+    t_inParallelLoop = true;
+    uint64_t seenGeneration = 0;
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_workAvailable.wait(lock, [&] { return m_stopping || m_generation != seenGeneration; });
+            if (m_stopping) {
+                return;
+            }
+            seenGeneration = m_generation;
+        }
+
+        runChunks();
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (--m_activeWorkers == 0) {
+                m_workDone.notify_one();
+            }
+        }
+    }
+}
+
+/**
+ * Claims and runs chunks of the current job until none are left
+ */
+void ThreadPool::runChunks() {
+    while (true) {
+        size_t begin = m_nextIndex.fetch_add(m_chunk, std::memory_order_relaxed);
+        if (begin >= m_count) {
+            return;
+        }
+        (*m_task)(begin, std::min(begin + m_chunk, m_count));
+    }
+}
+
+} // namespace lumina
@@ -0,0 +1,117 @@
+/**
+ * LuminaChain Wallet - Amount Tests
+ *
+ * This file tests the fixed-point Amount type.
+ *
+ * Copyright (c) 2023 LuminaChain Development Team
+ * Licensed under MIT License
+ */
+
+#include "test_framework.h"
+#include "core/amount.h"
+#include <cstdint>
+#include <random>
+
+using namespace lumina;
+
+/**
+ * Scales by mulDiv, returning 0 on failure for brevity
+ */
+static uint64_t scaled(uint64_t atomic, uint64_t numerator, uint64_t denominator) {
+    Amount result(0);
+    return Amount(atomic).mulDiv(numerator, denominator, result) ? result.atomicUnits() : 0;
+}
+
+LUMINA_TEST(mulDivUsesWideProducts) {
+    // Products that overflow 64 bits but whose quotients fit
+    CHECK(scaled(UINT64_MAX, UINT64_MAX, UINT64_MAX) == UINT64_MAX);
+    CHECK(scaled(1ULL << 63, 4, 8) == 1ULL << 62);
+    CHECK(scaled(UINT64_MAX, 3, 4) == UINT64_MAX / 4 * 3 + 2);
+    CHECK(scaled(10000000000000000000ULL, 10000000000000000000ULL, 12500000000000000000ULL) == 8000000000000000000ULL);
+    CHECK(scaled(123456789, 1, 1) == 123456789);
+    CHECK(scaled(7, 1, 2) == 3);
+
+    // The quotient does not fit, or there is nothing to divide by
+    Amount result(42);
+    CHECK(!Amount(UINT64_MAX).mulDiv(2, 1, result));
+    CHECK(!Amount(1ULL << 32).mulDiv(1ULL << 32, 1, result));
+    CHECK(!Amount(1).mulDiv(1, 0, result));
+    CHECK(result == Amount(42));
+}
+
+LUMINA_TEST(mulDivMatchesLongDivision) {
+    // (a * b) / d computed digit by digit in base 2^32, independently of the Amount helpers
+    auto reference = [](uint64_t a, uint64_t b, uint64_t d, uint64_t& quotient) {
+        uint32_t digits[4] = {0, 0, 0, 0};
+        uint64_t aParts[2] = {a & 0xffffffffULL, a >> 32};
+        uint64_t bParts[2] = {b & 0xffffffffULL, b >> 32};
+        for (int i = 0; i < 2; ++i) {
+            uint64_t carry = 0;
+            for (int j = 0; j < 2; ++j) {
+                uint64_t sum = aParts[i] * bParts[j] + digits[i + j] + carry;
+                digits[i + j] = static_cast<uint32_t>(sum);
+                carry = sum >> 32;
+            }
+            digits[i + 2] = static_cast<uint32_t>(carry);
+        }
+
+        // Bitwise long division of the 128-bit product
+        uint64_t remainder = 0;
+        uint64_t result = 0;
+        for (int bit = 127; bit >= 0; --bit) {
+            bool carry = remainder >> 63;
+            remainder = (remainder << 1) | ((digits[bit / 32] >> (bit % 32)) & 1);
+            bool subtract = carry || remainder >= d;
+            if (subtract) {
+                remainder -= d;
+            }
+            if (bit >= 64) {
+                if (subtract) {
+                    return false;
+                }
+            } else {
+                result |= static_cast<uint64_t>(subtract) << bit;
+            }
+        }
+        quotient = result;
+        return true;
+    };
+
+    std::mt19937_64 random(3);
+    for (int i = 0; i < 200000; ++i) {
+        uint64_t a = random() >> (random() % 64);
+        uint64_t b = random() >> (random() % 64);
+        uint64_t d = (random() >> (random() % 64)) | 1;
+
+        uint64_t expected = 0;
+        bool fits = reference(a, b, d, expected);
+        Amount result;
+        bool scaledOk = Amount(a).mulDiv(b, d, result);
+        CHECK(scaledOk == fits);
+        if (fits && scaledOk) {
+            CHECK(result.atomicUnits() == expected);
+        }
+    }
+}
+
+LUMINA_TEST(parsesAndFormats) {
+    Amount amount;
+    CHECK(Amount::parse("1.5", amount) && amount == Amount(1500000000000ULL));
+    CHECK(amount.toString() == "1.500000000000");
+    CHECK(Amount::parse("0.000000000001", amount) && amount == Amount(1));
+    CHECK(Amount::parse("18446744.073709551615", amount) && amount == Amount(UINT64_MAX));
+    CHECK(amount.toString() == "18446744.073709551615");
+
+    CHECK(!Amount::parse("18446744.073709551616", amount));
+    CHECK(!Amount::parse("1.0000000000001", amount));
+    CHECK(!Amount::parse("1.2.3", amount));
+    CHECK(!Amount::parse("", amount));
+    CHECK(!Amount::parse("-1", amount));
+
+    Amount sum;
+    CHECK(!Amount(UINT64_MAX).checkedAdd(Amount(1), sum));
+    CHECK(!Amount(1).checkedSub(Amount(2), sum));
+    CHECK(Amount(1000).checkedMul(1ULL << 40, sum) && sum == Amount(1000ULL << 40));
+    CHECK(Amount(UINT64_MAX).checkedMul(0, sum) && sum.isZero());
+    CHECK(!Amount(UINT64_MAX / 3 + 1).checkedMul(3, sum));
+}
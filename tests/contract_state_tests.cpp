@@ -0,0 +1,138 @@
+/**
+ * LuminaChain Wallet - Contract State Tests
+ *
+ * This file tests the copy-on-write contract state and its state file.
+ *
+ * Copyright (c) 2023 LuminaChain Development Team
+ * Licensed under MIT License
+ */
+
+#include "test_framework.h"
+#include "contract/contract_state.h"
+#include <cstdio>
+#include <map>
+#include <random>
+#include <vector>
+
+using namespace lumina;
+
+/**
+ * Checks that a state holds exactly the values of a model
+ */
+static bool matchesModel(const ContractState& state, const std::map<std::string, int64_t>& model) {
+    if (state.size() != model.size()) {
+        return false;
+    }
+    for (const auto& entry : model) {
+        int64_t value;
+        if (!state.find(entry.first, value) || value != entry.second) {
+            return false;
+        }
+    }
+    return true;
+}
+
+LUMINA_TEST(matchesMapModel) {
+    std::mt19937_64 random(1);
+    ContractState state;
+    std::map<std::string, int64_t> model;
+
+    // Keys repeat, so values are both inserted and replaced, and hashes collide deep in the trie
+    for (int i = 0; i < 100000; ++i) {
+        std::string key = "key" + std::to_string(random() % 20000);
+        int64_t value = static_cast<int64_t>(random());
+        state.store(key, value);
+        model[key] = value;
+    }
+    CHECK(matchesModel(state, model));
+
+    int64_t value;
+    CHECK(!state.find("missing", value));
+    CHECK(state.load("missing") == 0);
+}
+
+LUMINA_TEST(forksAreIndependent) {
+    std::mt19937_64 random(2);
+    ContractState state;
+    std::map<std::string, int64_t> model;
+    std::vector<std::pair<ContractState, std::map<std::string, int64_t>>> snapshots;
+
+    for (int i = 0; i < 50000; ++i) {
+        std::string key = "k" + std::to_string(random() % 5000);
+        int64_t value = static_cast<int64_t>(random());
+        state.store(key, value);
+        model[key] = value;
+        if (i % 5000 == 0) {
+            snapshots.emplace_back(state.fork(), model);
+        }
+    }
+
+    // Later stores to the origin leave every snapshot as it was
+    CHECK(matchesModel(state, model));
+    for (const auto& snapshot : snapshots) {
+        CHECK(matchesModel(snapshot.first, snapshot.second));
+    }
+
+    // And stores to a fork leave the origin alone
+    ContractState fork = state.fork();
+    fork.store("k0", -1);
+    fork.store("new", 7);
+    CHECK(matchesModel(state, model));
+    CHECK(fork.load("k0") == -1 && fork.size() == state.size() + 1);
+}
+
+LUMINA_TEST(diffsHoldFinalValues) {
+    ContractState state;
+    state.store("a", 1);
+    state.takeDiff();
+
+    ContractState fork = state.fork();
+    CHECK(fork.takeDiff().empty());
+    fork.store("b", 1);
+    fork.store("a", 2);
+    fork.store("b", 3);
+    StateDiff diff = fork.takeDiff();
+    CHECK(diff.size() == 2);
+    CHECK(diff[0] == std::make_pair(std::string("a"), int64_t(2)));
+    CHECK(diff[1] == std::make_pair(std::string("b"), int64_t(3)));
+    CHECK(fork.takeDiff().empty());
+
+    // Applying the diff to the origin commits the fork
+    CHECK(state.load("a") == 1);
+    state.apply(diff);
+    CHECK(state.load("a") == 2 && state.load("b") == 3 && state.size() == 2);
+}
+
+LUMINA_TEST(stateFileReplaysAndDropsTornTail) {
+    std::string path = test::tempPath("state");
+    {
+        StateFile file;
+        ContractState state;
+        CHECK(file.open(path, state));
+        CHECK(state.size() == 0);
+        CHECK(file.append({{"x", 5}, {"y", 6}}));
+        CHECK(file.append({{"x", 7}}));
+    }
+
+    // A record torn by a crash
+    std::FILE* file = std::fopen(path.c_str(), "ab");
+    CHECK(file != nullptr);
+    if (file) {
+        std::fputs("torn record", file);
+        std::fclose(file);
+    }
+
+    {
+        StateFile stateFile;
+        ContractState state;
+        CHECK(stateFile.open(path, state));
+        CHECK(state.load("x") == 7 && state.load("y") == 6 && state.size() == 2);
+        CHECK(stateFile.append({{"z", 1}}));
+    }
+    {
+        StateFile stateFile;
+        ContractState state;
+        CHECK(stateFile.open(path, state));
+        CHECK(state.load("z") == 1 && state.size() == 3);
+    }
+}
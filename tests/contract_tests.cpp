@@ -0,0 +1,342 @@
+/**
+ * LuminaChain Wallet - Contract Tests
+ *
+ * This file tests compiling contracts, running them on the VM and
+ * estimating their gas.
+ *
+ * Copyright (c) 2023 LuminaChain Development Team
+ * Licensed under MIT License
+ */
+
+#include "test_framework.h"
+#include "contract/bytecode.h"
+#include "contract/compiler.h"
+#include "contract/contract_state.h"
+#include "contract/gas_estimator.h"
+#include "contract/parallel_executor.h"
+#include "contract/vm.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace lumina;
+
+// Gas limit of runs that are expected to finish
+const uint64_t TEST_GAS_LIMIT = 1000000;
+
+// Sums the squares below n through a call, and stores the total
+const char* const SUM_OF_SQUARES = R"(
+contract Squares {
+    function main(n) {
+        let total = 0;
+        for i in 0..n {
+            total = total + square(i);
+        }
+        store("total", total);
+        return total;
+    }
+
+    function square(x) {
+        return x * x;
+    }
+}
+)";
+
+/**
+ * Compiles a contract, checking that it compiles and verifies
+ */
+static CompiledContract compileChecked(const std::string& source) {
+    ContractCompiler compiler;
+    CompiledContract contract;
+    CHECK(compiler.compile(source, contract));
+
+    std::string error;
+    CHECK(verifyContract(contract, error));
+    return contract;
+}
+
+LUMINA_TEST(runsCompiledContract) {
+    CompiledContract contract = compileChecked(SUM_OF_SQUARES);
+    int main = contract.findFunction("main");
+    CHECK(main >= 0);
+
+    ContractVM vm;
+    MemoryContractStorage storage;
+    ExecutionResult result = vm.execute(contract, main, {10}, TEST_GAS_LIMIT, storage);
+    CHECK(result.success);
+    CHECK(result.value == 285);
+    CHECK(storage.load("total") == 285);
+    CHECK(result.gasUsed > 0 && result.gasUsed < TEST_GAS_LIMIT);
+
+    // A rerun charges the same gas
+    ExecutionResult rerun = vm.execute(contract, main, {10}, TEST_GAS_LIMIT, storage);
+    CHECK(rerun.success && rerun.gasUsed == result.gasUsed);
+}
+
+LUMINA_TEST(evaluatesOperators) {
+    CompiledContract contract = compileChecked(R"(
+        contract Ops {
+            function main(a, b) {
+                let r = 0;
+                if (a > b && !(b == 0) || a == 7) {
+                    r = a / b + a % b * -2;
+                } else {
+                    r = b - a;
+                }
+                while (r > 100) {
+                    r = r / 2;
+                }
+                return r;
+            }
+        }
+    )");
+
+    ContractVM vm;
+    MemoryContractStorage storage;
+    ExecutionResult result = vm.execute(contract, 0, {17, 5}, TEST_GAS_LIMIT, storage);
+    CHECK(result.success && result.value == 17 / 5 + 17 % 5 * -2);
+    result = vm.execute(contract, 0, {3, 900}, TEST_GAS_LIMIT, storage);
+    CHECK(result.success && result.value == 56);
+}
+
+LUMINA_TEST(stopsWhenOutOfGas) {
+    CompiledContract contract = compileChecked(SUM_OF_SQUARES);
+
+    ContractVM vm;
+    MemoryContractStorage storage;
+    const uint64_t gasLimit = 1000;
+    ExecutionResult result = vm.execute(contract, 0, {1000000}, gasLimit, storage);
+    CHECK(!result.success);
+    CHECK(result.error == "Out of gas");
+    CHECK(result.gasUsed <= gasLimit);
+
+    // Enough gas for the whole run succeeds
+    result = vm.execute(contract, 0, {1000}, TEST_GAS_LIMIT, storage);
+    CHECK(result.success && result.value == 332833500);
+}
+
+LUMINA_TEST(wrapsReassignedLoopCounter) {
+    CompiledContract contract = compileChecked(R"(
+        contract Wrap {
+            function main() {
+                for i in 0..10 {
+                    if (i < 0) {
+                        return i;
+                    }
+                    if (i == 3) {
+                        i = 9223372036854775807;
+                    }
+                }
+                return 0;
+            }
+        }
+    )");
+
+    // Stepping past the largest counter wraps, as ADD does
+    ContractVM vm;
+    MemoryContractStorage storage;
+    ExecutionResult result = vm.execute(contract, 0, {}, TEST_GAS_LIMIT, storage);
+    CHECK(result.success && result.value == INT64_MIN);
+}
+
+LUMINA_TEST(failsOnDivisionByZero) {
+    CompiledContract contract = compileChecked("contract D { function main(n) { return 10 / n; } }");
+
+    ContractVM vm;
+    MemoryContractStorage storage;
+    ExecutionResult result = vm.execute(contract, 0, {0}, TEST_GAS_LIMIT, storage);
+    CHECK(!result.success && !result.error.empty());
+}
+
+LUMINA_TEST(reportsCompileErrors) {
+    ContractCompiler compiler;
+    CompiledContract contract;
+    CHECK(!compiler.compile("contract E { function main() { return x; } }", contract));
+    CHECK(compiler.getError().find("Unknown variable 'x'") != std::string::npos);
+
+    CHECK(!compiler.compile("contract E { function main() { return 1 }", contract));
+    CHECK(!compiler.getError().empty());
+}
+
+LUMINA_TEST(rejectsDeepNesting) {
+    const size_t depth = 100000;
+    std::string source = "contract N { function main() { return " + std::string(depth, '(') + "1" +
+                         std::string(depth, ')') + "; } }";
+
+    ContractCompiler compiler;
+    CompiledContract contract;
+    CHECK(!compiler.compile(source, contract));
+    CHECK(compiler.getError().find("nested too deeply") != std::string::npos);
+
+    source = "contract N { function main() { return " + std::string(depth, '-') + "1; } }";
+    CHECK(!compiler.compile(source, contract));
+
+    std::string blocks;
+    for (size_t i = 0; i < depth; ++i) {
+        blocks += "if (1) { ";
+    }
+    blocks += "return 1;" + std::string(depth, '}');
+    CHECK(!compiler.compile("contract N { function main() { " + blocks + " } }", contract));
+
+    // Reasonable nesting still compiles
+    source = "contract N { function main() { return " + std::string(100, '(') + "1" + std::string(100, ')') + "; } }";
+    CHECK(compiler.compile(source, contract));
+}
+
+LUMINA_TEST(rejectsWrongGasCharges) {
+    CompiledContract contract = compileChecked(SUM_OF_SQUARES);
+    std::string error;
+
+    CompiledContract cheap = contract;
+    Instruction& charge = cheap.functions[0].code[0];
+    CHECK(charge.op == Opcode::GAS);
+    charge = Instruction::makeABx(Opcode::GAS, charge.a, static_cast<uint16_t>(charge.bx() - 1));
+    CHECK(!verifyContract(cheap, error));
+
+    // A conditional jump whose fall-through is not charged
+    CompiledFunction uncharged;
+    uncharged.name = "main";
+    uncharged.registerCount = 1;
+    uncharged.code = {
+        Instruction::makeABx(Opcode::GAS, 2, 2),
+        Instruction::makeAsBx(Opcode::LOADI, 0, 1),
+        Instruction::makeAsBx(Opcode::JMPIFNOT, 0, 2),
+        Instruction::makeAsBx(Opcode::LOADI, 0, 2),
+        Instruction::makeABC(Opcode::RET, 0, 0, 0),
+        Instruction::makeABx(Opcode::GAS, 1, 2),
+        Instruction::makeABC(Opcode::RET, 0, 0, 0),
+    };
+    CompiledContract forged;
+    forged.functions.push_back(uncharged);
+    CHECK(!verifyContract(forged, error));
+}
+
+LUMINA_TEST(boundsGasStatically) {
+    CompiledContract contract = compileChecked(R"(
+        contract Bounded {
+            function main(n) {
+                let total = 0;
+                for i in 0..10 {
+                    if (i % 3 == 0) {
+                        total = total + helper(i);
+                    } else {
+                        store("last", i);
+                    }
+                }
+                return total;
+            }
+
+            function helper(x) {
+                return x * x + 1;
+            }
+        }
+    )");
+
+    uint64_t bound = 0;
+    CHECK(GasEstimator::computeBound(contract, 0, bound));
+
+    // The bound covers every path, so it is at least what any run charges
+    ContractVM vm;
+    MemoryContractStorage storage;
+    ExecutionResult result = vm.execute(contract, 0, {0}, TEST_GAS_LIMIT, storage);
+    CHECK(result.success);
+    CHECK(bound >= result.gasUsed);
+
+    GasEstimator estimator;
+    GasEstimate estimate = estimator.estimate(contract, 0, {0}, TEST_GAS_LIMIT, ContractState());
+    CHECK(estimate.isUpperBound && estimate.gas == bound);
+}
+
+LUMINA_TEST(dryRunsUnboundedLoops) {
+    CompiledContract contract = compileChecked(SUM_OF_SQUARES);
+
+    // The loop limit is a parameter, so only a dry run can tell
+    uint64_t bound = 0;
+    CHECK(!GasEstimator::computeBound(contract, 0, bound));
+
+    ContractVM vm;
+    MemoryContractStorage storage;
+    ExecutionResult result = vm.execute(contract, 0, {50}, TEST_GAS_LIMIT, storage);
+
+    ContractState state;
+    GasEstimator estimator;
+    GasEstimate estimate = estimator.estimate(contract, 0, {50}, TEST_GAS_LIMIT, state);
+    CHECK(!estimate.isUpperBound && !estimate.reachedLimit);
+    CHECK(estimate.gas == result.gasUsed);
+    CHECK(state.size() == 0);
+
+    estimate = estimator.estimate(contract, 0, {1000000}, 1000, state);
+    CHECK(estimate.reachedLimit);
+}
+
+// Moves funds between accounts, and every tenth call also updates one shared counter
+const char* const TRANSFERS = R"(
+contract Transfers {
+    function main(from, to, amount) {
+        if (from % 10 == 0) {
+            store("counter", load("counter") + amount);
+        }
+        store("account", from, load("account", from) - amount);
+        store("account", to, load("account", to) + amount + load("counter") % 3);
+        return load("account", to);
+    }
+}
+)";
+
+/**
+ * Runs a batch of transfers in parallel and one after another, checking
+ * that the results and the storage match
+ */
+static void checkMatchesSerial(const std::vector<ContractCall>& calls, int64_t accounts, size_t& reexecuted) {
+    MemoryContractStorage serialStorage;
+    ContractVM vm;
+    std::vector<ExecutionResult> serialResults;
+    for (const ContractCall& call : calls) {
+        serialResults.push_back(vm.execute(*call.contract, call.functionIndex, call.args, TEST_GAS_LIMIT, serialStorage));
+    }
+
+    MemoryContractStorage storage;
+    std::vector<ExecutionResult> results = ParallelExecutor::execute(calls, TEST_GAS_LIMIT, storage, &reexecuted);
+    CHECK(results.size() == serialResults.size());
+    for (size_t i = 0; i < results.size() && i < serialResults.size(); ++i) {
+        CHECK(results[i].success && serialResults[i].success);
+        CHECK(results[i].value == serialResults[i].value);
+        CHECK(results[i].gasUsed == serialResults[i].gasUsed);
+    }
+
+    CHECK(storage.load("counter") == serialStorage.load("counter"));
+    for (int64_t account = 0; account < accounts; ++account) {
+        std::string key = "account/" + std::to_string(account);
+        CHECK(storage.load(key) == serialStorage.load(key));
+    }
+}
+
+LUMINA_TEST(parallelBatchMatchesSerial) {
+    auto contract = std::make_shared<const CompiledContract>(compileChecked(TRANSFERS));
+
+    // Disjoint accounts and no counter updates, so nothing conflicts
+    std::vector<ContractCall> calls;
+    for (int64_t i = 0; i < 500; ++i) {
+        ContractCall call;
+        call.contract = contract;
+        call.args = {2 * i + 1, 2 * i + 3 + 1000, i};
+        calls.push_back(call);
+    }
+    size_t reexecuted = 0;
+    checkMatchesSerial(calls, 2100, reexecuted);
+    CHECK(reexecuted == 0);
+
+    // Few accounts and a shared counter, so calls conflict in rounds and in chains
+    for (size_t accounts : {1000, 40, 3}) {
+        calls.clear();
+        for (int64_t i = 0; i < 2000; ++i) {
+            ContractCall call;
+            call.contract = contract;
+            call.args = {(i * 7) % static_cast<int64_t>(accounts), (i * 13 + 1) % static_cast<int64_t>(accounts), i};
+            calls.push_back(call);
+        }
+        checkMatchesSerial(calls, static_cast<int64_t>(accounts), reexecuted);
+        CHECK(reexecuted > 0);
+    }
+}
@@ -0,0 +1,151 @@
+/**
+ * LuminaChain Wallet - Output Scanner Tests
+ *
+ * This file tests finding the wallet's outputs in scanned blocks.
+ *
+ * Copyright (c) 2023 LuminaChain Development Team
+ * Licensed under MIT License
+ */
+
+#include "test_framework.h"
+#include "network/scanner.h"
+#include <vector>
+
+using namespace lumina;
+
+/**
+ * Keys of a wallet receiving outputs
+ */
+struct ReceiverKeys {
+    crypto::secret_key viewSecretKey;
+    crypto::public_key viewPublicKey;
+    crypto::secret_key spendSecretKey;
+    crypto::public_key spendPublicKey;
+};
+
+/**
+ * Builds a transaction the way a sender does, paying the receiver at the
+ * given output indices and random keys elsewhere
+ */
+static ScanTransaction makeTransaction(const ReceiverKeys& receiver, const std::string& txHash, size_t outputCount,
+                                       const std::vector<size_t>& paidIndices, bool withViewTags) {
+    ScanTransaction tx;
+    tx.txHash = txHash;
+    tx.assetType = "LMT";
+
+    crypto::secret_key txSecretKey;
+    crypto::generate_keys(tx.txPublicKey, txSecretKey);
+    crypto::key_derivation derivation;
+    crypto::generate_key_derivation(receiver.viewPublicKey, txSecretKey, derivation);
+
+    for (size_t i = 0; i < outputCount; ++i) {
+        bool paid = false;
+        for (size_t index : paidIndices) {
+            paid = paid || index == i;
+        }
+
+        crypto::public_key outputKey;
+        crypto::view_tag viewTag;
+        if (paid) {
+            crypto::derive_public_key(derivation, i, receiver.spendPublicKey, outputKey);
+            crypto::derive_view_tag(derivation, i, viewTag);
+        } else {
+            crypto::secret_key unused;
+            crypto::generate_keys(outputKey, unused);
+            crypto::derive_view_tag(derivation, i + 1000, viewTag);
+        }
+
+        tx.outputKeys.push_back(outputKey);
+        if (withViewTags) {
+            tx.viewTags.push_back(viewTag);
+        }
+        tx.amounts.push_back(1000 * (i + 1));
+        tx.outputIndices.push_back(500 + i);
+        tx.assetTypeOutputIndices.push_back(100 + i);
+    }
+    return tx;
+}
+
+/**
+ * Creates receiver keys
+ */
+static ReceiverKeys makeReceiver() {
+    ReceiverKeys keys;
+    crypto::generate_keys(keys.viewPublicKey, keys.viewSecretKey);
+    crypto::generate_keys(keys.spendPublicKey, keys.spendSecretKey);
+    return keys;
+}
+
+LUMINA_TEST(findsOwnedOutputs) {
+    ReceiverKeys receiver = makeReceiver();
+
+    std::vector<ScanBlock> blocks(2);
+    blocks[0].height = 10;
+    blocks[0].transactions.push_back(makeTransaction(receiver, "tagged", 3, {0, 2}, true));
+    blocks[0].transactions.push_back(makeTransaction(receiver, "untagged", 2, {1}, false));
+    blocks[1].height = 11;
+    blocks[1].transactions.push_back(makeTransaction(receiver, "foreign", 4, {}, true));
+
+    // An output paid to the wallet under a wrong view tag is rejected by the tag
+    ScanTransaction mistagged = makeTransaction(receiver, "mistagged", 1, {0}, true);
+    mistagged.viewTags[0].data ^= 1;
+    blocks[1].transactions.push_back(mistagged);
+
+    std::vector<ScannedOutput> found;
+    OutputScanner scanner(receiver.viewSecretKey, receiver.spendPublicKey);
+    scanner.setMatchCallback([&found](const ScannedOutput& output) {
+        found.push_back(output);
+    });
+    CHECK(scanner.scanBlocks(blocks) == 3);
+    CHECK(found.size() == 3);
+    if (found.size() == 3) {
+        CHECK(found[0].txHash == "tagged" && found[0].outputIndex == 0 && found[0].amount == 1000);
+        CHECK(found[1].txHash == "tagged" && found[1].outputIndex == 2 && found[1].amount == 3000);
+        CHECK(found[2].txHash == "untagged" && found[2].outputIndex == 1 && found[2].height == 10);
+        CHECK(found[1].globalIndex == 502 && found[1].assetTypeIndex == 102 && found[1].assetType == "LMT");
+    }
+
+    // Another wallet finds nothing
+    ReceiverKeys other = makeReceiver();
+    OutputScanner otherScanner(other.viewSecretKey, other.spendPublicKey);
+    CHECK(otherScanner.scanBlocks(blocks) == 0);
+}
+
+LUMINA_TEST(reportsLargeBatchesInChainOrder) {
+    ReceiverKeys receiver = makeReceiver();
+
+    // Enough transactions to be split across the thread pool
+    std::vector<ScanBlock> blocks(100);
+    for (size_t height = 0; height < blocks.size(); ++height) {
+        blocks[height].height = height;
+        for (size_t i = 0; i < 20; ++i) {
+            std::vector<size_t> paid;
+            if (i % 7 == 0) {
+                paid.push_back(i % 2);
+            }
+            std::string txHash = std::to_string(height) + "/" + std::to_string(i);
+            blocks[height].transactions.push_back(makeTransaction(receiver, txHash, 2, paid, i % 3 != 0));
+        }
+    }
+
+    std::vector<std::string> found;
+    OutputScanner scanner(receiver.viewSecretKey, receiver.spendPublicKey);
+    scanner.setMatchCallback([&found](const ScannedOutput& output) {
+        found.push_back(output.txHash);
+    });
+    CHECK(scanner.scanBlocks(blocks) == 300);
+
+    std::vector<std::string> expected;
+    for (size_t height = 0; height < blocks.size(); ++height) {
+        for (size_t i = 0; i < 20; i += 7) {
+            expected.push_back(std::to_string(height) + "/" + std::to_string(i));
+        }
+    }
+    CHECK(found == expected);
+
+    // The scanner's buffers are reused for the next batch
+    found.clear();
+    blocks.resize(1);
+    CHECK(scanner.scanBlocks(blocks) == 3);
+    CHECK(found.size() == 3);
+}
@@ -0,0 +1,55 @@
+/**
+ * LuminaChain Wallet - Network Synchronization Tests
+ *
+ * This file tests how synchronization handles the checkpoints.
+ *
+ * Copyright (c) 2023 LuminaChain Development Team
+ * Licensed under MIT License
+ */
+
+#include "test_framework.h"
+#include "network/sync.h"
+#include "blocks/checkpoint_index.h"
+#include <cstring>
+#include <vector>
+
+using namespace lumina;
+
+/**
+ * Builds a checkpoint index with one group of the given size at the given height
+ */
+static bool makeCheckpoints(uint64_t height, uint32_t groupSize, const crypto::hash& hash,
+                            blocks::CheckpointIndex& index) {
+    blocks::CheckpointHeaderV2 header;
+    std::memcpy(header.magic, blocks::CHECKPOINT_MAGIC, sizeof(header.magic));
+    header.version = blocks::CHECKPOINT_FORMAT_VERSION;
+    header.group_size = groupSize;
+    header.count = 1;
+
+    std::vector<unsigned char> data(sizeof(header) + sizeof(height) + sizeof(hash));
+    std::memcpy(data.data(), &header, sizeof(header));
+    std::memcpy(data.data() + sizeof(header), &height, sizeof(height));
+    std::memcpy(data.data() + sizeof(header) + sizeof(height), &hash, sizeof(hash));
+    return index.Load({data.data(), data.size()}, nullptr) == blocks::CheckpointLoadStatus::Ok;
+}
+
+LUMINA_TEST(failsOnCheckpointMismatch) {
+    crypto::hash wrongHash;
+    std::memset(&wrongHash, 0x5a, sizeof(wrongHash));
+    blocks::CheckpointIndex checkpoints;
+    CHECK(makeCheckpoints(250, 256, wrongHash, checkpoints));
+
+    // Blocks below the group sync, the group itself does not match
+    NetworkSync sync("LMTtest");
+    sync.setCheckpoints(&checkpoints);
+    CHECK(!sync.startSync());
+    CHECK(sync.getStatus() == SyncStatus::NOT_SYNCED);
+    CHECK(sync.getCurrentBlockHeight() == 250);
+
+    // The checkpoint to save stops before the group, and a retry fails again
+    SyncCheckpoint checkpoint = sync.getSyncCheckpoint();
+    CHECK(checkpoint.height == 250);
+    CHECK(!checkpoint.recentBlocks.empty() && checkpoint.recentBlocks.back().height == 249);
+    CHECK(!sync.startSync());
+    CHECK(sync.getCurrentBlockHeight() == 250);
+}
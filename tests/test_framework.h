@@ -0,0 +1,69 @@
+/**
+ * LuminaChain Wallet - Test Framework
+ *
+ * This file defines the test registry and check macros shared by the
+ * test executables.
+ *
+ * Copyright (c) 2023 LuminaChain Development Team
+ * Licensed under MIT License
+ */
+
+#ifndef LUMINA_TEST_FRAMEWORK_H
+#define LUMINA_TEST_FRAMEWORK_H
+
+#include <string>
+
+namespace lumina {
+namespace test {
+
+/**
+ * A test body
+ */
+typedef void (*TestFunction)();
+
+/**
+ * Registers a test with the test main, at static initialization
+ */
+struct TestRegistration {
+    TestRegistration(const char* name, TestFunction function);
+};
+
+/**
+ * Records a failed check of the running test
+ *
+ * @param file Source file of the check
+ * @param line Source line of the check
+ * @param expression Text of the expression that was false
+ */
+void reportFailure(const char* file, int line, const char* expression);
+
+/**
+ * Gets a path in a temporary directory that is removed when the tests end
+ *
+ * @param name File name within the directory
+ * @return The path, where no file exists yet
+ */
+std::string tempPath(const std::string& name);
+
+} // namespace test
+} // namespace lumina
+
+/**
+ * Defines and registers a test
+ */
+#define LUMINA_TEST(name)                                                              \
+    static void name();                                                                \
+    static const ::lumina::test::TestRegistration name##Registration(#name, name);    \
+    static void name()
+
+/**
+ * Fails the running test, and carries on with it, if a condition is false
+ */
+#define CHECK(condition)                                                        \
+    do {                                                                        \
+        if (!(condition)) {                                                     \
+            ::lumina::test::reportFailure(__FILE__, __LINE__, #condition);     \
+        }                                                                       \
+    } while (0)
+
+#endif // LUMINA_TEST_FRAMEWORK_H
@@ -0,0 +1,86 @@
+/**
+ * LuminaChain Wallet - Test Main
+ *
+ * This file implements the test registry and runs every registered test.
+ *
+ * Copyright (c) 2023 LuminaChain Development Team
+ * Licensed under MIT License
+ */
+
+#include "test_framework.h"
+#include "utils/logger.h"
+#include <cstdio>
+#include <filesystem>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace lumina {
+namespace test {
+
+// Registered tests, in registration order
+static std::vector<std::pair<const char*, TestFunction>>& registry() {
+    static std::vector<std::pair<const char*, TestFunction>> tests;
+    return tests;
+}
+
+// Failed checks of the running test
+static size_t g_failures = 0;
+
+// Directory of the files of this run
+static std::filesystem::path g_tempDirectory;
+
+/**
+ * Registers a test with the test main
+ */
+TestRegistration::TestRegistration(const char* name, TestFunction function) {
+    registry().emplace_back(name, function);
+}
+
+/**
+ * Records a failed check of the running test
+ */
+void reportFailure(const char* file, int line, const char* expression) {
+    std::fprintf(stderr, "%s:%d: CHECK failed: %s\n", file, line, expression);
+    ++g_failures;
+}
+
+/**
+ * Gets a path in the temporary directory of this run
+ */
+std::string tempPath(const std::string& name) {
+    return (g_tempDirectory / name).string();
+}
+
+} // namespace test
+} // namespace lumina
+
+/**
+ * Runs every registered test
+ */
+int main() {
+    using namespace lumina::test;
+
+    // Tests provoke errors on purpose; their checks report what matters
+    lumina::Logger::getInstance().setConsoleOutput(false);
+
+    std::random_device random;
+    g_tempDirectory = std::filesystem::temp_directory_path() / ("lumina_tests_" + std::to_string(random()));
+    std::filesystem::create_directories(g_tempDirectory);
+
+    size_t failedTests = 0;
+    for (const auto& test : registry()) {
+        g_failures = 0;
+        test.second();
+        std::printf("%s %s\n", g_failures == 0 ? "[  OK  ]" : "[FAILED]", test.first);
+        if (g_failures != 0) {
+            ++failedTests;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::remove_all(g_tempDirectory, ec);
+
+    std::printf("%zu of %zu tests passed\n", registry().size() - failedTests, registry().size());
+    return failedTests == 0 ? 0 : 1;
+}
@@ -0,0 +1,137 @@
+/**
+ * LuminaChain Wallet - Transaction Tests
+ *
+ * This file tests transaction IDs and signatures.
+ *
+ * Copyright (c) 2023 LuminaChain Development Team
+ * Licensed under MIT License
+ */
+
+#include "test_framework.h"
+#include "core/transaction.h"
+#include <cctype>
+#include <string>
+#include <vector>
+
+using namespace lumina;
+
+/**
+ * Creates two transactions in the same second, so their timestamps match
+ */
+static void makeSameSecond(Transaction& first, Transaction& second, uint64_t firstNonce, uint64_t secondNonce,
+                           Amount secondAmount = Amount(1000)) {
+    do {
+        first = Transaction("LMTsender", "LMTrecipient", Amount(1000), LMT_ASSET_ID, firstNonce);
+        second = Transaction("LMTsender", "LMTrecipient", secondAmount, LMT_ASSET_ID, secondNonce);
+    } while (first.getTimestamp() != second.getTimestamp());
+}
+
+LUMINA_TEST(derivesIdsFromContents) {
+    Transaction first;
+    Transaction second;
+    makeSameSecond(first, second, 1, 1);
+    CHECK(first.getId() == second.getId());
+
+    // The nonce tells apart otherwise identical transactions
+    makeSameSecond(first, second, 1, 2);
+    CHECK(first.getId() != second.getId());
+
+    makeSameSecond(first, second, 1, 1, Amount(1001));
+    CHECK(first.getId() != second.getId());
+
+    // A restored transaction keeps its ID
+    Transaction restored(first.getId(), first.getFromAddress(), first.getToAddress(), first.getAmount(),
+                         first.getAssetId(), first.getTimestamp(), first.getStatus());
+    CHECK(restored.getId() == first.getId());
+}
+
+LUMINA_TEST(formatsIds) {
+    Transaction transaction("LMTsender", "LMTrecipient", Amount(1), LMT_ASSET_ID, 7);
+    std::string id(transaction.getId());
+
+    // The prefix and 20 hash bytes in lowercase hex
+    CHECK(id.size() == 3 + 2 * 20 && id.size() <= TRANSACTION_ID_LENGTH);
+    CHECK(id.compare(0, 3, "TX-") == 0);
+    for (size_t i = 3; i < id.size(); ++i) {
+        CHECK(std::isxdigit(static_cast<unsigned char>(id[i])) && !std::isupper(static_cast<unsigned char>(id[i])));
+    }
+}
+
+/**
+ * Creates a signing key from a fresh random secret key
+ */
+static bool makeKey(SigningKey& key) {
+    crypto::public_key publicKey;
+    crypto::secret_key secretKey;
+    crypto::generate_keys(publicKey, secretKey);
+    return key.setSecretKey(secretKey);
+}
+
+LUMINA_TEST(signsAndVerifies) {
+    SigningKey key;
+    SigningKey otherKey;
+    CHECK(makeKey(key) && makeKey(otherKey));
+
+    Transaction transaction("LMTsender", "LMTrecipient", Amount(5000), LMT_ASSET_ID, 1);
+    CHECK(!transaction.isSigned() && !transaction.verifySignature());
+    CHECK(transaction.sign(key));
+    CHECK(transaction.isSigned());
+    CHECK(transaction.getSignature().size() == TRANSACTION_SIGNATURE_LENGTH);
+    CHECK(transaction.verifySignature());
+    CHECK(transaction.verifySignature(key));
+    CHECK(!transaction.verifySignature(otherKey));
+
+    // Signing is deterministic
+    Transaction resigned = transaction;
+    CHECK(resigned.sign(key) && resigned.getSignature() == transaction.getSignature());
+
+    // A signature restored from storage verifies; a damaged one does not
+    Transaction restored(transaction.getId(), transaction.getFromAddress(), transaction.getToAddress(),
+                         transaction.getAmount(), transaction.getAssetId(), transaction.getTimestamp(),
+                         transaction.getStatus());
+    CHECK(restored.restoreSignature(transaction.getSignerKey(), transaction.getSignature()));
+    CHECK(restored.verifySignature() && restored.verifySignature(key));
+
+    std::string damaged(transaction.getSignature());
+    damaged[TRANSACTION_SIGNATURE_LENGTH - 1] ^= 1;
+    CHECK(restored.restoreSignature(transaction.getSignerKey(), damaged));
+    CHECK(!restored.verifySignature());
+    CHECK(!restored.restoreSignature(transaction.getSignerKey(), damaged.substr(1)));
+
+    // The signature covers the contents, not only the ID
+    Transaction altered(transaction.getId(), transaction.getFromAddress(), "LMTthief", transaction.getAmount(),
+                        transaction.getAssetId(), transaction.getTimestamp(), transaction.getStatus());
+    CHECK(altered.restoreSignature(transaction.getSignerKey(), transaction.getSignature()));
+    CHECK(!altered.verifySignature());
+}
+
+LUMINA_TEST(verifiesSignatureBatches) {
+    SigningKey key;
+    SigningKey otherKey;
+    CHECK(makeKey(key) && makeKey(otherKey));
+
+    // Enough transactions to be split across the thread pool
+    std::vector<Transaction> transactions;
+    for (uint64_t i = 0; i < 1000; ++i) {
+        transactions.emplace_back("LMTsender", "LMTrecipient" + std::to_string(i % 5), Amount(i + 1),
+                                  LMT_ASSET_ID, i);
+        CHECK(transactions.back().sign(i % 2 == 0 ? key : otherKey));
+    }
+    CHECK(Transaction::verifySignatures(transactions.data(), transactions.size()));
+    CHECK(Transaction::verifySignatures(transactions.data(), 1));
+    CHECK(Transaction::verifySignatures(nullptr, 0));
+
+    // One signature claimed for the wrong key anywhere fails the batch
+    for (size_t forged : {0, 518, 998}) {
+        std::vector<Transaction> batch = transactions;
+        Transaction& victim = batch[forged];
+        CHECK(victim.verifySignature(key));
+        CHECK(victim.restoreSignature(otherKey.getPublicKey(), victim.getSignature()));
+        CHECK(!Transaction::verifySignatures(batch.data(), batch.size()));
+    }
+
+    // And so does an unsigned transaction
+    std::vector<Transaction> batch = transactions;
+    batch[300] = Transaction("LMTsender", "LMTrecipient", Amount(1), LMT_ASSET_ID, 300);
+    CHECK(!Transaction::verifySignatures(batch.data(), batch.size()));
+}
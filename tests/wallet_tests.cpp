@@ -0,0 +1,459 @@
+/**
+ * LuminaChain Wallet - Wallet Tests
+ *
+ * This file tests transfers, their journal and the wallet history.
+ *
+ * Copyright (c) 2023 LuminaChain Development Team
+ * Licensed under MIT License
+ */
+
+#include "test_framework.h"
+#include "core/asset_registry.h"
+#include "core/wallet.h"
+#include "network/scanner.h"
+#include <csignal>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <utility>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+using namespace lumina;
+
+// Password of the test wallets
+const char* const TEST_PASSWORD = "correct horse";
+
+// Seed phrase of the test wallets
+const char* const TEST_SEED_PHRASE = "legal winner thank year wave sausage worth useful legal winner thank yellow";
+
+// Amount each test wallet starts with
+const Amount TEST_FUNDS(1000000000000ULL);
+
+/**
+ * Recovers a test wallet and credits it TEST_FUNDS, saved to its file
+ */
+static bool fundWallet(Wallet& wallet) {
+    if (!wallet.recoverFromSeed(TEST_SEED_PHRASE)) {
+        return false;
+    }
+
+    ScannedOutput output{};
+    output.height = 1;
+    output.txHash = "funding";
+    output.amount = TEST_FUNDS.atomicUnits();
+    output.assetType = "LMT";
+    return wallet.addScannedOutput(output) && wallet.setSyncCheckpoint({1, {}});
+}
+
+/**
+ * Copies the files of a wallet as they are on disk, as a crash would leave them
+ */
+static void copyWalletFiles(const std::string& from, const std::string& to) {
+    for (const char* suffix : {"", ".history", ".journal"}) {
+        if (std::filesystem::exists(from + suffix)) {
+            std::filesystem::copy_file(from + suffix, to + suffix, std::filesystem::copy_options::overwrite_existing);
+        }
+    }
+}
+
+LUMINA_TEST(replaysJournalAfterCrash) {
+    std::string path = test::tempPath("journal.wallet");
+    std::string crashedPath = test::tempPath("crashed.wallet");
+
+    std::vector<std::string> ids;
+    Amount balance;
+    {
+        Wallet wallet(path, TEST_PASSWORD);
+        CHECK(fundWallet(wallet));
+        for (uint64_t i = 1; i <= 20; ++i) {
+            CHECK(wallet.transfer("LMTrecipient" + std::to_string(i % 3), Amount(i * 1000)));
+        }
+        balance = wallet.getBalance();
+        CHECK(balance == Amount(TEST_FUNDS.atomicUnits() - 210000));
+
+        HistoryQuery query;
+        query.limit = 100;
+        std::vector<Transaction> transactions;
+        wallet.queryHistory(query, transactions);
+        for (const Transaction& transaction : transactions) {
+            ids.emplace_back(transaction.getId());
+        }
+
+        // The wallet file was last written before the transfers; only the journal has them
+        copyWalletFiles(path, crashedPath);
+    }
+    CHECK(ids.size() == 20);
+    CHECK(std::filesystem::file_size(crashedPath + ".journal") > 0);
+
+    {
+        Wallet recovered(crashedPath, TEST_PASSWORD);
+        CHECK(recovered.getTransactionCount() == 20);
+        CHECK(recovered.getBalance() == balance);
+        for (const std::string& id : ids) {
+            Transaction transaction;
+            CHECK(recovered.findTransaction(id, transaction));
+            CHECK(transaction.verifySignature());
+        }
+        CHECK(recovered.transfer("LMTrecipient0", Amount(1)));
+    }
+
+    // The replayed and the new transfers survive a clean close
+    Wallet reopened(crashedPath, TEST_PASSWORD);
+    CHECK(reopened.getTransactionCount() == 21);
+    CHECK(reopened.getBalance() == Amount(balance.atomicUnits() - 1));
+}
+
+#ifndef _WIN32
+LUMINA_TEST(recoversJournalAfterFailedWrite) {
+    std::string path = test::tempPath("failed_journal.wallet");
+    std::string crashedPath = test::tempPath("failed_journal_crashed.wallet");
+
+    Wallet wallet(path, TEST_PASSWORD);
+    CHECK(fundWallet(wallet));
+    CHECK(wallet.transfer("LMTrecipient", Amount(1000)));
+
+    // Keep the journal from growing, so its next write fails
+    rlimit oldLimit;
+    CHECK(getrlimit(RLIMIT_FSIZE, &oldLimit) == 0);
+    rlimit limit = oldLimit;
+    limit.rlim_cur = std::filesystem::file_size(path + ".journal");
+    std::signal(SIGXFSZ, SIG_IGN);
+    CHECK(setrlimit(RLIMIT_FSIZE, &limit) == 0);
+    bool transferred = wallet.transfer("LMTrecipient", Amount(2000));
+    CHECK(setrlimit(RLIMIT_FSIZE, &oldLimit) == 0);
+
+    CHECK(!transferred);
+    CHECK(wallet.getTransactionCount() == 1);
+    CHECK(wallet.getBalance() == Amount(TEST_FUNDS.atomicUnits() - 1000));
+
+    // The next transfer recovers the journal instead of failing too
+    CHECK(wallet.transfer("LMTrecipient", Amount(3000)));
+    CHECK(wallet.getTransactionCount() == 2);
+
+    copyWalletFiles(path, crashedPath);
+    Wallet recovered(crashedPath, TEST_PASSWORD);
+    CHECK(recovered.getTransactionCount() == 2);
+    CHECK(recovered.getBalance() == Amount(TEST_FUNDS.atomicUnits() - 4000));
+    CHECK(recovered.transfer("LMTrecipient", Amount(1)));
+}
+#endif
+
+/**
+ * Gets the IDs of a wallet's transactions in history file order
+ */
+static std::vector<std::string> transactionIds(Wallet& wallet) {
+    HistoryQuery query;
+    query.newestFirst = false;
+    query.limit = 1000;
+    std::vector<Transaction> transactions;
+    wallet.queryHistory(query, transactions);
+
+    std::vector<std::string> ids;
+    for (const Transaction& transaction : transactions) {
+        ids.emplace_back(transaction.getId());
+    }
+    return ids;
+}
+
+LUMINA_TEST(replaysStatusUpdatesOfInterruptedSave) {
+    std::string path = test::tempPath("status.wallet");
+    std::string crashedPath = test::tempPath("status-crashed.wallet");
+    const auto overwrite = std::filesystem::copy_options::overwrite_existing;
+
+    std::vector<std::string> ids;
+    {
+        Wallet wallet(path, TEST_PASSWORD);
+        CHECK(fundWallet(wallet));
+        for (uint64_t i = 1; i <= 3; ++i) {
+            CHECK(wallet.transfer("LMTrecipient", Amount(i * 1000)));
+        }
+        ids = transactionIds(wallet);
+    }
+    CHECK(ids.size() == 3);
+    if (ids.size() != 3) {
+        return;
+    }
+
+    // The history as a crash right after the next save's rename leaves it, before the status is patched
+    std::filesystem::copy_file(path + ".history", crashedPath + ".history", overwrite);
+    {
+        Wallet wallet(path, TEST_PASSWORD);
+        CHECK(wallet.setTransactionStatus(ids[1], TransactionStatus::CONFIRMED));
+    }
+    std::filesystem::copy_file(path, crashedPath, overwrite);
+    std::filesystem::copy_file(path + ".journal", crashedPath + ".journal", overwrite);
+
+    {
+        Wallet crashed(crashedPath, TEST_PASSWORD);
+        Transaction transaction;
+        CHECK(crashed.findTransaction(ids[1], transaction));
+        CHECK(transaction.getStatus() == TransactionStatus::CONFIRMED && transaction.verifySignature());
+        CHECK(crashed.findTransaction(ids[0], transaction));
+        CHECK(transaction.getStatus() == TransactionStatus::PENDING);
+        CHECK(crashed.transfer("LMTrecipient", Amount(1)));
+    }
+
+    // Loading patched the history, so the status outlives the wallet file that carried it
+    Wallet reopened(crashedPath, TEST_PASSWORD);
+    Transaction transaction;
+    CHECK(reopened.getTransactionCount() == 4);
+    CHECK(reopened.findTransaction(ids[1], transaction));
+    CHECK(transaction.getStatus() == TransactionStatus::CONFIRMED && transaction.verifySignature());
+}
+
+/**
+ * Overwrites bytes of a file at an offset
+ */
+static bool overwriteFile(const std::string& path, long offset, const void* data, size_t size) {
+    std::FILE* file = std::fopen(path.c_str(), "r+b");
+    if (!file) {
+        return false;
+    }
+    bool written = std::fseek(file, offset, SEEK_SET) == 0 && std::fwrite(data, 1, size, file) == size;
+    return std::fclose(file) == 0 && written;
+}
+
+LUMINA_TEST(detectsDamagedHistoryRecords) {
+    std::string path = test::tempPath("damaged.wallet");
+
+    std::vector<std::string> ids;
+    {
+        Wallet wallet(path, TEST_PASSWORD);
+        CHECK(fundWallet(wallet));
+        for (uint64_t i = 1; i <= 5; ++i) {
+            CHECK(wallet.transfer("LMTrecipient", Amount(i * 1000)));
+        }
+        ids = transactionIds(wallet);
+    }
+    CHECK(ids.size() == 5);
+    if (ids.size() != 5) {
+        return;
+    }
+
+    // A changed amount, and two records swapped whole
+    const long recordSize = sizeof(WalletHistoryRecord);
+    uint64_t amount = 1;
+    CHECK(overwriteFile(path + ".history", recordSize + offsetof(WalletHistoryRecord, amount), &amount, sizeof(amount)));
+
+    std::vector<char> first(recordSize);
+    std::vector<char> last(recordSize);
+    std::FILE* file = std::fopen((path + ".history").c_str(), "rb");
+    CHECK(file != nullptr);
+    if (file) {
+        CHECK(std::fread(first.data(), recordSize, 1, file) == 1);
+        CHECK(std::fseek(file, 4 * recordSize, SEEK_SET) == 0 && std::fread(last.data(), recordSize, 1, file) == 1);
+        std::fclose(file);
+    }
+    CHECK(overwriteFile(path + ".history", 0, last.data(), last.size()));
+    CHECK(overwriteFile(path + ".history", 4 * recordSize, first.data(), first.size()));
+
+    Wallet wallet(path, TEST_PASSWORD);
+    Transaction transaction;
+    for (size_t i : {0, 1, 4}) {
+        CHECK(wallet.findTransaction(ids[i], transaction));
+        CHECK(transaction.getStatus() == TransactionStatus::FAILED && !transaction.isSigned());
+    }
+    for (size_t i : {2, 3}) {
+        CHECK(wallet.findTransaction(ids[i], transaction));
+        CHECK(transaction.getStatus() == TransactionStatus::PENDING && transaction.verifySignature());
+    }
+}
+
+/**
+ * Pages through a query, returning the amounts in query order
+ */
+static std::vector<uint64_t> pageAmounts(Wallet& wallet, HistoryQuery query) {
+    std::vector<uint64_t> amounts;
+    std::vector<Transaction> transactions;
+    while (true) {
+        HistoryPage page = wallet.queryHistory(query, transactions);
+        CHECK(transactions.size() <= query.limit);
+        for (const Transaction& transaction : transactions) {
+            amounts.push_back(transaction.getAmount().atomicUnits());
+        }
+        if (!page.hasMore) {
+            break;
+        }
+
+        // Cursors survive a round trip through text, as the command line uses them
+        CHECK(HistoryCursor::parse(page.next.toString(), query.after));
+    }
+    return amounts;
+}
+
+LUMINA_TEST(pagesThroughHistory) {
+    std::string path = test::tempPath("history.wallet");
+    const uint64_t transferCount = 45;
+
+    std::vector<uint64_t> oldestFirst;
+    for (uint64_t i = 1; i <= transferCount; ++i) {
+        oldestFirst.push_back(i * 1000);
+    }
+    std::vector<uint64_t> newestFirst(oldestFirst.rbegin(), oldestFirst.rend());
+
+    std::string confirmedId;
+    {
+        Wallet wallet(path, TEST_PASSWORD);
+        CHECK(fundWallet(wallet));
+        for (uint64_t i = 1; i <= transferCount; ++i) {
+            CHECK(wallet.transfer("LMTrecipient" + std::to_string(i % 3), Amount(i * 1000)));
+
+            // Part of the history is read from the wallet's history file, the rest from memory
+            if (i == 25) {
+                CHECK(wallet.setSyncCheckpoint({2, {}}));
+            }
+        }
+
+        HistoryQuery query;
+        query.limit = 7;
+        CHECK(pageAmounts(wallet, query) == newestFirst);
+        query.newestFirst = false;
+        CHECK(pageAmounts(wallet, query) == oldestFirst);
+
+        // A limit of 0 gets the default page size, so paging still advances
+        HistoryQuery defaultQuery;
+        defaultQuery.limit = 0;
+        std::vector<Transaction> defaultPage;
+        HistoryPage page = wallet.queryHistory(defaultQuery, defaultPage);
+        CHECK(defaultPage.size() == HISTORY_DEFAULT_PAGE_SIZE);
+        CHECK(page.hasMore && page.next.valid);
+
+        query.counterparty = "LMTrecipient0";
+        std::vector<uint64_t> amounts = pageAmounts(wallet, query);
+        CHECK(amounts.size() == transferCount / 3);
+        for (uint64_t amount : amounts) {
+            CHECK(amount / 1000 % 3 == 0);
+        }
+
+        std::vector<Transaction> transactions;
+        query = HistoryQuery();
+        query.limit = 1;
+        wallet.queryHistory(query, transactions);
+        CHECK(transactions.size() == 1);
+        if (!transactions.empty()) {
+            confirmedId = std::string(transactions[0].getId());
+            CHECK(wallet.setTransactionStatus(confirmedId, TransactionStatus::CONFIRMED));
+        }
+    }
+
+    // After a reload every record comes from the history file
+    Wallet wallet(path, TEST_PASSWORD);
+    HistoryQuery query;
+    query.limit = 10;
+    CHECK(pageAmounts(wallet, query) == newestFirst);
+
+    query.filterStatus = true;
+    query.status = TransactionStatus::CONFIRMED;
+    std::vector<Transaction> transactions;
+    HistoryPage page = wallet.queryHistory(query, transactions);
+    CHECK(transactions.size() == 1 && !page.hasMore);
+    CHECK(!transactions.empty() && transactions[0].getId() == confirmedId);
+
+    query = HistoryQuery();
+    query.startTime = INT64_MAX;
+    wallet.queryHistory(query, transactions);
+    CHECK(transactions.empty());
+}
+
+/**
+ * Gets the (recipient, amount) of every transaction, oldest first
+ */
+static std::vector<std::pair<std::string, uint64_t>> transferList(Wallet& wallet) {
+    std::vector<std::pair<std::string, uint64_t>> transfers;
+    HistoryQuery query;
+    query.newestFirst = false;
+    query.limit = 1000;
+    std::vector<Transaction> transactions;
+    wallet.queryHistory(query, transactions);
+    for (const Transaction& transaction : transactions) {
+        transfers.emplace_back(std::string(transaction.getToAddress()), transaction.getAmount().atomicUnits());
+    }
+    return transfers;
+}
+
+LUMINA_TEST(batchMatchesSerialTransfers) {
+    std::vector<TransferDestination> destinations(300);
+    for (size_t i = 0; i < destinations.size(); ++i) {
+        destinations[i].address = "LMTpayee" + std::to_string(i % 7);
+        destinations[i].amount = Amount(1000 + i);
+    }
+
+    Wallet batched(test::tempPath("batched.wallet"), TEST_PASSWORD);
+    Wallet serial(test::tempPath("serial.wallet"), TEST_PASSWORD);
+    CHECK(fundWallet(batched));
+    CHECK(fundWallet(serial));
+
+    CHECK(batched.transferBatch(destinations));
+    for (const TransferDestination& destination : destinations) {
+        CHECK(serial.transfer(destination.address, destination.amount, destination.assetId));
+    }
+
+    CHECK(batched.getBalance() == serial.getBalance());
+    CHECK(batched.getTransactionCount() == serial.getTransactionCount());
+    CHECK(transferList(batched) == transferList(serial));
+
+    // A batch that cannot be paid in full changes nothing
+    Amount balance = batched.getBalance();
+    destinations[150].amount = TEST_FUNDS;
+    CHECK(!batched.transferBatch(destinations));
+    CHECK(batched.getBalance() == balance);
+    CHECK(batched.getTransactionCount() == serial.getTransactionCount());
+
+    destinations[150].address = std::string(200, 'x');
+    destinations[150].amount = Amount(1);
+    CHECK(!batched.transferBatch(destinations));
+    CHECK(batched.getTransactionCount() == serial.getTransactionCount());
+}
+
+LUMINA_TEST(creditsRescannedOutputsOnce) {
+    Wallet wallet(test::tempPath("rescan.wallet"), TEST_PASSWORD);
+    CHECK(fundWallet(wallet));
+
+    ScannedOutput output{};
+    output.height = 5;
+    output.txHash = "incoming";
+    output.outputIndex = 1;
+    output.amount = 2500;
+    output.assetType = "LMT";
+    CHECK(wallet.addScannedOutput(output));
+    CHECK(!wallet.addScannedOutput(output));
+    CHECK(wallet.getBalance() == Amount(TEST_FUNDS.atomicUnits() + 2500));
+
+    // Another output of the same transaction is a different output
+    output.outputIndex = 0;
+    CHECK(wallet.addScannedOutput(output));
+    CHECK(wallet.getBalance() == Amount(TEST_FUNDS.atomicUnits() + 5000));
+
+    // After a reorganization the outputs can be found again
+    wallet.rollbackToHeight(5);
+    CHECK(wallet.getBalance() == TEST_FUNDS);
+    CHECK(wallet.addScannedOutput(output));
+    CHECK(wallet.getBalance() == Amount(TEST_FUNDS.atomicUnits() + 2500));
+
+    // The wallet scans with its own keys
+    CHECK(wallet.createOutputScanner() != nullptr);
+}
+
+LUMINA_TEST(rejectsUnsupportedAssetTypes) {
+    Wallet wallet(test::tempPath("assets.wallet"), TEST_PASSWORD);
+    CHECK(fundWallet(wallet));
+    size_t assetCount = AssetRegistry::getInstance().size();
+
+    // Symbols that do not fit a wallet record are never registered
+    ScannedOutput output{};
+    output.height = 5;
+    output.txHash = "unsupported";
+    output.amount = 2500;
+    output.assetType = std::string(MAX_ASSET_SYMBOL_LENGTH + 1, 'X');
+    CHECK(!wallet.addScannedOutput(output));
+    output.assetType.clear();
+    CHECK(!wallet.addScannedOutput(output));
+
+    CHECK(AssetRegistry::getInstance().size() == assetCount);
+    CHECK(wallet.getBalance() == TEST_FUNDS);
+}